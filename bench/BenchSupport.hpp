@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../include/ThreadMetrics.hpp"
+#include "../include/TscClock.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace market_data::bench {
+
+/**
+ * Report a merged latency histogram as p50 / p99 / p99.9 / max counters
+ * (ns), next to Google Benchmark's own time and throughput columns.
+ */
+inline void report_latency(benchmark::State& state, const HistogramSnapshot& latency,
+                           const char* prefix = "") {
+    std::string p(prefix);
+    state.counters[p + "p50_ns"] = static_cast<double>(latency.percentile(50.0));
+    state.counters[p + "p99_ns"] = static_cast<double>(latency.percentile(99.0));
+    state.counters[p + "p99.9_ns"] = static_cast<double>(latency.percentile(99.9));
+    state.counters[p + "max_ns"] = static_cast<double>(latency.max);
+}
+
+inline HistogramSnapshot merge(const std::vector<ThreadMetrics>& threads,
+                               LatencyHistogram ThreadMetrics::*histogram) {
+    HistogramSnapshot snapshot;
+    for (const auto& thread : threads) {
+        snapshot.add(thread.*histogram);
+    }
+    return snapshot;
+}
+
+// Calibrate before the first timed iteration
+inline const TscClock& clock() {
+    return TscClock::instance();
+}
+
+} // namespace market_data::bench
@@ -0,0 +1,173 @@
+// End-to-end benchmarks: synthetic bursts from LoadGenerator through the
+// engine queue into the consumer stats path, single consumer and sharded.
+
+#include "BenchSupport.hpp"
+#include "../include/InstrumentTable.hpp"
+#include "../include/LoadGenerator.hpp"
+#include "../include/MarketDataSource.hpp"
+#include "../include/ShardedPipeline.hpp"
+#include "../include/WaitStrategy.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+
+using namespace market_data;
+
+namespace {
+
+constexpr size_t EVENTS_PER_RUN = size_t{1} << 19;
+
+/**
+ * Publish count events as the historical handler does: bursts from the
+ * generator, PUBLISH_BATCH_SIZE records per bulk push, each group stamped
+ * when handed over. burst_gap_ns > 0 paces bursts in wall time (it
+ * overrides the profile's event-time gap).
+ */
+template<typename Queue>
+void publish_bursts(Queue& queue, LoadGenerator& generator, size_t count, int64_t burst_gap_ns) {
+    const TscClock& clock = TscClock::instance();
+    std::vector<MarketDataPoint> burst(generator.profile().burst_size);
+    SpinYieldWait wait;
+    int64_t due = clock.now_ns();
+    for (size_t sent = 0; sent < count;) {
+        if (burst_gap_ns > 0) {
+            while (clock.now_ns() < due) {
+                wait.idle([] { return false; });
+            }
+            wait.reset();
+            due += burst_gap_ns;
+        }
+        size_t n = std::min(generator.next_burst(burst.data()), count - sent);
+        for (size_t offset = 0; offset < n;) {
+            size_t group = std::min(config::PUBLISH_BATCH_SIZE, n - offset);
+            stamp_enqueue(burst.data() + offset, group);
+            for (size_t pushed = 0; pushed < group;) {
+                size_t k = queue.try_push_bulk(burst.data() + offset + pushed, group - pushed);
+                if (k == 0) {
+                    wait.idle([] { return false; });
+                }
+                pushed += k;
+            }
+            wait.reset();
+            offset += group;
+        }
+        sent += n;
+    }
+}
+
+LoadProfile profile_for(benchmark::State& state) {
+    LoadProfile profile;
+    profile.burst_size = static_cast<size_t>(state.range(0));
+    return profile;
+}
+
+/**
+ * Single consumer, the default engine configuration: pops
+ * CONSUMER_BATCH_SIZE records and folds each into its InstrumentStats
+ * (book, VWAP, rolling windows) like consumer_thread in main.cpp.
+ * Args: burst size, gap between bursts in µs (0 = back to back).
+ */
+void BM_ConsumerPipeline(benchmark::State& state) {
+    LoadProfile profile = profile_for(state);
+    auto burst_gap_ns = static_cast<int64_t>(state.range(1)) * 1000;
+    LoadGenerator generator(profile);
+    EngineDataQueue queue(config::QUEUE_SIZE);
+    InstrumentTable<InstrumentStats> stats_table(config::INSTRUMENT_TABLE_CAPACITY);
+    ThreadMetrics metrics;
+    std::array<MarketDataPoint, config::CONSUMER_BATCH_SIZE> batch;
+    const TscClock& clock = bench::clock();
+    SpinYieldWait wait;
+
+    for (auto _ : state) {
+        std::thread producer(publish_bursts<EngineDataQueue>, std::ref(queue), std::ref(generator),
+                             EVENTS_PER_RUN, burst_gap_ns);
+        for (size_t consumed = 0; consumed < EVENTS_PER_RUN;) {
+            size_t popped = queue.try_pop_bulk(batch.data(), batch.size());
+            if (popped == 0) {
+                wait.idle([] { return false; });
+                continue;
+            }
+            wait.reset();
+            uint64_t dequeued = clock.ticks();
+            for (size_t i = 0; i < popped; ++i) {
+                if (InstrumentStats* stats = stats_table.find_or_add(batch[i].instrument_id)) {
+                    stats->update(batch[i]);
+                    record_consumer_latency(batch[i], dequeued, clock.ticks(), metrics, *stats);
+                }
+            }
+            consumed += popped;
+        }
+        producer.join();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(EVENTS_PER_RUN));
+    HistogramSnapshot end_to_end;
+    end_to_end.add(metrics.end_to_end_latency);
+    HistogramSnapshot queued;
+    queued.add(metrics.queue_latency);
+    bench::report_latency(state, end_to_end);
+    bench::report_latency(state, queued, "queue_");
+}
+
+/**
+ * The same feed through ShardedPipeline: router plus one worker per shard.
+ * Args: burst size, shards. Latency is producer enqueue -> shard stats
+ * updated.
+ */
+void BM_ShardedPipeline(benchmark::State& state) {
+    LoadProfile profile = profile_for(state);
+    LoadGenerator generator(profile);
+    EngineDataQueue queue(config::QUEUE_SIZE);
+    PerformanceMetrics metrics;
+    QueueSignal signal;
+    ShardedPipeline<EngineDataQueue>::Options options;
+    options.num_shards = static_cast<size_t>(state.range(1));
+    options.shard_queue_size = config::SHARD_QUEUE_SIZE;
+    options.batch_size = config::CONSUMER_BATCH_SIZE;
+    ShardedPipeline<EngineDataQueue> pipeline(queue, metrics, signal, options);
+    bench::clock();
+    pipeline.Start();
+
+    auto processed = [&pipeline] {
+        uint64_t total = 0;
+        for (size_t i = 0; i < pipeline.num_shards(); ++i) {
+            total += pipeline.shard_processed(i);
+        }
+        return total;
+    };
+
+    uint64_t target = 0;
+    for (auto _ : state) {
+        target += EVENTS_PER_RUN;
+        std::thread producer(publish_bursts<EngineDataQueue>, std::ref(queue), std::ref(generator),
+                             EVENTS_PER_RUN, int64_t{0});
+        while (processed() < target) {
+            std::this_thread::yield();
+        }
+        producer.join();
+    }
+    pipeline.Stop();
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(EVENTS_PER_RUN));
+    HistogramSnapshot end_to_end;
+    for (size_t i = 0; i < pipeline.num_shards(); ++i) {
+        end_to_end.add(pipeline.shard_metrics(i).end_to_end_latency);
+    }
+    bench::report_latency(state, end_to_end);
+}
+
+} // namespace
+
+BENCHMARK(BM_ConsumerPipeline)
+    ->ArgNames({"burst", "gap_us"})
+    ->ArgsProduct({{64, 512, 4096}, {0, 100}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_ShardedPipeline)
+    ->ArgNames({"burst", "shards"})
+    ->ArgsProduct({{512}, {1, 2, 4}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
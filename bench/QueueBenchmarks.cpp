@@ -0,0 +1,188 @@
+// Microbenchmarks of the ring buffers: uncontended push/pop cost, then
+// producer/consumer throughput and queue latency for 1P1C, NP1C and NPMC
+// with single and bulk operations.
+
+#include "BenchSupport.hpp"
+#include "../include/CompactRingBuffer.hpp"
+#include "../include/LoadGenerator.hpp"
+#include "../include/LockFreeRingBuffer.hpp"
+#include "../include/SpscRingBuffer.hpp"
+#include "../include/WaitStrategy.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace market_data;
+
+namespace {
+
+constexpr size_t ITEMS_PER_RUN = size_t{1} << 20;
+constexpr size_t QUEUE_SIZE = 64 * 1024;
+
+using PaddedQueue = LockFreeRingBuffer<MarketDataPoint, SlotLayout::Padded>;
+using DenseQueue = LockFreeRingBuffer<MarketDataPoint, SlotLayout::Dense>;
+using SpscQueue = SpscRingBuffer<MarketDataPoint>;
+using CompactQueue = CompactRingBuffer;
+
+// Pre-generated so the generator is not part of what is timed (power of 2)
+const std::vector<MarketDataPoint>& sample_events() {
+    static const std::vector<MarketDataPoint> events = [] {
+        std::vector<MarketDataPoint> generated(4096);
+        LoadGenerator generator;
+        generator.fill(generated.data(), generated.size());
+        return generated;
+    }();
+    return events;
+}
+
+template<typename Queue>
+size_t push_some(Queue& queue, const MarketDataPoint* items, size_t count, size_t batch) {
+    if (batch == 1) {
+        return queue.try_push(items[0]) ? 1 : 0;
+    }
+    return queue.try_push_bulk(items, count);
+}
+
+template<typename Queue>
+size_t pop_some(Queue& queue, MarketDataPoint* items, size_t count, size_t batch) {
+    if (batch == 1) {
+        return queue.try_pop(items[0]) ? 1 : 0;
+    }
+    return queue.try_pop_bulk(items, count);
+}
+
+// Push count events in groups of batch, stamped when each group is handed over
+template<typename Queue>
+void produce(Queue& queue, size_t count, size_t batch) {
+    const auto& events = sample_events();
+    std::vector<MarketDataPoint> staging(batch);
+    SpinYieldWait wait;
+    size_t cursor = 0;
+    for (size_t sent = 0; sent < count;) {
+        size_t n = std::min(batch, count - sent);
+        for (size_t i = 0; i < n; ++i) {
+            staging[i] = events[cursor];
+            cursor = (cursor + 1) & (events.size() - 1);
+        }
+        stamp_enqueue(staging.data(), n);
+        for (size_t pushed = 0; pushed < n;) {
+            size_t k = push_some(queue, staging.data() + pushed, n - pushed, batch);
+            if (k == 0) {
+                wait.idle([] { return false; });
+            } else {
+                wait.reset();
+            }
+            pushed += k;
+        }
+        sent += n;
+    }
+}
+
+// Pop until the run's events are all consumed, recording queue latency
+template<typename Queue>
+void consume(Queue& queue, std::atomic<size_t>& remaining, size_t batch, ThreadMetrics& metrics) {
+    std::vector<MarketDataPoint> items(batch);
+    const TscClock& clock = TscClock::instance();
+    SpinYieldWait wait;
+    while (remaining.load(std::memory_order_relaxed) > 0) {
+        size_t n = pop_some(queue, items.data(), batch, batch);
+        if (n == 0) {
+            wait.idle([] { return false; });
+            continue;
+        }
+        wait.reset();
+        uint64_t now = clock.ticks();
+        for (size_t i = 0; i < n; ++i) {
+            metrics.queue_latency.record(clock.elapsed_ns(items[i].enqueue_tsc, now));
+        }
+        metrics.messages_processed.add(n);
+        remaining.fetch_sub(n, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Uncontended cost: one thread pushes a batch and pops it back.
+ * Arg: batch size (1 = try_push / try_pop).
+ */
+template<typename Queue>
+void BM_PushPopSingleThread(benchmark::State& state) {
+    auto batch = static_cast<size_t>(state.range(0));
+    Queue queue(QUEUE_SIZE);
+    std::vector<MarketDataPoint> items(sample_events().begin(), sample_events().begin() + static_cast<long>(batch));
+    std::vector<MarketDataPoint> out(batch);
+    for (auto _ : state) {
+        for (size_t pushed = 0; pushed < batch;) {
+            pushed += push_some(queue, items.data() + pushed, batch - pushed, batch);
+        }
+        for (size_t popped = 0; popped < batch;) {
+            popped += pop_some(queue, out.data() + popped, batch - popped, batch);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(batch));
+}
+
+/**
+ * Throughput with threads: ITEMS_PER_RUN events per iteration, split over
+ * the producers, drained by the consumers. Args: producers, consumers,
+ * batch size. Counters hold the enqueue -> dequeue latency percentiles.
+ */
+template<typename Queue>
+void BM_ProducersConsumers(benchmark::State& state) {
+    auto producers = static_cast<size_t>(state.range(0));
+    auto consumers = static_cast<size_t>(state.range(1));
+    auto batch = static_cast<size_t>(state.range(2));
+    Queue queue(QUEUE_SIZE);
+    std::vector<ThreadMetrics> metrics(consumers);
+    bench::clock();
+
+    for (auto _ : state) {
+        std::atomic<size_t> remaining{ITEMS_PER_RUN};
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < consumers; ++c) {
+            threads.emplace_back(consume<Queue>, std::ref(queue), std::ref(remaining), batch,
+                                 std::ref(metrics[c]));
+        }
+        for (size_t p = 0; p < producers; ++p) {
+            size_t share = ITEMS_PER_RUN / producers + (p < ITEMS_PER_RUN % producers ? 1 : 0);
+            threads.emplace_back(produce<Queue>, std::ref(queue), share, batch);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(ITEMS_PER_RUN));
+    bench::report_latency(state, bench::merge(metrics, &ThreadMetrics::queue_latency));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_PushPopSingleThread, PaddedQueue)->Arg(1)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_PushPopSingleThread, DenseQueue)->Arg(1)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_PushPopSingleThread, SpscQueue)->Arg(1)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_PushPopSingleThread, CompactQueue)->Arg(1)->Arg(16)->Arg(64)->Arg(256);
+
+BENCHMARK_TEMPLATE(BM_ProducersConsumers, PaddedQueue)
+    ->ArgNames({"producers", "consumers", "batch"})
+    ->ArgsProduct({{1, 2, 4}, {1, 2, 4}, {1, 64}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ProducersConsumers, DenseQueue)
+    ->ArgNames({"producers", "consumers", "batch"})
+    ->ArgsProduct({{1, 2, 4}, {1, 2, 4}, {1, 64}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ProducersConsumers, SpscQueue)
+    ->ArgNames({"producers", "consumers", "batch"})
+    ->ArgsProduct({{1}, {1}, {1, 64}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ProducersConsumers, CompactQueue)
+    ->ArgNames({"producers", "consumers", "batch"})
+    ->ArgsProduct({{1}, {1}, {1, 64}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,401 @@
+#pragma once
+
+#include "SpscRingBuffer.hpp"
+#include "ThreadAffinity.hpp"
+#include "ThreadMetrics.hpp"
+#include "TscClock.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace market_data {
+
+enum class LogLevel : uint8_t {
+    Info,       // Standard output
+    Warning,    // Standard error, "WARNING: " prefix
+    Error,      // Standard error, "ERROR: " prefix
+};
+
+/**
+ * A log message: level plus text where each "{}" takes the next argument.
+ * Define formats as static constants; records refer to them by address, so
+ * the text is never copied on the hot path.
+ */
+struct LogFormat {
+    LogLevel level;
+    const char* text;
+};
+
+/**
+ * LogRecord - one fixed-size log entry: format, arguments and a TscClock
+ * stamp (used to merge threads in time order). Two cache lines.
+ */
+struct LogRecord {
+    static constexpr size_t MAX_ARGS = 12;
+
+    enum class ArgKind : uint8_t { I64, U64, F64, Char, Str };
+
+    union Arg {
+        int64_t i;
+        uint64_t u;
+        double f;
+        const char* s;
+    };
+
+    uint64_t tsc;
+    const LogFormat* format;
+    uint8_t arg_count;
+    std::array<ArgKind, MAX_ARGS> kinds;
+    Arg args[MAX_ARGS];
+};
+
+static_assert(sizeof(LogRecord) == 128, "LogRecord should stay two cache lines");
+
+namespace log_detail {
+
+template<typename T>
+inline constexpr bool unsupported_arg = false;
+
+template<typename T>
+LogRecord::ArgKind put_arg(LogRecord::Arg& arg, T value) {
+    using Kind = LogRecord::ArgKind;
+    if constexpr (std::is_same_v<T, char>) {
+        arg.i = value;
+        return Kind::Char;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        arg.u = value ? 1 : 0;
+        return Kind::U64;
+    } else if constexpr (std::is_enum_v<T>) {
+        return put_arg(arg, static_cast<std::underlying_type_t<T>>(value));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        arg.i = value;
+        return Kind::I64;
+    } else if constexpr (std::is_integral_v<T>) {
+        arg.u = value;
+        return Kind::U64;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        arg.f = static_cast<double>(value);
+        return Kind::F64;
+    } else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+        arg.s = value;
+        return Kind::Str;
+    } else {
+        static_assert(unsupported_arg<T>, "Log arguments must be numbers, chars or static strings");
+        return Kind::I64;
+    }
+}
+
+/**
+ * Render a record into out as one line (background thread).
+ */
+inline void format_record(const LogRecord& record, std::string& out) {
+    using Kind = LogRecord::ArgKind;
+    char digits[32];
+    size_t next = 0;
+    for (const char* p = record.format->text; *p; ++p) {
+        if (p[0] != '{' || p[1] != '}') {
+            out.push_back(*p);
+            continue;
+        }
+        ++p;
+        if (next >= record.arg_count) {
+            out.append("{}");
+            continue;
+        }
+        const LogRecord::Arg& arg = record.args[next];
+        switch (record.kinds[next++]) {
+            case Kind::I64:
+                out.append(digits, std::to_chars(digits, digits + sizeof(digits), arg.i).ptr);
+                break;
+            case Kind::U64:
+                out.append(digits, std::to_chars(digits, digits + sizeof(digits), arg.u).ptr);
+                break;
+            case Kind::F64: {
+                // %g matches what the iostream reports printed
+                int n = std::snprintf(digits, sizeof(digits), "%g", arg.f);
+                out.append(digits, static_cast<size_t>(std::max(n, 0)));
+                break;
+            }
+            case Kind::Char:
+                out.push_back(static_cast<char>(arg.i));
+                break;
+            case Kind::Str:
+                out.append(arg.s ? arg.s : "(null)");
+                break;
+        }
+    }
+    out.push_back('\n');
+}
+
+} // namespace log_detail
+
+/**
+ * LogChannel - one thread's log queue, from AsyncLogger::register_thread().
+ *
+ * log() claims a slot in the channel's SPSC queue, stores the format
+ * address, the raw arguments and a TSC stamp, and publishes it: no
+ * formatting, no allocation, no lock and no system call. A full channel
+ * drops the record and counts it rather than stall the caller.
+ *
+ * Only the registering thread may call log() and sync().
+ */
+class LogChannel {
+public:
+    LogChannel(std::string name, size_t capacity, const MemoryOptions& memory)
+        : name_(std::move(name)), queue_(capacity, memory) {}
+
+    LogChannel(const LogChannel&) = delete;
+    LogChannel& operator=(const LogChannel&) = delete;
+
+    /**
+     * Queue one message. String arguments are stored as pointers, so they
+     * must outlive the logger (literals, static tables).
+     */
+    template<typename... Args>
+    void log(const LogFormat& format, const Args&... args) {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "Too many log arguments");
+        LogRecord* slot = queue_.try_claim();
+        if (!slot) {
+            dropped_.add(1);
+            return;
+        }
+        slot->tsc = TscClock::instance().ticks();
+        slot->format = &format;
+        slot->arg_count = static_cast<uint8_t>(sizeof...(Args));
+        size_t i = 0;
+        ((slot->kinds[i] = log_detail::put_arg<std::decay_t<const Args&>>(slot->args[i], args), ++i), ...);
+        (void)i;
+        queue_.commit(slot);
+        logged_.add(1);
+    }
+
+    /**
+     * Wait until everything this thread logged so far has been written
+     * (cold: before printing directly to the same stream).
+     */
+    void sync() const {
+        uint64_t target = logged_.load();
+        while (written_.load(std::memory_order_acquire) < target) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    const std::string& name() const { return name_; }
+
+    // Records dropped because the channel was full
+    uint64_t dropped() const { return dropped_.load(); }
+
+private:
+    friend class AsyncLogger;
+
+    std::string name_;
+    SpscRingBuffer<LogRecord> queue_;
+    ThreadCounter logged_;                // Written by the logging thread
+    ThreadCounter dropped_;
+    std::atomic<uint64_t> written_{0};    // Written by the background thread
+};
+
+/**
+ * AsyncLogger - binary logging for hot threads.
+ *
+ * Each thread that logs registers its own LogChannel, so hot paths never
+ * share a queue or a cache line. A background thread wakes every
+ * flush_interval, drains all channels, merges the records in TSC order,
+ * formats them and writes each destination with one fwrite and fflush.
+ * Hot threads never notify it; the price is up to flush_interval of
+ * output delay. Stop() (or the destructor) drains what is left.
+ *
+ * Channels live as long as the logger; register them once per thread
+ * slot, not per run.
+ */
+class AsyncLogger {
+public:
+    struct Options {
+        size_t queue_size = 16 * 1024;  // Records per channel, power of 2
+        std::chrono::microseconds flush_interval{1000};
+        size_t max_threads = 64;
+        ThreadPlacement placement;      // Background thread (never SCHED_FIFO)
+        MemoryOptions queue_memory;
+        std::FILE* out = stdout;        // Info
+        std::FILE* err = stderr;        // Warning, Error
+    };
+
+    AsyncLogger() : AsyncLogger(Options{}) {}
+
+    explicit AsyncLogger(const Options& options)
+        : options_(options), channels_(options.max_threads) {
+        options_.placement.fifo_priority = 0;
+        TscClock::instance();  // Calibrate before the first stamp
+    }
+
+    ~AsyncLogger() {
+        Stop();
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    /**
+     * A new channel for the calling thread (cold). Throws when max_threads
+     * channels exist.
+     */
+    LogChannel& register_thread(const std::string& name) {
+        std::lock_guard<std::mutex> lock(register_mutex_);
+        size_t index = channel_count_.load(std::memory_order_relaxed);
+        if (index >= channels_.size()) {
+            throw std::length_error("AsyncLogger: too many registered threads");
+        }
+        channels_[index] = std::make_unique<LogChannel>(name, options_.queue_size, options_.queue_memory);
+        channel_count_.store(index + 1, std::memory_order_release);
+        return *channels_[index];
+    }
+
+    /**
+     * Start the background thread.
+     */
+    void Start() {
+        if (running_.exchange(true)) {
+            return;
+        }
+        thread_ = std::thread([this] {
+            placements_.record("logger", apply_thread_placement(options_.placement));
+            Run();
+        });
+    }
+
+    /**
+     * Write everything queued so far and join the background thread.
+     */
+    void Stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    // Records dropped on full channels, over all threads
+    uint64_t dropped() const {
+        uint64_t total = 0;
+        size_t count = channel_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            total += channels_[i]->dropped();
+        }
+        return total;
+    }
+
+    /**
+     * Placement of the background thread once it started.
+     */
+    std::vector<PlacementLog::Entry> thread_placements() const { return placements_.entries(); }
+
+private:
+    static constexpr size_t POP_RECORDS = 1024;
+
+    struct Pending {
+        LogRecord record;
+        size_t channel;
+    };
+
+    void Run() {
+        std::vector<Pending> pending;
+        std::vector<LogRecord> batch(POP_RECORDS);
+        std::vector<uint64_t> taken(channels_.size(), 0);
+        std::vector<uint64_t> dropped_reported(channels_.size(), 0);
+        std::string out;
+        std::string err;
+        while (true) {
+            bool stopping = !running_.load(std::memory_order_acquire);
+
+            // Take whatever each channel holds right now
+            pending.clear();
+            size_t count = channel_count_.load(std::memory_order_acquire);
+            for (size_t c = 0; c < count; ++c) {
+                LogChannel& channel = *channels_[c];
+                size_t n;
+                while ((n = channel.queue_.try_pop_bulk(batch.data(), batch.size())) > 0) {
+                    for (size_t i = 0; i < n; ++i) {
+                        pending.push_back({batch[i], c});
+                    }
+                    taken[c] += n;
+                    if (n < batch.size()) {
+                        break;
+                    }
+                }
+            }
+
+            // Per channel the stamps already ascend; merge the channels
+            std::stable_sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+                return a.record.tsc < b.record.tsc;
+            });
+            for (const Pending& entry : pending) {
+                Append(entry.record, out, err);
+            }
+            for (size_t c = 0; c < count; ++c) {
+                uint64_t dropped = channels_[c]->dropped();
+                if (dropped != dropped_reported[c]) {
+                    err += "WARNING: log channel '" + channels_[c]->name() + "' dropped " +
+                           std::to_string(dropped - dropped_reported[c]) + " records\n";
+                    dropped_reported[c] = dropped;
+                }
+            }
+            Write(options_.out, out);
+            Write(options_.err, err);
+            for (size_t c = 0; c < count; ++c) {
+                channels_[c]->written_.store(taken[c], std::memory_order_release);
+            }
+
+            if (stopping) {
+                break;
+            }
+            std::this_thread::sleep_for(options_.flush_interval);
+        }
+    }
+
+    static void Append(const LogRecord& record, std::string& out, std::string& err) {
+        switch (record.format->level) {
+            case LogLevel::Info:
+                log_detail::format_record(record, out);
+                break;
+            case LogLevel::Warning:
+                err += "WARNING: ";
+                log_detail::format_record(record, err);
+                break;
+            case LogLevel::Error:
+                err += "ERROR: ";
+                log_detail::format_record(record, err);
+                break;
+        }
+    }
+
+    static void Write(std::FILE* file, std::string& text) {
+        if (!text.empty()) {
+            std::fwrite(text.data(), 1, text.size(), file);
+            std::fflush(file);
+            text.clear();
+        }
+    }
+
+    Options options_;
+    std::vector<std::unique_ptr<LogChannel>> channels_;
+    std::atomic<size_t> channel_count_{0};
+    std::mutex register_mutex_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    PlacementLog placements_;
+};
+
+} // namespace market_data
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "WaitStrategy.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace market_data {
+
+/**
+ * What a producer does when the queue is full.
+ *
+ * - Drop: discard the record and count a buffer overrun (original behaviour)
+ * - Block: back off and retry until the consumer makes room
+ * - DropOldest: evict the oldest queued records to make room (needs a
+ *   multi-consumer queue, the producer pops)
+ * - SpillToDisk: append to a spill file and feed it back in order once the
+ *   queue drains
+ */
+enum class OverflowPolicy {
+    Drop,
+    Block,
+    DropOldest,
+    SpillToDisk,
+};
+
+inline const char* to_string(OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::Drop:        return "drop";
+        case OverflowPolicy::Block:       return "block";
+        case OverflowPolicy::DropOldest:  return "drop-oldest";
+        case OverflowPolicy::SpillToDisk: return "spill";
+    }
+    return "unknown";
+}
+
+/**
+ * Parse a policy name as printed by to_string(). Returns false if unknown.
+ */
+inline bool parse_overflow_policy(const std::string& name, OverflowPolicy& policy) {
+    for (auto candidate : {OverflowPolicy::Drop, OverflowPolicy::Block,
+                           OverflowPolicy::DropOldest, OverflowPolicy::SpillToDisk}) {
+        if (name == to_string(candidate)) {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Bounded exponential backoff for a producer waiting on a full queue:
+ * PAUSE spins first, then yields, then sleeps doubling up to max_sleep.
+ */
+class Backoff {
+public:
+    explicit Backoff(std::chrono::microseconds max_sleep = std::chrono::microseconds(1000))
+        : max_sleep_(max_sleep) {}
+
+    void pause() {
+        if (step_ < SPIN_STEPS) {
+            cpu_relax();
+        } else if (step_ < SPIN_STEPS + YIELD_STEPS) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(sleep_);
+            if (sleep_ < max_sleep_) {
+                sleep_ *= 2;
+            }
+        }
+        ++step_;
+    }
+
+    void reset() {
+        step_ = 0;
+        sleep_ = std::chrono::microseconds(1);
+    }
+
+private:
+    static constexpr uint32_t SPIN_STEPS = 256;
+    static constexpr uint32_t YIELD_STEPS = 64;
+
+    std::chrono::microseconds max_sleep_;
+    std::chrono::microseconds sleep_{1};
+    uint32_t step_ = 0;
+};
+
+/**
+ * SpillFile - FIFO overflow of trivially copyable records to disk.
+ *
+ * Records are appended at the tail and read back from the head, so feeding
+ * the spill back into the queue before any newer record preserves order.
+ * The file is unlinked as soon as it is opened and truncated whenever it
+ * drains completely, so it only ever holds the current backlog.
+ */
+template<typename T>
+class SpillFile {
+    static_assert(std::is_trivially_copyable_v<T>, "Spilled records must be trivially copyable");
+
+public:
+    explicit SpillFile(const std::string& directory) {
+        std::string path = (directory.empty() ? std::string(".") : directory) + "/mde_spill_XXXXXX";
+        fd_ = ::mkstemp(path.data());
+        if (fd_ < 0) {
+            std::ostringstream oss;
+            oss << "Failed to create spill file in " << directory << ": " << std::strerror(errno);
+            throw std::runtime_error(oss.str());
+        }
+        ::unlink(path.c_str());
+    }
+
+    ~SpillFile() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    /**
+     * Append records at the tail. Throws on I/O errors.
+     */
+    void append(const T* items, std::size_t count) {
+        const char* data = reinterpret_cast<const char*>(items);
+        std::size_t bytes = count * sizeof(T);
+        while (bytes > 0) {
+            ssize_t written = ::pwrite(fd_, data, bytes, static_cast<off_t>(write_offset_));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::ostringstream oss;
+                oss << "Spill file write failed: " << std::strerror(errno);
+                throw std::runtime_error(oss.str());
+            }
+            data += written;
+            bytes -= static_cast<std::size_t>(written);
+            write_offset_ += static_cast<std::size_t>(written);
+        }
+    }
+
+    /**
+     * Copy up to max_count records from the head without consuming them.
+     * Call consume() with however many were actually published.
+     */
+    std::size_t peek(T* out, std::size_t max_count) const {
+        std::size_t available = pending();
+        std::size_t count = max_count < available ? max_count : available;
+        ssize_t got = ::pread(fd_, out, count * sizeof(T), static_cast<off_t>(read_offset_));
+        return got < 0 ? 0 : static_cast<std::size_t>(got) / sizeof(T);
+    }
+
+    void consume(std::size_t count) {
+        read_offset_ += count * sizeof(T);
+        if (read_offset_ == write_offset_) {
+            // Fully drained, give the space back
+            read_offset_ = write_offset_ = 0;
+            int rc = ::ftruncate(fd_, 0);  // Failure is harmless, space is reused
+            (void)rc;
+        }
+    }
+
+    /**
+     * Records spilled but not yet consumed.
+     */
+    std::size_t pending() const {
+        return (write_offset_ - read_offset_) / sizeof(T);
+    }
+
+private:
+    int fd_ = -1;
+    std::size_t write_offset_ = 0;
+    std::size_t read_offset_ = 0;
+};
+
+} // namespace market_data
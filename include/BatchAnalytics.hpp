@@ -0,0 +1,241 @@
+#pragma once
+
+#include "InstrumentTable.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace market_data {
+
+/**
+ * Vector instruction set used by the batch kernels, picked at runtime.
+ */
+enum class SimdLevel {
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+inline const char* to_string(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::Avx2:   return "avx2";
+        case SimdLevel::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+/**
+ * Widest instruction set this CPU supports.
+ */
+inline SimdLevel detect_simd_level() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::Avx2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+namespace simd {
+
+/**
+ * Column kernel: notional[i] = px[i] * qty[i] and
+ * spread[i] = (ask[i] - bid[i]) * top[i], where px/qty are zero for
+ * non-trades and top is 1.0 for updates to a two-sided top of book.
+ */
+using ColumnKernel = void (*)(const double* px, const double* qty,
+                              const double* bid, const double* ask, const double* top,
+                              double* notional, double* spread, size_t count);
+
+inline void columns_scalar(const double* px, const double* qty,
+                           const double* bid, const double* ask, const double* top,
+                           double* notional, double* spread, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        notional[i] = px[i] * qty[i];
+        spread[i] = (ask[i] - bid[i]) * top[i];
+    }
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+__attribute__((target("avx2,fma")))
+inline void columns_avx2(const double* px, const double* qty,
+                         const double* bid, const double* ask, const double* top,
+                         double* notional, double* spread, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d p = _mm256_load_pd(px + i);
+        __m256d q = _mm256_load_pd(qty + i);
+        __m256d b = _mm256_load_pd(bid + i);
+        __m256d a = _mm256_load_pd(ask + i);
+        __m256d t = _mm256_load_pd(top + i);
+        _mm256_store_pd(notional + i, _mm256_mul_pd(p, q));
+        _mm256_store_pd(spread + i, _mm256_mul_pd(_mm256_sub_pd(a, b), t));
+    }
+    columns_scalar(px + i, qty + i, bid + i, ask + i, top + i, notional + i, spread + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+inline void columns_avx512(const double* px, const double* qty,
+                           const double* bid, const double* ask, const double* top,
+                           double* notional, double* spread, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512d p = _mm512_load_pd(px + i);
+        __m512d q = _mm512_load_pd(qty + i);
+        __m512d b = _mm512_load_pd(bid + i);
+        __m512d a = _mm512_load_pd(ask + i);
+        __m512d t = _mm512_load_pd(top + i);
+        _mm512_store_pd(notional + i, _mm512_mul_pd(p, q));
+        _mm512_store_pd(spread + i, _mm512_mul_pd(_mm512_sub_pd(a, b), t));
+    }
+    columns_scalar(px + i, qty + i, bid + i, ask + i, top + i, notional + i, spread + i, count - i);
+}
+#endif
+
+inline ColumnKernel select_kernel(SimdLevel level) {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    switch (level) {
+        case SimdLevel::Avx512: return columns_avx512;
+        case SimdLevel::Avx2:   return columns_avx2;
+        case SimdLevel::Scalar: break;
+    }
+#else
+    (void)level;
+#endif
+    return columns_scalar;
+}
+
+} // namespace simd
+
+/**
+ * BatchAnalytics - structure-of-arrays path for a popped batch.
+ *
+ * process() transposes the batch into aligned columns (branch-free
+ * selects the compiler vectorizes), runs the column kernel for the widest
+ * instruction set the CPU supports, then walks runs of equal instrument_id
+ * once: one table lookup and one set of adds per run instead of per record.
+ * Quote / book-level events still update the book, and every event its
+ * rolling windows, record by record since both are state; the session
+ * VWAP and spread sums come from the columns.
+ *
+ * Needs double prices: with FIXED_POINT_PRICES callers keep the scalar
+ * InstrumentStats::update() path (and never instantiate process()).
+ *
+ * Template parameters:
+ * - Capacity: Events folded per pass (the consumer batch size); process()
+ *   splits larger input into passes.
+ */
+template<size_t Capacity>
+class BatchAnalytics {
+    // Default of process(): nothing per run
+    struct NoRunHook {
+        void operator()(const MarketDataPoint*, size_t, InstrumentStats&) const {}
+    };
+
+public:
+    explicit BatchAnalytics(SimdLevel level = detect_simd_level())
+        : level_(level), kernel_(simd::select_kernel(level)) {}
+
+    SimdLevel level() const { return level_; }
+
+    /**
+     * Fold count events into their instruments' stats, Capacity at a time.
+     * Events for instruments the table has no room for are skipped (the
+     * table's overflow_count() then counts runs rather than events).
+     * on_run(run, n, stats) is called once a run of n events of one
+     * instrument has been folded into its stats, so per-record work
+     * (latency, counters) reuses the run's lookup.
+     */
+    template<typename OnRun = NoRunHook>
+    void process(const MarketDataPoint* batch, size_t count, InstrumentTable<InstrumentStats>& table,
+                 OnRun&& on_run = {}) {
+        for (size_t done = 0; done < count; done += Capacity) {
+            process_chunk(batch + done, std::min(count - done, Capacity), table, on_run);
+        }
+    }
+
+private:
+    template<typename OnRun>
+    void process_chunk(const MarketDataPoint* batch, size_t count, InstrumentTable<InstrumentStats>& table,
+                       OnRun& on_run) {
+        // Transpose; non-trades contribute zero notional/qty, non-top updates zero spread
+        for (size_t i = 0; i < count; ++i) {
+            const MarketDataPoint& dp = batch[i];
+            bool trade = dp.type == EventType::Trade;
+            px_[i] = trade ? dp.bid_px : 0.0;
+            qty_[i] = trade ? static_cast<double>(dp.bid_sz) : 0.0;
+            bid_[i] = dp.bid_px;
+            ask_[i] = dp.ask_px;
+            top_[i] = InstrumentStats::changes_top(dp) ? 1.0 : 0.0;
+            trade_[i] = trade ? 1.0 : 0.0;
+            id_[i] = dp.instrument_id;
+        }
+
+        kernel_(px_, qty_, bid_, ask_, top_, notional_, spread_, count);
+
+        // Accumulate per run of equal instrument ids: one lookup per run
+        size_t i = 0;
+        while (i < count) {
+            int32_t id = id_[i];
+            InstrumentStats* stats = table.find_or_add(id);
+            if (!stats) {
+                while (i < count && id_[i] == id) {
+                    ++i;  // Table full, counted in overflow_count()
+                }
+                continue;
+            }
+
+            size_t run_start = i;
+            double notional = 0.0;
+            double qty = 0.0;
+            double spread = 0.0;
+            double trades = 0.0;
+            double spreads = 0.0;
+            for (; i < count && id_[i] == id; ++i) {
+                notional += notional_[i];
+                qty += qty_[i];
+                spread += spread_[i];
+                spreads += top_[i];
+                trades += trade_[i];
+                const MarketDataPoint& dp = batch[i];
+                if (trade_[i] == 0.0) {
+                    stats->apply_book_event(dp);
+                    if (top_[i] != 0.0) {
+                        stats->rolling.add_spread(dp.timestamp_delta, dp.ask_px - dp.bid_px);
+                    }
+                } else {
+                    stats->rolling.add_trade(dp.timestamp_delta, dp.bid_px, dp.bid_sz);
+                }
+            }
+            stats->vwap_tracker.add_sums(notional, qty);
+            stats->trades_processed += static_cast<uint64_t>(trades);
+            stats->spread_sum += spread;
+            stats->spread_samples += static_cast<uint64_t>(spreads);
+            on_run(batch + run_start, i - run_start, *stats);
+        }
+    }
+
+    SimdLevel level_;
+    simd::ColumnKernel kernel_;
+
+    alignas(64) double px_[Capacity];
+    alignas(64) double qty_[Capacity];
+    alignas(64) double bid_[Capacity];
+    alignas(64) double ask_[Capacity];
+    alignas(64) double top_[Capacity];
+    alignas(64) double trade_[Capacity];
+    alignas(64) int32_t id_[Capacity];
+    alignas(64) double notional_[Capacity];
+    alignas(64) double spread_[Capacity];
+};
+
+} // namespace market_data
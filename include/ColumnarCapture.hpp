@@ -0,0 +1,837 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Backpressure.hpp"
+#include "CompactRingBuffer.hpp"
+#include "InstrumentTable.hpp"
+#include "SpscRingBuffer.hpp"
+#include "ThreadAffinity.hpp"
+#include "WaitStrategy.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace market_data {
+
+/**
+ * Columns of a capture file. Prices are stored as int64 1e-9 fixed point
+ * whatever FIXED_POINT_PRICES is; enqueue_tsc is not stored.
+ */
+enum class CaptureColumn : uint32_t {
+    Timestamp,  // timestamp_delta, int64
+    BidPx,      // int64 fixed point
+    AskPx,
+    BidSz,      // uint32
+    AskSz,
+    Type,       // uint8 (EventType)
+    Side,       // uint8 ('A', 'B', 'N')
+    Level,      // uint8
+    Flags,      // uint8
+    Count
+};
+
+inline constexpr size_t CAPTURE_COLUMNS = static_cast<size_t>(CaptureColumn::Count);
+
+// Column mask bit, for CaptureReader::load()
+inline constexpr uint32_t column_bit(CaptureColumn column) {
+    return 1u << static_cast<uint32_t>(column);
+}
+
+inline constexpr uint32_t ALL_CAPTURE_COLUMNS = (1u << CAPTURE_COLUMNS) - 1;
+
+/**
+ * Capture file layout (little-endian, host structs):
+ *
+ *   CaptureFileHeader                      64 bytes
+ *   block 0: column 0 | column 1 | ...     one instrument, up to block_rows rows
+ *   block 1: ...
+ *   CaptureBlockIndex[block_count]         footer index
+ *   CaptureTrailer                         locates the index
+ *
+ * Each block holds one instrument's next block_rows records, one column
+ * after the other. Compressed files store the integer columns as
+ * zigzag-encoded deltas in LEB128 varints (prices and sizes move in small
+ * steps, timestamps in small gaps); byte columns are always raw.
+ */
+struct CaptureFileHeader {
+    char magic[8];            // "MDECAP1"
+    uint32_t version;
+    uint32_t block_rows;
+    uint32_t compressed;      // 1 = delta/varint integer columns
+    uint32_t columns;         // CAPTURE_COLUMNS when written
+    int64_t created_ns;       // Wall clock when the file was opened
+    uint8_t reserved[32];
+};
+
+struct CaptureBlockIndex {
+    int32_t instrument_id;
+    uint32_t rows;
+    int64_t ts_min;           // Smallest / largest timestamp_delta in the block
+    int64_t ts_max;
+    uint64_t offset;          // File offset of the first column
+    uint32_t column_bytes[CAPTURE_COLUMNS];
+    uint32_t reserved;
+};
+
+struct CaptureTrailer {
+    uint64_t index_offset;
+    uint64_t block_count;
+    char magic[8];            // "MDECAPIX"
+};
+
+static_assert(sizeof(CaptureFileHeader) == 64, "Capture header layout changed");
+static_assert(std::is_trivially_copyable_v<CaptureBlockIndex>, "Index entries are written raw");
+
+namespace capture_detail {
+
+inline constexpr char FILE_MAGIC[8] = {'M', 'D', 'E', 'C', 'A', 'P', '1', '\0'};
+inline constexpr char INDEX_MAGIC[8] = {'M', 'D', 'E', 'C', 'A', 'P', 'I', 'X'};
+inline constexpr uint32_t VERSION = 1;
+inline constexpr size_t MAX_VARINT_BYTES = 10;
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+/**
+ * Append one column's values to out: raw, or (compress, integers wider
+ * than a byte) deltas from the previous row as zigzag varints.
+ */
+template<typename T>
+void encode_column(const std::vector<T>& values, bool compress, std::vector<uint8_t>& out) {
+    if (!compress || sizeof(T) == 1) {
+        size_t at = out.size();
+        out.resize(at + values.size() * sizeof(T));
+        std::memcpy(out.data() + at, values.data(), values.size() * sizeof(T));
+        return;
+    }
+    size_t at = out.size();
+    out.resize(at + values.size() * MAX_VARINT_BYTES);  // Worst case, trimmed below
+    uint8_t* dst = out.data() + at;
+    int64_t previous = 0;
+    for (T value : values) {
+        auto current = static_cast<int64_t>(value);
+        // Wrapping difference: exact for any pair of int64 values
+        uint64_t v = zigzag(static_cast<int64_t>(static_cast<uint64_t>(current) - static_cast<uint64_t>(previous)));
+        previous = current;
+        while (v >= 0x80) {
+            *dst++ = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        *dst++ = static_cast<uint8_t>(v);
+    }
+    out.resize(static_cast<size_t>(dst - out.data()));
+}
+
+/**
+ * Decode rows values of one column written by encode_column, appending
+ * them to out. Throws on a truncated or oversized column.
+ */
+template<typename T>
+void decode_column(const uint8_t* data, size_t bytes, size_t rows, bool compress, std::vector<T>& out) {
+    size_t at = out.size();
+    out.resize(at + rows);
+    if (!compress || sizeof(T) == 1) {
+        if (bytes != rows * sizeof(T)) {
+            throw std::runtime_error("Corrupt capture block: raw column size mismatch");
+        }
+        std::memcpy(out.data() + at, data, bytes);
+        return;
+    }
+    const uint8_t* end = data + bytes;
+    int64_t previous = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        uint64_t v = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            if (data == end || shift > 63) {
+                throw std::runtime_error("Corrupt capture block: truncated varint column");
+            }
+            uint8_t byte = *data++;
+            v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        previous = static_cast<int64_t>(static_cast<uint64_t>(previous) + static_cast<uint64_t>(unzigzag(v)));
+        out[at + i] = static_cast<T>(previous);
+    }
+    if (data != end) {
+        throw std::runtime_error("Corrupt capture block: trailing bytes in varint column");
+    }
+}
+
+} // namespace capture_detail
+
+/**
+ * ColumnarCapture - writer stage that records a copy of the processed
+ * stream to a per-instrument columnar file for offline analytics.
+ *
+ * The thread that processes the stream (the consumer, or the router when
+ * sharded) calls append() for every record and flush() once per batch;
+ * records go through an SPSC queue to a dedicated I/O thread, which fills
+ * one column builder per instrument and writes a block each time an
+ * instrument reaches block_rows records. Blocks are staged in one large
+ * page-aligned buffer that goes to disk in whole-buffer sequential
+ * writes, so the file grows in write_buffer_bytes steps at aligned
+ * offsets. Stop() drains the queue, writes every partial block and the
+ * footer index. The file is only readable (CaptureReader) once stopped.
+ *
+ * A full capture queue back-pressures the producer, or drops the records
+ * (counted) with drop_on_full. I/O errors never reach the producer: the
+ * I/O thread stops writing, keeps draining, and reports error().
+ *
+ * Exactly one thread may call append() / flush().
+ */
+class ColumnarCapture {
+public:
+    struct Options {
+        std::string path;
+        size_t queue_size = 256 * 1024;               // Records (words with QUEUE_COMPACT), power of 2
+        uint32_t block_rows = 4096;                   // Rows per instrument block
+        bool compress = true;                         // Delta/varint integer columns
+        bool drop_on_full = false;                    // false = back-pressure the producer
+        size_t write_buffer_bytes = 4 * 1024 * 1024;  // Rounded up to whole 4 KiB pages
+        size_t instrument_capacity = 4096;            // Later instruments are dropped (counted)
+        ThreadPlacement placement;                    // I/O thread
+        MemoryOptions queue_memory;
+    };
+
+    /**
+     * Create (truncate) the capture file. Throws if it cannot be opened.
+     */
+    explicit ColumnarCapture(const Options& options)
+        : options_(options), queue_(options.queue_size, options.queue_memory),
+          builders_(options.instrument_capacity) {
+        if (options_.block_rows == 0) {
+            throw std::invalid_argument("ColumnarCapture needs a non-zero block size");
+        }
+        fd_ = ::open(options_.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            std::ostringstream oss;
+            oss << "Failed to create capture file " << options_.path << ": " << std::strerror(errno);
+            throw std::runtime_error(oss.str());
+        }
+        buffer_size_ = (std::max<size_t>(options_.write_buffer_bytes, PAGE) + PAGE - 1) / PAGE * PAGE;
+        buffer_.reset(static_cast<uint8_t*>(std::aligned_alloc(PAGE, buffer_size_)));
+        if (!buffer_) {
+            ::close(fd_);
+            throw std::bad_alloc();
+        }
+
+        CaptureFileHeader header{};
+        std::memcpy(header.magic, capture_detail::FILE_MAGIC, sizeof(header.magic));
+        header.version = capture_detail::VERSION;
+        header.block_rows = options_.block_rows;
+        header.compressed = options_.compress ? 1 : 0;
+        header.columns = static_cast<uint32_t>(CAPTURE_COLUMNS);
+        header.created_ns = MarketDataPoint::current_timestamp_ns();
+        Append(&header, sizeof(header));
+    }
+
+    ~ColumnarCapture() {
+        Stop();
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    ColumnarCapture(const ColumnarCapture&) = delete;
+    ColumnarCapture& operator=(const ColumnarCapture&) = delete;
+
+    /**
+     * Start the I/O thread.
+     */
+    void Start() {
+        if (started_.exchange(true)) {
+            return;
+        }
+        io_thread_ = std::thread([this] {
+            placements_.record("capture", apply_thread_placement(options_.placement));
+            IoLoop();
+        });
+    }
+
+    /**
+     * Drain what was appended, write the partial blocks and the footer,
+     * and close the file. Call once the producer has flushed for the last
+     * time.
+     */
+    void Stop() {
+        if (!started_.load() || stopping_.exchange(true)) {
+            return;
+        }
+        signal_.wake_all();
+        if (io_thread_.joinable()) {
+            io_thread_.join();
+        }
+    }
+
+    /**
+     * Producer: stage one record, publishing a batch when the stage fills.
+     */
+    void append(const MarketDataPoint& dp) {
+        stage_[staged_++] = dp;
+        if (staged_ == stage_.size()) {
+            flush();
+        }
+    }
+
+    void append(const MarketDataPoint* items, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            append(items[i]);
+        }
+    }
+
+    /**
+     * Producer: publish the staged records to the I/O thread.
+     */
+    void flush() {
+        if (staged_ == 0) {
+            return;
+        }
+        size_t pushed = 0;
+        backoff_.reset();
+        while (pushed < staged_) {
+            size_t n = queue_.try_push_bulk(stage_.data() + pushed, staged_ - pushed);
+            if (n > 0) {
+                pushed += n;
+                signal_.notify();
+                backoff_.reset();
+            } else if (options_.drop_on_full) {
+                queue_drops_.store(queue_drops_.load(std::memory_order_relaxed) + (staged_ - pushed),
+                                   std::memory_order_relaxed);
+                break;
+            } else {
+                backoff_.pause();
+            }
+        }
+        staged_ = 0;
+    }
+
+    /**
+     * Progress counters (relaxed, readable from any thread).
+     */
+    uint64_t records_written() const { return records_written_.load(std::memory_order_relaxed); }
+    uint64_t blocks_written() const { return blocks_written_.load(std::memory_order_relaxed); }
+    uint64_t bytes_written() const { return bytes_written_.load(std::memory_order_relaxed); }
+
+    // Dropped on a full queue (drop_on_full), a full instrument table or after an I/O error
+    uint64_t records_dropped() const {
+        return queue_drops_.load(std::memory_order_relaxed) + io_drops_.load(std::memory_order_relaxed);
+    }
+
+    const std::string& path() const { return options_.path; }
+
+    /**
+     * First I/O error, empty if none.
+     */
+    std::string error() const {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        return error_;
+    }
+
+    /**
+     * Placement of the I/O thread once it started.
+     */
+    std::vector<PlacementLog::Entry> thread_placements() const { return placements_.entries(); }
+
+private:
+    static constexpr size_t PAGE = 4096;
+    static constexpr size_t STAGE_RECORDS = 64;
+    static constexpr size_t POP_RECORDS = 256;
+
+    using Queue = std::conditional_t<config::QUEUE_COMPACT, CompactRingBuffer, SpscRingBuffer<MarketDataPoint>>;
+
+    // One instrument's open block, column by column
+    struct ColumnBuilder {
+        std::vector<int64_t> timestamp;
+        std::vector<int64_t> bid_px;
+        std::vector<int64_t> ask_px;
+        std::vector<uint32_t> bid_sz;
+        std::vector<uint32_t> ask_sz;
+        std::vector<uint8_t> type;
+        std::vector<uint8_t> side;
+        std::vector<uint8_t> level;
+        std::vector<uint8_t> flags;
+
+        size_t rows() const { return timestamp.size(); }
+
+        void reserve(size_t rows) {
+            timestamp.reserve(rows);
+            bid_px.reserve(rows);
+            ask_px.reserve(rows);
+            bid_sz.reserve(rows);
+            ask_sz.reserve(rows);
+            type.reserve(rows);
+            side.reserve(rows);
+            level.reserve(rows);
+            flags.reserve(rows);
+        }
+
+        void add(const MarketDataPoint& dp) {
+            timestamp.push_back(dp.timestamp_delta);
+            bid_px.push_back(price_to_fixed(dp.bid_px));
+            ask_px.push_back(price_to_fixed(dp.ask_px));
+            bid_sz.push_back(dp.bid_sz);
+            ask_sz.push_back(dp.ask_sz);
+            type.push_back(static_cast<uint8_t>(dp.type));
+            side.push_back(static_cast<uint8_t>(dp.side));
+            level.push_back(dp.level);
+            flags.push_back(dp.flags);
+        }
+
+        void clear() {
+            timestamp.clear();
+            bid_px.clear();
+            ask_px.clear();
+            bid_sz.clear();
+            ask_sz.clear();
+            type.clear();
+            side.clear();
+            level.clear();
+            flags.clear();
+        }
+    };
+
+    struct FreeDeleter {
+        void operator()(uint8_t* p) const { std::free(p); }
+    };
+
+    void IoLoop() {
+        std::vector<MarketDataPoint> batch(POP_RECORDS);
+        BlockingWait wait(signal_);
+        while (true) {
+            size_t popped = queue_.try_pop_bulk(batch.data(), batch.size());
+            if (popped > 0) {
+                for (size_t i = 0; i < popped; ++i) {
+                    Record(batch[i]);
+                }
+                wait.reset();
+            } else if (stopping_.load(std::memory_order_acquire)) {
+                // The producer is done, so an empty queue stays empty
+                if (queue_.empty()) {
+                    break;
+                }
+            } else {
+                wait.idle([this] { return !queue_.empty() || stopping_.load(); });
+            }
+        }
+
+        builders_.for_each([this](int id, ColumnBuilder& builder) {
+            if (builder.rows() > 0) {
+                WriteBlock(id, builder);
+            }
+        });
+        WriteFooter();
+    }
+
+    void Record(const MarketDataPoint& dp) {
+        ColumnBuilder* builder = failed_ ? nullptr : builders_.find_or_add(dp.instrument_id);
+        if (!builder) {
+            io_drops_.store(io_drops_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        if (builder->rows() == 0) {
+            builder->reserve(options_.block_rows);
+        }
+        builder->add(dp);
+        if (builder->rows() == options_.block_rows) {
+            WriteBlock(dp.instrument_id, *builder);
+        }
+    }
+
+    void WriteBlock(int32_t instrument_id, ColumnBuilder& builder) {
+        CaptureBlockIndex entry{};
+        entry.instrument_id = instrument_id;
+        entry.rows = static_cast<uint32_t>(builder.rows());
+        entry.ts_min = INT64_MAX;
+        entry.ts_max = INT64_MIN;
+        for (int64_t ts : builder.timestamp) {
+            entry.ts_min = std::min(entry.ts_min, ts);
+            entry.ts_max = std::max(entry.ts_max, ts);
+        }
+        entry.offset = file_offset_;
+
+        auto put = [&](CaptureColumn column, const auto& values) {
+            scratch_.clear();
+            capture_detail::encode_column(values, options_.compress, scratch_);
+            entry.column_bytes[static_cast<size_t>(column)] = static_cast<uint32_t>(scratch_.size());
+            Append(scratch_.data(), scratch_.size());
+        };
+        put(CaptureColumn::Timestamp, builder.timestamp);
+        put(CaptureColumn::BidPx, builder.bid_px);
+        put(CaptureColumn::AskPx, builder.ask_px);
+        put(CaptureColumn::BidSz, builder.bid_sz);
+        put(CaptureColumn::AskSz, builder.ask_sz);
+        put(CaptureColumn::Type, builder.type);
+        put(CaptureColumn::Side, builder.side);
+        put(CaptureColumn::Level, builder.level);
+        put(CaptureColumn::Flags, builder.flags);
+
+        index_.push_back(entry);
+        records_written_.store(records_written_.load(std::memory_order_relaxed) + entry.rows,
+                               std::memory_order_relaxed);
+        blocks_written_.store(index_.size(), std::memory_order_relaxed);
+        builder.clear();
+    }
+
+    void WriteFooter() {
+        CaptureTrailer trailer{};
+        trailer.index_offset = file_offset_;
+        trailer.block_count = index_.size();
+        std::memcpy(trailer.magic, capture_detail::INDEX_MAGIC, sizeof(trailer.magic));
+        Append(index_.data(), index_.size() * sizeof(CaptureBlockIndex));
+        Append(&trailer, sizeof(trailer));
+        WriteOut(buffered_);
+    }
+
+    // Stage bytes in the aligned buffer, writing it out each time it fills
+    void Append(const void* data, size_t bytes) {
+        const auto* src = static_cast<const uint8_t*>(data);
+        file_offset_ += bytes;
+        while (bytes > 0) {
+            size_t n = std::min(bytes, buffer_size_ - buffered_);
+            std::memcpy(buffer_.get() + buffered_, src, n);
+            buffered_ += n;
+            src += n;
+            bytes -= n;
+            if (buffered_ == buffer_size_) {
+                WriteOut(buffered_);
+            }
+        }
+    }
+
+    void WriteOut(size_t bytes) {
+        const uint8_t* data = buffer_.get();
+        buffered_ = 0;
+        while (bytes > 0 && !failed_) {
+            ssize_t written = ::write(fd_, data, bytes);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                Fail(std::strerror(errno));
+                return;
+            }
+            data += written;
+            bytes -= static_cast<size_t>(written);
+            bytes_written_.store(bytes_written_.load(std::memory_order_relaxed) + static_cast<uint64_t>(written),
+                                 std::memory_order_relaxed);
+        }
+    }
+
+    void Fail(const std::string& reason) {
+        failed_ = true;
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error_ = "Capture file write failed (" + options_.path + "): " + reason;
+    }
+
+    Options options_;
+    Queue queue_;
+    QueueSignal signal_;
+    std::thread io_thread_;
+    std::atomic<bool> started_{false};
+    std::atomic<bool> stopping_{false};
+    PlacementLog placements_;
+
+    // Producer side
+    alignas(64) std::array<MarketDataPoint, STAGE_RECORDS> stage_;
+    size_t staged_ = 0;
+    Backoff backoff_;
+    std::atomic<uint64_t> queue_drops_{0};
+
+    // I/O thread side
+    alignas(64) InstrumentTable<ColumnBuilder> builders_;
+    std::vector<CaptureBlockIndex> index_;
+    std::vector<uint8_t> scratch_;
+    std::unique_ptr<uint8_t, FreeDeleter> buffer_;
+    size_t buffer_size_ = 0;
+    size_t buffered_ = 0;
+    uint64_t file_offset_ = 0;
+    int fd_ = -1;
+    bool failed_ = false;
+    std::atomic<uint64_t> records_written_{0};
+    std::atomic<uint64_t> blocks_written_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> io_drops_{0};
+
+    mutable std::mutex error_mutex_;
+    std::string error_;
+};
+
+/**
+ * Columns loaded from a capture file, one entry per row. Columns that were
+ * not asked for stay empty; timestamp is always loaded.
+ */
+struct CaptureColumns {
+    std::vector<int64_t> timestamp;
+    std::vector<Price> bid_px;
+    std::vector<Price> ask_px;
+    std::vector<uint32_t> bid_sz;
+    std::vector<uint32_t> ask_sz;
+    std::vector<uint8_t> type;
+    std::vector<uint8_t> side;
+    std::vector<uint8_t> level;
+    std::vector<uint8_t> flags;
+
+    size_t rows() const { return timestamp.size(); }
+
+    void reserve(size_t rows, uint32_t columns) {
+        auto reserve_if = [rows, columns](CaptureColumn column, auto& values) {
+            if ((columns & column_bit(column)) != 0) {
+                values.reserve(rows);
+            }
+        };
+        timestamp.reserve(rows);
+        reserve_if(CaptureColumn::BidPx, bid_px);
+        reserve_if(CaptureColumn::AskPx, ask_px);
+        reserve_if(CaptureColumn::BidSz, bid_sz);
+        reserve_if(CaptureColumn::AskSz, ask_sz);
+        reserve_if(CaptureColumn::Type, type);
+        reserve_if(CaptureColumn::Side, side);
+        reserve_if(CaptureColumn::Level, level);
+        reserve_if(CaptureColumn::Flags, flags);
+    }
+};
+
+/**
+ * CaptureReader - random access to a finished capture file.
+ *
+ * Opening reads only the header and the footer index. load() then picks
+ * the instrument's blocks whose time range overlaps the query and reads
+ * just the requested columns of those blocks (one pread per column), so a
+ * VWAP study over one symbol and one hour touches a few column runs
+ * instead of the whole file.
+ */
+class CaptureReader {
+public:
+    explicit CaptureReader(const std::string& path) : path_(path) {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            std::ostringstream oss;
+            oss << "Failed to open capture file " << path << ": " << std::strerror(errno);
+            throw std::runtime_error(oss.str());
+        }
+        try {
+            ReadIndex();
+        } catch (...) {
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    ~CaptureReader() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    const CaptureFileHeader& header() const { return header_; }
+    const std::vector<CaptureBlockIndex>& blocks() const { return index_; }
+
+    /**
+     * Indices of an instrument's blocks that overlap [from_ts, to_ts], in
+     * file order (which is stream order for the instrument).
+     */
+    std::vector<size_t> find(int32_t instrument_id, int64_t from_ts = INT64_MIN, int64_t to_ts = INT64_MAX) const {
+        std::vector<size_t> found;
+        for (size_t i = 0; i < index_.size(); ++i) {
+            const CaptureBlockIndex& block = index_[i];
+            if (block.instrument_id == instrument_id && block.ts_max >= from_ts && block.ts_min <= to_ts) {
+                found.push_back(i);
+            }
+        }
+        return found;
+    }
+
+    /**
+     * An instrument's rows with from_ts <= timestamp <= to_ts, limited to
+     * the columns in the mask (column_bit()). Throws on I/O errors or a
+     * corrupt block.
+     */
+    CaptureColumns load(int32_t instrument_id,
+                        int64_t from_ts = INT64_MIN,
+                        int64_t to_ts = INT64_MAX,
+                        uint32_t columns = ALL_CAPTURE_COLUMNS) const {
+        columns |= column_bit(CaptureColumn::Timestamp);  // Needed to cut the range
+        CaptureColumns out;
+        std::vector<size_t> blocks = find(instrument_id, from_ts, to_ts);
+        size_t rows = 0;
+        for (size_t i : blocks) {
+            rows += index_[i].rows;
+        }
+        out.reserve(rows, columns);
+        for (size_t i : blocks) {
+            size_t first = out.rows();
+            LoadBlock(index_[i], columns, out);
+            if (index_[i].ts_min < from_ts || index_[i].ts_max > to_ts) {
+                Trim(out, first, from_ts, to_ts);
+            }
+        }
+        return out;
+    }
+
+private:
+    void ReadIndex() {
+        ReadAt(&header_, sizeof(header_), 0);
+        if (std::memcmp(header_.magic, capture_detail::FILE_MAGIC, sizeof(header_.magic)) != 0 ||
+            header_.version != capture_detail::VERSION || header_.columns != CAPTURE_COLUMNS) {
+            throw std::runtime_error("Not a capture file (or unsupported version): " + path_);
+        }
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0 ||
+            static_cast<uint64_t>(st.st_size) < sizeof(CaptureFileHeader) + sizeof(CaptureTrailer)) {
+            throw std::runtime_error("Capture file is truncated (not stopped cleanly?): " + path_);
+        }
+        auto file_size = static_cast<uint64_t>(st.st_size);
+        CaptureTrailer trailer{};
+        ReadAt(&trailer, sizeof(trailer), file_size - sizeof(trailer));
+        if (std::memcmp(trailer.magic, capture_detail::INDEX_MAGIC, sizeof(trailer.magic)) != 0 ||
+            trailer.index_offset + trailer.block_count * sizeof(CaptureBlockIndex) + sizeof(trailer) != file_size) {
+            throw std::runtime_error("Capture file has no footer index (not stopped cleanly?): " + path_);
+        }
+        index_.resize(trailer.block_count);
+        ReadAt(index_.data(), index_.size() * sizeof(CaptureBlockIndex), trailer.index_offset);
+    }
+
+    void LoadBlock(const CaptureBlockIndex& block, uint32_t columns, CaptureColumns& out) const {
+        bool compressed = header_.compressed != 0;
+        std::vector<int64_t> fixed;
+        uint64_t offset = block.offset;
+        for (size_t c = 0; c < CAPTURE_COLUMNS; ++c) {
+            uint32_t bytes = block.column_bytes[c];
+            if ((columns & (1u << c)) != 0) {
+                scratch_.resize(bytes);
+                ReadAt(scratch_.data(), bytes, offset);
+                const uint8_t* data = scratch_.data();
+                switch (static_cast<CaptureColumn>(c)) {
+                    case CaptureColumn::Timestamp:
+                        capture_detail::decode_column(data, bytes, block.rows, compressed, out.timestamp);
+                        break;
+                    case CaptureColumn::BidPx:
+                    case CaptureColumn::AskPx: {
+                        fixed.clear();
+                        capture_detail::decode_column(data, bytes, block.rows, compressed, fixed);
+                        auto& prices = c == static_cast<size_t>(CaptureColumn::BidPx) ? out.bid_px : out.ask_px;
+                        for (int64_t px : fixed) {
+                            prices.push_back(price_from_fixed(px));
+                        }
+                        break;
+                    }
+                    case CaptureColumn::BidSz:
+                        capture_detail::decode_column(data, bytes, block.rows, compressed, out.bid_sz);
+                        break;
+                    case CaptureColumn::AskSz:
+                        capture_detail::decode_column(data, bytes, block.rows, compressed, out.ask_sz);
+                        break;
+                    case CaptureColumn::Type:
+                        capture_detail::decode_column(data, bytes, block.rows, compressed, out.type);
+                        break;
+                    case CaptureColumn::Side:
+                        capture_detail::decode_column(data, bytes, block.rows, compressed, out.side);
+                        break;
+                    case CaptureColumn::Level:
+                        capture_detail::decode_column(data, bytes, block.rows, compressed, out.level);
+                        break;
+                    case CaptureColumn::Flags:
+                        capture_detail::decode_column(data, bytes, block.rows, compressed, out.flags);
+                        break;
+                    case CaptureColumn::Count:
+                        break;
+                }
+            }
+            offset += bytes;
+        }
+    }
+
+    // Drop the rows from first on that fall outside [from_ts, to_ts]
+    static void Trim(CaptureColumns& out, size_t first, int64_t from_ts, int64_t to_ts) {
+        size_t kept = first;
+        auto keep = [&](auto& column, size_t from, size_t to) {
+            if (!column.empty()) {
+                column[to] = column[from];
+            }
+        };
+        for (size_t i = first; i < out.rows(); ++i) {
+            int64_t ts = out.timestamp[i];
+            if (ts < from_ts || ts > to_ts) {
+                continue;
+            }
+            keep(out.timestamp, i, kept);
+            keep(out.bid_px, i, kept);
+            keep(out.ask_px, i, kept);
+            keep(out.bid_sz, i, kept);
+            keep(out.ask_sz, i, kept);
+            keep(out.type, i, kept);
+            keep(out.side, i, kept);
+            keep(out.level, i, kept);
+            keep(out.flags, i, kept);
+            ++kept;
+        }
+        auto cut = [kept](auto& column) {
+            if (!column.empty()) {
+                column.resize(kept);
+            }
+        };
+        cut(out.bid_px);
+        cut(out.ask_px);
+        cut(out.bid_sz);
+        cut(out.ask_sz);
+        cut(out.type);
+        cut(out.side);
+        cut(out.level);
+        cut(out.flags);
+        out.timestamp.resize(kept);
+    }
+
+    void ReadAt(void* data, size_t bytes, uint64_t offset) const {
+        auto* dst = static_cast<uint8_t*>(data);
+        while (bytes > 0) {
+            ssize_t got = ::pread(fd_, dst, bytes, static_cast<off_t>(offset));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                std::ostringstream oss;
+                oss << "Capture file read failed (" << path_ << "): "
+                    << (got < 0 ? std::strerror(errno) : "unexpected end of file");
+                throw std::runtime_error(oss.str());
+            }
+            dst += got;
+            bytes -= static_cast<size_t>(got);
+            offset += static_cast<uint64_t>(got);
+        }
+    }
+
+    std::string path_;
+    int fd_ = -1;
+    CaptureFileHeader header_{};
+    std::vector<CaptureBlockIndex> index_;
+    mutable std::vector<uint8_t> scratch_;
+};
+
+} // namespace market_data
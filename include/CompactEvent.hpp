@@ -0,0 +1,311 @@
+#pragma once
+
+#include "Config.hpp"
+#include "InstrumentTable.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * CompactEvent - 16-byte wire word for MarketDataPoint streams.
+ *
+ * An event word carries the timestamp as a delta from the previous event,
+ * the instrument as an index into a dictionary both ends build as the
+ * stream goes, and prices as a change in COMPACT_PRICE_TICK units from
+ * that instrument's previous bid / ask. Anything that doesn't fit (a new
+ * instrument, a long gap, a big price move, an off-tick price, a size over
+ * 65535) is escaped: a FULL control word followed by the record's 48 raw
+ * bytes in three more words. A STAMP control word carries a new enqueue
+ * TSC stamp, which whole publish batches share. Decoding is exact, so the
+ * encoding is lossless.
+ *
+ * Encoder and decoder state evolve identically from the words in order,
+ * so one stream needs exactly one writer and one reader.
+ */
+struct CompactEvent {
+    std::uint32_t ts_delta;     // ns after the previous event's timestamp_delta
+    std::uint16_t instrument;   // Dictionary index
+    std::uint8_t header;        // type (2 bits) | side (2 bits) | level (4 bits)
+    std::uint8_t flags;         // DBN record flags
+    std::int16_t bid_ticks;     // Change from the instrument's last bid_px
+    std::int16_t ask_ticks;     // Change from the instrument's last ask_px
+    std::uint16_t bid_sz;
+    std::uint16_t ask_sz;
+};
+static_assert(sizeof(CompactEvent) == 16, "CompactEvent must stay 16 bytes");
+static_assert(sizeof(MarketDataPoint) == 3 * sizeof(CompactEvent), "FULL escape carries 3 payload words");
+
+namespace compact_detail {
+
+inline constexpr std::uint8_t CONTROL_TYPE = 3;        // Header type of control words
+inline constexpr std::uint8_t OP_FULL = 0;             // Control opcode (level bits): raw record follows
+inline constexpr std::uint8_t OP_STAMP = 1;            // Control opcode: new enqueue TSC in the payload
+inline constexpr std::uint16_t NO_INSTRUMENT = 0xFFFF; // FULL record outside the dictionary
+inline constexpr std::size_t PAYLOAD_OFFSET = 8;       // Control words keep a uint64 in bytes 8..15
+
+inline std::uint8_t header_type(const CompactEvent& word) { return word.header & 0x3; }
+inline std::uint8_t header_level(const CompactEvent& word) { return static_cast<std::uint8_t>(word.header >> 4); }
+
+inline CompactEvent control(std::uint8_t op, std::uint16_t instrument, std::uint64_t payload) {
+    CompactEvent word{};
+    word.header = static_cast<std::uint8_t>(CONTROL_TYPE | (op << 4));
+    word.instrument = instrument;
+    std::memcpy(reinterpret_cast<char*>(&word) + PAYLOAD_OFFSET, &payload, sizeof(payload));
+    return word;
+}
+
+inline std::uint64_t control_payload(const CompactEvent& word) {
+    std::uint64_t payload;
+    std::memcpy(&payload, reinterpret_cast<const char*>(&word) + PAYLOAD_OFFSET, sizeof(payload));
+    return payload;
+}
+
+// Side byte -> 2-bit code, 0xFF for anything but 'N', 'A', 'B'
+inline constexpr std::array<std::uint8_t, 256> SIDE_CODES = [] {
+    std::array<std::uint8_t, 256> codes{};
+    for (auto& code : codes) {
+        code = 0xFF;
+    }
+    codes['N'] = 0;
+    codes['A'] = 1;
+    codes['B'] = 2;
+    return codes;
+}();
+
+inline char side_from_code(std::uint8_t code) {
+    return code == 1 ? 'A' : code == 2 ? 'B' : 'N';
+}
+
+// price_to_fixed, but false if a double price has no exact fixed-point
+// form (it then travels in a FULL escape)
+inline bool exact_fixed(Price px, std::int64_t& fixed) {
+    if constexpr (config::FIXED_POINT_PRICES) {
+        fixed = px;
+        return true;
+    } else {
+        double scaled = px * static_cast<double>(PRICE_SCALE);
+        bool in_range = std::fabs(scaled) < 9.0e18;  // Also false for NaN
+        fixed = in_range ? price_to_fixed(px) : 0;
+        double back = static_cast<double>(fixed) / PRICE_SCALE;
+        std::uint64_t back_bits;
+        std::uint64_t px_bits;
+        std::memcpy(&back_bits, &back, sizeof(back));
+        std::memcpy(&px_bits, &px, sizeof(px));
+        return in_range & (back_bits == px_bits);  // Bitwise, so -0.0 is escaped too
+    }
+}
+
+// Per-instrument price predictor, kept identically on both ends
+struct LastPrices {
+    std::int64_t bid = 0;
+    std::int64_t ask = 0;
+
+    // Trades move the bid predictor only; their ask fields are always zero
+    void remember(const MarketDataPoint& dp) {
+        std::int64_t fixed;
+        if (exact_fixed(dp.bid_px, fixed)) {
+            bid = fixed;
+        }
+        if (dp.type != EventType::Trade && exact_fixed(dp.ask_px, fixed)) {
+            ask = fixed;
+        }
+    }
+};
+
+// Tick change from last to fixed, false when off-tick or out of int16 range
+inline bool tick_delta(std::int64_t fixed, std::int64_t last, std::int16_t& ticks) {
+    std::int64_t delta;
+    bool overflow = __builtin_sub_overflow(fixed, last, &delta);
+    std::int64_t count = delta / config::COMPACT_PRICE_TICK;
+    ticks = static_cast<std::int16_t>(count);
+    return !overflow & (count * config::COMPACT_PRICE_TICK == delta) &
+           (count >= std::numeric_limits<std::int16_t>::min()) & (count <= std::numeric_limits<std::int16_t>::max());
+}
+
+} // namespace compact_detail
+
+/**
+ * Producer end of a compact stream.
+ */
+class CompactEncoder {
+public:
+    static constexpr std::size_t MAX_WORDS = 4;  // FULL escape; a compact event takes 2 at most (STAMP + event)
+
+    explicit CompactEncoder(std::size_t max_instruments = config::COMPACT_MAX_INSTRUMENTS)
+        : dictionary_(std::min<std::size_t>(max_instruments, compact_detail::NO_INSTRUMENT)) {}
+
+    /**
+     * Encode dp into out (room for MAX_WORDS words). Returns the number of
+     * words written.
+     */
+    std::size_t encode(const MarketDataPoint& dp, CompactEvent* out) {
+        using namespace compact_detail;
+        encoded_.add(1);
+        Entry* entry = dictionary_.find_or_add(dp.instrument_id);
+        if (entry && entry->index != NO_INSTRUMENT) {
+            CompactEvent event;
+            std::int64_t bid = 0;
+            std::int64_t ask = 0;
+            if (encode_event(dp, *entry, event, bid, ask)) {
+                std::size_t words = 0;
+                if (dp.enqueue_tsc != tsc_) {
+                    out[words++] = control(OP_STAMP, 0, dp.enqueue_tsc);
+                    tsc_ = dp.enqueue_tsc;
+                }
+                out[words++] = event;
+                last_ts_ = dp.timestamp_delta;
+                entry->last.bid = bid;
+                if (dp.type != EventType::Trade) {
+                    entry->last.ask = ask;
+                }
+                return words;
+            }
+        }
+        return escape(dp, entry, out);
+    }
+
+    /**
+     * Records encoded and records that had to be escaped whole.
+     */
+    uint64_t encoded_records() const { return encoded_.load(); }
+    uint64_t escaped_records() const { return escaped_.load(); }
+
+private:
+    struct Entry {
+        compact_detail::LastPrices last;
+        std::uint16_t index = compact_detail::NO_INSTRUMENT;  // Assigned by the first FULL record
+    };
+
+    // bid / ask receive the new fixed-point prices for the predictor. The
+    // checks are combined without short-circuiting: event types and sides
+    // arrive in no predictable order, so branches on them would mispredict
+    bool encode_event(const MarketDataPoint& dp, const Entry& entry, CompactEvent& word,
+                      std::int64_t& bid, std::int64_t& ask) const {
+        using namespace compact_detail;
+        std::uint8_t side = SIDE_CODES[static_cast<std::uint8_t>(dp.side)];
+        std::uint64_t ts_delta = static_cast<std::uint64_t>(dp.timestamp_delta) - static_cast<std::uint64_t>(last_ts_);
+        bool trade = dp.type == EventType::Trade;
+        bool ok = (dp.timestamp_delta >= last_ts_) & (ts_delta <= std::numeric_limits<std::uint32_t>::max()) &
+                  (static_cast<std::uint8_t>(dp.type) < CONTROL_TYPE) & (side <= 2) & (dp.level <= 0xF) &
+                  (dp.bid_sz <= std::numeric_limits<std::uint16_t>::max()) &
+                  (dp.ask_sz <= std::numeric_limits<std::uint16_t>::max()) & (!trade | (dp.ask_sz == 0));
+        ok &= exact_fixed(dp.bid_px, bid);
+        ok &= exact_fixed(dp.ask_px, ask);
+        ok &= tick_delta(bid, entry.last.bid, word.bid_ticks);
+        ok &= tick_delta(ask, trade ? 0 : entry.last.ask, word.ask_ticks);  // A trade's ask must be 0
+        word.ts_delta = static_cast<std::uint32_t>(ts_delta);
+        word.instrument = entry.index;
+        word.header = static_cast<std::uint8_t>(static_cast<std::uint8_t>(dp.type) | (side << 2) | (dp.level << 4));
+        word.flags = dp.flags;
+        word.bid_sz = static_cast<std::uint16_t>(dp.bid_sz);
+        word.ask_sz = static_cast<std::uint16_t>(dp.ask_sz);
+        return ok;
+    }
+
+    // FULL control word + raw record; also where instruments join the
+    // dictionary (entry is nullptr once it is full)
+    __attribute__((noinline)) std::size_t escape(const MarketDataPoint& dp, Entry* entry, CompactEvent* out) {
+        using namespace compact_detail;
+        escaped_.add(1);
+        std::uint16_t index = NO_INSTRUMENT;
+        if (entry) {
+            if (entry->index == NO_INSTRUMENT) {
+                entry->index = static_cast<std::uint16_t>(dictionary_.find(dp.instrument_id));
+            }
+            index = entry->index;
+            entry->last.remember(dp);
+        }
+        out[0] = control(OP_FULL, index, 0);
+        std::memcpy(static_cast<void*>(&out[1]), &dp, sizeof(dp));
+        last_ts_ = dp.timestamp_delta;
+        tsc_ = dp.enqueue_tsc;
+        return 4;
+    }
+
+    InstrumentTable<Entry> dictionary_;  // Capped below NO_INSTRUMENT, so slots fit the index
+    std::int64_t last_ts_ = 0;
+    std::uint64_t tsc_ = 0;
+    ThreadCounter encoded_;
+    ThreadCounter escaped_;
+};
+
+/**
+ * Consumer end of a compact stream.
+ */
+class CompactDecoder {
+public:
+    explicit CompactDecoder(std::size_t max_instruments = config::COMPACT_MAX_INSTRUMENTS)
+        : dictionary_(std::min<std::size_t>(max_instruments, compact_detail::NO_INSTRUMENT)) {}
+
+    /**
+     * Words in the unit that starts with word: 4 for a FULL escape, else 1.
+     */
+    static std::size_t unit_words(const CompactEvent& word) {
+        using namespace compact_detail;
+        return header_type(word) == CONTROL_TYPE && header_level(word) == OP_FULL ? 4 : 1;
+    }
+
+    /**
+     * Decode the unit at words (unit_words(words[0]) words). Returns false
+     * for a STAMP word, which only updates state and yields no record.
+     */
+    bool decode(const CompactEvent* words, MarketDataPoint& dp) {
+        using namespace compact_detail;
+        const CompactEvent& word = words[0];
+        if (header_type(word) == CONTROL_TYPE) {
+            if (header_level(word) == OP_STAMP) {
+                tsc_ = control_payload(word);
+                return false;
+            }
+            std::memcpy(static_cast<void*>(&dp), &words[1], sizeof(dp));
+            if (word.instrument != NO_INSTRUMENT) {
+                Entry& entry = dictionary_[word.instrument];
+                entry.instrument_id = dp.instrument_id;
+                entry.last.remember(dp);
+            }
+            last_ts_ = dp.timestamp_delta;
+            tsc_ = dp.enqueue_tsc;
+            return true;
+        }
+
+        Entry& entry = dictionary_[word.instrument];
+        last_ts_ += static_cast<std::int64_t>(word.ts_delta);
+        entry.last.bid += static_cast<std::int64_t>(word.bid_ticks) * config::COMPACT_PRICE_TICK;
+        dp.timestamp_delta = last_ts_;
+        dp.enqueue_tsc = tsc_;
+        dp.instrument_id = entry.instrument_id;
+        dp.type = static_cast<EventType>(header_type(word));
+        dp.side = side_from_code(static_cast<std::uint8_t>((word.header >> 2) & 0x3));
+        dp.level = header_level(word);
+        dp.flags = word.flags;
+        dp.bid_px = price_from_fixed(entry.last.bid);
+        dp.bid_sz = word.bid_sz;
+        if (dp.type == EventType::Trade) {
+            dp.ask_px = 0;
+        } else {
+            entry.last.ask += static_cast<std::int64_t>(word.ask_ticks) * config::COMPACT_PRICE_TICK;
+            dp.ask_px = price_from_fixed(entry.last.ask);
+        }
+        dp.ask_sz = word.ask_sz;
+        return true;
+    }
+
+private:
+    struct Entry {
+        std::int32_t instrument_id = 0;
+        compact_detail::LastPrices last;
+    };
+
+    std::vector<Entry> dictionary_;  // By dictionary index
+    std::int64_t last_ts_ = 0;
+    std::uint64_t tsc_ = 0;
+};
+
+} // namespace market_data
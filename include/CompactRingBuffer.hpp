@@ -0,0 +1,182 @@
+#pragma once
+
+#include "CompactEvent.hpp"
+#include "SpscRingBuffer.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace market_data {
+
+/**
+ * CompactRingBuffer - SPSC queue of MarketDataPoint stored as CompactEvent
+ * words.
+ *
+ * Same interface as SpscRingBuffer<MarketDataPoint>, so it drops in as the
+ * engine queue or a shard queue. The producer encodes on push and the
+ * consumer decodes on pop (see CompactEvent.hpp): a typical record takes
+ * one 16-byte word instead of 48 bytes, four to a cache line; escaped
+ * records take four words.
+ *
+ * Records are published whole: a bulk push only starts a record when the
+ * queue has room for its worst-case encoding, so a consumer never waits
+ * on half a record. size() and capacity() count words, not records.
+ *
+ * The zero-copy calls are kept for interface compatibility but copy:
+ * try_claim() hands out a staging record that commit() encodes, and
+ * try_peek() decodes the next record into a buffer.
+ *
+ * Exactly one thread may push and exactly one thread may pop.
+ */
+class CompactRingBuffer {
+public:
+    static constexpr bool MULTI_PRODUCER = false;
+    static constexpr bool MULTI_CONSUMER = false;
+
+    // size is in words (power of 2)
+    explicit CompactRingBuffer(std::size_t size, const MemoryOptions& options = {})
+        : words_(std::max<std::size_t>(size, 2 * CompactEncoder::MAX_WORDS), options) {}
+
+    CompactRingBuffer(const CompactRingBuffer&) = delete;
+    CompactRingBuffer& operator=(const CompactRingBuffer&) = delete;
+
+    bool try_push(const MarketDataPoint& item) {
+        return try_push_bulk(&item, 1) == 1;
+    }
+
+    /**
+     * Encode and push up to count records (producer thread only). Returns
+     * the number of records pushed.
+     */
+    std::size_t try_push_bulk(const MarketDataPoint* items, std::size_t count) {
+        std::size_t room = words_.free_space(count * CompactEncoder::MAX_WORDS);
+        std::size_t pushed = 0;
+        std::size_t staged = 0;
+        while (pushed < count && room >= CompactEncoder::MAX_WORDS) {
+            if (staged + CompactEncoder::MAX_WORDS > producer_.stage.size()) {
+                words_.try_push_bulk(producer_.stage.data(), staged);  // Fits: room was checked
+                staged = 0;
+            }
+            std::size_t n = producer_.encoder.encode(items[pushed++], producer_.stage.data() + staged);
+            staged += n;
+            room -= n;
+        }
+        if (staged > 0) {
+            words_.try_push_bulk(producer_.stage.data(), staged);
+        }
+        return pushed;
+    }
+
+    bool try_pop(MarketDataPoint& item) {
+        CompactEvent unit[CompactEncoder::MAX_WORDS];
+        while (words_.try_pop(unit[0])) {
+            pop_rest(unit, 1, CompactDecoder::unit_words(unit[0]));
+            if (consumer_.decoder.decode(unit, item)) {
+                return true;
+            }
+            // A STAMP word: its record follows in the same publish
+        }
+        return false;
+    }
+
+    /**
+     * Pop and decode up to count records (consumer thread only). Returns
+     * the number of records popped.
+     */
+    std::size_t try_pop_bulk(MarketDataPoint* items, std::size_t count) {
+        auto& scratch = consumer_.scratch;
+        std::size_t produced = 0;
+        while (produced < count) {
+            // Each record takes at least one word, so this never decodes more than count
+            std::size_t want = std::min(count - produced, POP_WORDS);
+            std::size_t n = words_.try_pop_bulk(scratch.data(), want);
+            if (n == 0) {
+                break;
+            }
+            for (std::size_t i = 0; i < n;) {
+                std::size_t len = CompactDecoder::unit_words(scratch[i]);
+                if (i + len > n) {
+                    n = pop_rest(scratch.data(), n, i + len);
+                }
+                if (consumer_.decoder.decode(&scratch[i], items[produced])) {
+                    ++produced;
+                }
+                i += len;
+            }
+            if (n < want) {
+                break;
+            }
+        }
+        return produced;
+    }
+
+    /**
+     * Staging record to fill in place, nullptr if the queue may be full.
+     */
+    MarketDataPoint* try_claim() {
+        return words_.free_space(CompactEncoder::MAX_WORDS) >= CompactEncoder::MAX_WORDS ? &producer_.claimed
+                                                                                         : nullptr;
+    }
+
+    void commit(MarketDataPoint* slot) {
+        std::size_t n = producer_.encoder.encode(*slot, producer_.stage.data());
+        words_.try_push_bulk(producer_.stage.data(), n);
+    }
+
+    const MarketDataPoint* try_peek() {
+        if (!consumer_.peeked) {
+            consumer_.peeked = try_pop(consumer_.peek);
+        }
+        return consumer_.peeked ? &consumer_.peek : nullptr;
+    }
+
+    void release(const MarketDataPoint* slot) {
+        (void)slot;
+        consumer_.peeked = false;
+    }
+
+    double utilization() const { return words_.utilization(); }
+    size_t size() const { return words_.size(); }
+    bool empty() const { return words_.empty(); }
+    size_t capacity() const { return words_.capacity(); }
+    void close() { words_.close(); }  // End of stream, see SpscRingBuffer::close()
+    bool closed() const { return words_.closed(); }
+    PageBacking page_backing() const { return words_.page_backing(); }
+    size_t memory_bytes() const { return words_.memory_bytes(); }
+
+    /**
+     * Records pushed so far and how many of them were escaped whole
+     * (readable from any thread).
+     */
+    uint64_t encoded_records() const { return producer_.encoder.encoded_records(); }
+    uint64_t escaped_records() const { return producer_.encoder.escaped_records(); }
+
+private:
+    static constexpr std::size_t STAGE_WORDS = 256;
+    static constexpr std::size_t POP_WORDS = 256;
+
+    // The tail of a unit is published with its head, so this never waits for long
+    std::size_t pop_rest(CompactEvent* words, std::size_t have, std::size_t need) {
+        while (have < need) {
+            have += words_.try_pop_bulk(words + have, need - have);
+        }
+        return have;
+    }
+
+    SpscRingBuffer<CompactEvent> words_;
+
+    struct alignas(64) ProducerSide {
+        CompactEncoder encoder;
+        std::array<CompactEvent, STAGE_WORDS> stage;
+        MarketDataPoint claimed;
+    } producer_;
+
+    struct alignas(64) ConsumerSide {
+        CompactDecoder decoder;
+        std::array<CompactEvent, POP_WORDS + CompactEncoder::MAX_WORDS - 1> scratch;  // Room for a straddling unit
+        MarketDataPoint peek;
+        bool peeked = false;
+    } consumer_;
+};
+
+} // namespace market_data
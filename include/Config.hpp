@@ -1,22 +1,178 @@
 #pragma once
+#include "Backpressure.hpp"
+#include "WaitStrategy.hpp"
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace config {
 
 // === Queue Parameters ===
-inline constexpr size_t QUEUE_SIZE = 1024 * 1024;  // 1M slots
+inline constexpr size_t QUEUE_SIZE = 1024 * 1024;  // 1M slots, must be a power of 2
+inline constexpr bool QUEUE_USE_HUGE_PAGES = true;  // Back the slot array with 2 MiB pages
+inline constexpr int QUEUE_NUMA_NODE = -1;          // Preferred NUMA node, -1 = node of the consuming core (if pinned)
+inline constexpr bool QUEUE_DENSE_LAYOUT = false;   // Packed sequence/payload arrays instead of 64-byte slots
+inline constexpr bool QUEUE_SPSC = true;            // One fetcher + one consumer: CAS-free SPSC queue
+inline constexpr size_t PUBLISH_BATCH_SIZE = 64;    // Records staged by the fetch thread per bulk push
+inline constexpr size_t CONSUMER_BATCH_SIZE = 256;  // Max records a consumer pops per bulk pop
+inline constexpr bool ZERO_COPY_PUBLISH = false;    // Decode into claimed slots / read peeked slots in place
+// Store records in the SPSC queues (the engine queue with QUEUE_SPSC, and the
+// shard queues) as 16-byte CompactEvent words: timestamp delta, instrument
+// dictionary index, price change in ticks; what doesn't fit is escaped whole.
+// QUEUE_SIZE / SHARD_QUEUE_SIZE then count words
+inline constexpr bool QUEUE_COMPACT = false;
+inline constexpr int64_t COMPACT_PRICE_TICK = 10000000;  // Price quantum of the encoding, 1e-9 units (0.01)
+inline constexpr size_t COMPACT_MAX_INSTRUMENTS = 4096;  // Dictionary size; later instruments are always escaped
+// Put the engine queue in a named POSIX shared-memory segment: this process
+// only produces, strategy processes built with SHARED_QUEUE_ATTACH consume
+// it directly (SharedMemoryQueue.hpp). Overrides QUEUE_SPSC
+inline constexpr bool QUEUE_SHARED_MEMORY = false;
+inline const std::string SHARED_QUEUE_NAME = "/mde_queue";
+inline constexpr bool SHARED_QUEUE_ATTACH = false;       // Consume another engine's shared queue instead of fetching
+inline constexpr int SHARED_QUEUE_ATTACH_TIMEOUT_MS = 10000;  // How long to wait for the producer's segment
+
+// === Price Parameters ===
+// true: carry DBN's int64 1e-9 fixed-point prices through MarketDataPoint and
+// do VWAP / book arithmetic in integers (128-bit accumulators), converting
+// to double only for reports; bit-reproducible across runs
+inline constexpr bool FIXED_POINT_PRICES = false;
+
+// === Backpressure Parameters ===
+// drop: discard on a full queue, block: wait for the consumer,
+// drop-oldest: evict queued records (MPMC only), spill: overflow to disk
+inline constexpr market_data::OverflowPolicy OVERFLOW_POLICY = market_data::OverflowPolicy::Block;
+inline constexpr int BACKPRESSURE_MAX_STALL_MS = 0;  // Give up blocking after this long, 0 = never
+inline const std::string SPILL_DIRECTORY = "/tmp";   // Where the spill policy puts its file
+
+// === Consumer Parameters ===
+// busy-spin: lowest latency, one full core per consumer
+// spin-yield: spin then sched_yield between polls
+// blocking: spin then park on a futex, producer wakes it only when parked
+// sleep: fixed 100us sleep on an empty queue (legacy behaviour)
+inline constexpr market_data::WaitStrategyKind CONSUMER_WAIT_STRATEGY = market_data::WaitStrategyKind::Blocking;
+inline constexpr uint32_t CONSUMER_SPIN_LIMIT = 1000;  // Empty polls before yielding / parking
+inline constexpr size_t INSTRUMENT_TABLE_CAPACITY = 4096;  // Instruments tracked per consumer / shard
+// Rolling-window stats per instrument (event time, ns); each window is split
+// into ROLLING_WINDOW_BUCKETS buckets, so it expires at bucket granularity
+inline constexpr std::array<int64_t, 3> ROLLING_WINDOWS_NS = {1000000000LL, 60000000000LL, 300000000000LL};
+inline constexpr size_t ROLLING_WINDOW_BUCKETS = 16;
+// Transpose each popped batch into columns and run SIMD kernels (AVX-512 /
+// AVX2 / scalar, picked at runtime); double prices only
+inline constexpr bool CONSUMER_SOA_BATCH = false;
+
+// === Sharding Parameters ===
+// 0 = single consumer thread; K > 0 = router + K workers partitioned by instrument_id
+inline constexpr size_t NUM_SHARDS = 0;
+inline constexpr size_t SHARD_QUEUE_SIZE = 64 * 1024;  // Per-shard SPSC queue, power of 2
+inline const std::vector<int> SHARD_CORES = {};       // Core per shard worker (missing = unpinned)
+inline constexpr int ROUTER_CORE = -1;                // Core for the router thread, -1 = unpinned
 
 // === Databento Parameters ===
 inline const std::string DATASET = "GLBX.MDP3";  
 inline const std::vector<std::string> SYMBOLS = {"ES.FUT", "NQ.FUT", "YM.FUT"};  
 inline const std::string START_TIME = "2022-06-10T14:30:00";  
 inline const std::string END_TIME   = "2022-06-10T14:35:00";  
-inline const std::string SCHEMA     = "bbo-1s";  
+inline const std::string SCHEMA     = "mbp-1";  // Trades + quotes at tick resolution
 inline constexpr int FETCH_TIMEOUT_SECONDS = 30;
+// Fetched ranges are kept here as DBN files and replayed via mmap on later
+// runs; empty = always download
+inline const std::string DBN_CACHE_DIRECTORY = ".dbn_cache";
+// Release records on their ts_recv schedule: 1.0 = real time, N = N x faster,
+// 0.0 = as fast as the source delivers
+inline constexpr double REPLAY_SPEED = 0.0;
+
+// === Parallel Fetch Parameters ===
+// The window is split into FETCH_TIME_SLICES x FETCH_SYMBOL_GROUPS chunks,
+// fetched by FETCH_PARALLELISM workers; more than one worker needs an MPMC
+// queue (QUEUE_SPSC = false), otherwise the chunks run sequentially
+inline constexpr size_t FETCH_TIME_SLICES = 1;
+inline constexpr size_t FETCH_SYMBOL_GROUPS = 1;
+inline constexpr size_t FETCH_PARALLELISM = 1;
+inline constexpr size_t MAX_FETCH_CHUNKS = 256;
+
+// === Job Parameters ===
+// Defaults of the runtime settings (RuntimeConfig.hpp): the dataset,
+// symbols, range, queue size, timeouts, cache, replay speed, fetch plan,
+// capture path and metrics export can be overridden per run with
+// --config FILE and --key value options, and the file can list several
+// fetch jobs. Jobs run on JOB_WORKERS historical handlers, each with its
+// own connection, queue and consumer, kept warm for the whole job list
+inline constexpr size_t JOB_WORKERS = 1;
+
+// === Live Feed Parameters ===
+// Subscribe to the live gateway instead of fetching START_TIME..END_TIME;
+// runs until interrupted
+inline constexpr bool USE_LIVE_FEED = false;
+inline const std::string LIVE_SCHEMA = "mbp-1";       // Any schema SCHEMA accepts
+inline constexpr int LIVE_RECEIVE_CORE = -1;          // Core for the receive thread, -1 = unpinned
+
+// === Thread Placement Parameters ===
+// Core per engine thread role, -1 / missing = let the kernel place it (shard,
+// router and live receive cores are set in their own sections). Placement is
+// applied when each thread starts and read back into the startup log.
+inline constexpr int FETCH_CORE = -1;                    // Historical fetch thread
+inline const std::vector<int> FETCH_WORKER_CORES = {};  // Parallel fetch workers, in start order
+inline constexpr int CONSUMER_CORE = -1;                // Single consumer thread
+// SCHED_FIFO priority (1-99) for every pinned engine thread, 0 = normal
+// scheduling. Needs CAP_SYS_NICE or an rtprio limit; refusals are logged
+inline constexpr int REALTIME_PRIORITY = 0;
+// mlockall() at startup so queue and table pages never fault on the hot path
+inline constexpr bool LOCK_MEMORY = false;
+
+// === Metrics Parameters ===
+// Producer / consumer threads that can register per-thread metrics with one
+// source (the fetch thread, each parallel fetch worker, consumers, router)
+inline constexpr size_t MAX_METRICS_THREADS = 64;
+// Stamp records with a TSC enqueue time and measure queue / processing
+// latency per record in the consumers (one extra clock read per record)
+inline constexpr bool TRACK_RECORD_LATENCY = true;
+// Live export (MetricsExporter.hpp): every METRICS_EXPORT_INTERVAL_MS a
+// background thread samples the metrics into Prometheus text, served on
+// METRICS_HTTP_PORT (GET /metrics), and into the shared-memory page
+// METRICS_SHARED_NAME; both off by default
+inline constexpr int METRICS_HTTP_PORT = 0;               // e.g. 9464, 0 = off
+inline const std::string METRICS_HTTP_BIND = "127.0.0.1";
+inline const std::string METRICS_SHARED_NAME = "";        // e.g. "/mde_metrics", "" = off
+inline constexpr int METRICS_EXPORT_INTERVAL_MS = 1000;
+inline constexpr int METRICS_CORE = -1;                   // Core for the exporter thread, -1 = unpinned
+
+// === Capture Parameters ===
+// Record a copy of the processed stream (consumer, or router when sharded)
+// to a per-instrument columnar file for offline analytics, "" = off. See
+// ColumnarCapture.hpp for the format and CaptureReader for loading it back
+inline const std::string CAPTURE_PATH = "";
+inline constexpr size_t CAPTURE_QUEUE_SIZE = 256 * 1024;  // Records to the I/O thread, power of 2
+inline constexpr uint32_t CAPTURE_BLOCK_ROWS = 4096;      // Rows per instrument column block
+inline constexpr bool CAPTURE_COMPRESS = true;            // Delta/varint integer columns
+inline constexpr bool CAPTURE_DROP_ON_FULL = false;       // false = a slow disk back-pressures the stream
+inline constexpr int CAPTURE_CORE = -1;                   // Core for the I/O thread, -1 = unpinned
+
+// === Multicast Parameters ===
+// Fan the processed stream out to other processes over UDP multicast
+// (publisher, fed like the capture), and/or read it back from another
+// engine instead of Databento (subscriber). See MulticastFeed.hpp
+inline constexpr bool MULTICAST_PUBLISH = false;
+inline constexpr bool USE_MULTICAST_FEED = false;          // Overrides USE_LIVE_FEED
+inline const std::string MULTICAST_GROUP = "239.192.0.1";  // A unicast address works for one subscriber
+inline constexpr uint16_t MULTICAST_PORT = 31001;
+inline const std::string MULTICAST_INTERFACE = "";         // Local interface address, "" = default route
+inline constexpr int MULTICAST_TTL = 1;                    // 1 = stay on the local network
+inline constexpr bool MULTICAST_LOOPBACK = true;           // Deliver to subscribers on this host
+inline constexpr size_t MULTICAST_PAYLOAD_BYTES = 1472;    // Per datagram, fits a 1500-byte MTU
+inline constexpr size_t MULTICAST_QUEUE_SIZE = 256 * 1024; // Records to the sender thread, power of 2
+inline constexpr bool MULTICAST_DROP_ON_FULL = false;      // false = a slow sender back-pressures the stream
+inline constexpr int MULTICAST_CORE = -1;                  // Core for the sender thread, -1 = unpinned
+inline constexpr int MULTICAST_RECEIVE_CORE = -1;          // Core for the subscriber's receive thread
+inline constexpr int MULTICAST_BUSY_POLL_US = 0;           // Subscriber SO_BUSY_POLL, 0 = off
 
 // === Logging Parameters ===
 inline constexpr bool ENABLE_SAMPLE_OUTPUT = true;
 inline constexpr size_t SAMPLE_PRINT_EVERY = 1000;
+// Hot threads (consumer, producers) queue binary log records that a
+// background thread formats and writes (AsyncLogger.hpp)
+inline constexpr size_t LOG_QUEUE_SIZE = 16 * 1024;   // Records per logging thread, power of 2
+inline constexpr int LOG_FLUSH_INTERVAL_US = 1000;    // How often the logger thread drains and writes
+inline constexpr int LOG_CORE = -1;                   // Core for the logger thread, -1 = unpinned
 
 } // namespace config
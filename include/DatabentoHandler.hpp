@@ -1,50 +1,84 @@
 #pragma once
 
+#include "Backpressure.hpp"
+#include "Config.hpp"
+#include "DbnCache.hpp"
+#include "FetchPlanner.hpp"
+#include "InstrumentTable.hpp"
 #include "LockFreeRingBuffer.hpp"
+#include "MarketDataSource.hpp"
+#include "RecordDecoder.hpp"
+#include "ReorderBuffer.hpp"
+#include "ReplayPacer.hpp"
+#include "SpscRingBuffer.hpp"
+#include "WaitStrategy.hpp"
 #include "Types.hpp"
 #include <databento/historical.hpp>
 #include <databento/dbn.hpp>
+#include <databento/dbn_file_store.hpp>
 #include <databento/symbol_map.hpp>
+#include <array>
 #include <memory>
 #include <string>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <functional>
+#include <mutex>
+#include <type_traits>
 
 namespace market_data {
 
 /**
- * DatabentoHandler - Handles historical data fetching from Databento API
- * and pushes MarketDataPoint objects to the MPMC lock-free queue.
+ * BasicDatabentoHandler - Handles historical data fetching from Databento API
+ * and pushes MarketDataPoint objects to a lock-free queue.
  * 
- * Currently supports BBO (Best Bid Offer) schema for historical data.
+ * Template parameters:
+ * - QueueT: Queue policy shared with consumers. LockFreeRingBuffer (MPMC) or
+ *   SpscRingBuffer when there is exactly one fetch thread and one consumer.
+ *   Explicitly instantiated in DatabentoHandler.cpp for the queue types above.
+ * 
+ * Supports the bbo-1s / bbo-1m, trades, mbp-1 and mbp-10 schemas; each
+ * record is decoded into one or more typed events (quote, trade print,
+ * book level) as listed in RecordDecoder.hpp.
+ * With a fetch plan (SetFetchPlan) a request is split into time-slice x
+ * symbol-group chunks fetched concurrently, each worker publishing as its
+ * own producer; that needs a multi-producer queue, otherwise the chunks
+ * run one after another. With a cache directory set, every range (or
+ * chunk) is written to an uncompressed DBN file while it streams in and
+ * replayed from an mmap after.
  */
-class DatabentoHandler {
+template<typename QueueT>
+class BasicDatabentoHandler : public MarketDataSource<QueueT> {
 public:
-    // Constructor with configuration
-    explicit DatabentoHandler(const std::string& api_key,
-                             size_t queue_size = 1024 * 1024);  // Default 1M buffer
+    using DataQueue = QueueT;
+    
+    // Constructor with configuration (queue_size must be a power of 2)
+    explicit BasicDatabentoHandler(const std::string& api_key,
+                             size_t queue_size = 1024 * 1024,  // Default 1M buffer
+                             const MemoryOptions& queue_memory = {});
     
     // Destructor
-    ~DatabentoHandler();
+    ~BasicDatabentoHandler() override;
     
     // Non-copyable
-    DatabentoHandler(const DatabentoHandler&) = delete;
-    DatabentoHandler& operator=(const DatabentoHandler&) = delete;
+    BasicDatabentoHandler(const BasicDatabentoHandler&) = delete;
+    BasicDatabentoHandler& operator=(const BasicDatabentoHandler&) = delete;
     
     /**
      * Initialize the handler with API key from environment
      */
-    static std::unique_ptr<DatabentoHandler> CreateFromEnv(size_t queue_size = 1024 * 1024);
+    static std::unique_ptr<BasicDatabentoHandler> CreateFromEnv(size_t queue_size = 1024 * 1024,
+                                                           const MemoryOptions& queue_memory = {});
     
     /**
-     * Fetch historical BBO data and push to queue
+     * Fetch historical data and push its events to the queue
      * 
      * @param dataset The dataset to fetch from (e.g., "GLBX.MDP3")
      * @param symbols List of symbols to fetch
      * @param start_time Start time in ISO 8601 format
      * @param end_time End time in ISO 8601 format
-     * @param schema BBO schema variant ("bbo-1s" or "bbo-1m")
+     * @param schema "bbo-1s", "bbo-1m", "trades", "mbp-1" or "mbp-10"
      * @param stype_in Symbol type for input (default: Parent)
      * @return true if successful, false otherwise
      */
@@ -74,42 +108,225 @@ public:
      */
     void StopAsyncFetch();
     
+    /**
+     * MarketDataSource interface: an async fetch of the request
+     */
+    void Start(const SourceRequest& request) override {
+        StartAsyncFetch(request.dataset, request.symbols, request.start_time, request.end_time,
+                        request.schema, request.stype_in);
+    }
+    void Stop() override { StopAsyncFetch(); }
+    bool IsRunning() const override { return IsFetching(); }
+    
     /**
      * Get access to the underlying queue for consumers
      */
-    LockFreeRingBuffer<MarketDataPoint, 1024 * 1024>& GetQueue() { return *data_queue_; }
+    DataQueue& GetQueue() override { return *data_queue_; }
     
     /**
      * Get performance metrics
      */
-    const PerformanceMetrics& GetMetrics() const { return metrics_; }
+    const PerformanceMetrics& GetMetrics() const override { return metrics_; }
     
     /**
      * Check if handler is currently fetching data
      */
     bool IsFetching() const { return is_fetching_.load(); }
     
+    /**
+     * Instrument ids of the current fetch, published from the symbology
+     * metadata before the first record. Consumers pre-size their
+     * InstrumentTables from it.
+     */
+    const InstrumentUniverse& GetInstruments() const override { return instruments_; }
+    
+    /**
+     * Split subsequent fetches into chunks fetched by parallel workers.
+     * Chunks finish out of order, so consumers restore timestamp order
+     * with a ReorderBuffer driven by GetWatermark(). Not allowed while
+     * fetching.
+     */
+    void SetFetchPlan(const FetchPlanOptions& plan);
+    
+    const FetchPlanOptions& GetFetchPlan() const { return fetch_plan_; }
+    
+    /**
+     * Progress of the chunk producers; inactive for unchunked fetches.
+     */
+    const FetchWatermark& GetWatermark() const { return watermark_; }
+    
+    /**
+     * Keep fetched ranges as DBN files under directory and replay them
+     * from there on later fetches of the same range. Empty disables the
+     * cache. Not allowed while fetching.
+     */
+    void SetCacheDirectory(const std::string& directory);
+    
+    /**
+     * Release records on their ts_recv schedule: 1 = real time, N = N times
+     * faster, 0 = as fast as the source delivers (default). Not allowed
+     * while fetching.
+     */
+    void SetReplaySpeed(double speed);
+    
+    /**
+     * Schedule of the current paced replay, for consumers measuring lag.
+     */
+    const ReplayPacer& GetReplayPacer() const { return pacer_; }
+    
+    /**
+     * Choose what happens when the queue is full (default: Drop).
+     * Block waits for the consumer up to max_stall (0 = as long as it takes),
+     * DropOldest needs a multi-consumer queue, SpillToDisk creates an
+     * anonymous spill file in spill_directory. Not allowed while fetching.
+     */
+    void SetOverflowPolicy(OverflowPolicy policy,
+                           const std::string& spill_directory = "/tmp",
+                           std::chrono::milliseconds max_stall = std::chrono::milliseconds(0));
+    
+    OverflowPolicy GetOverflowPolicy() const { return overflow_policy_; }
+    
+    /**
+     * Core and scheduling of the fetch thread and of the parallel fetch
+     * workers (in start order, missing = unplaced). Not allowed while
+     * fetching.
+     */
+    void SetThreadPlacement(const ThreadPlacement& fetch_thread,
+                            const std::vector<ThreadPlacement>& workers = {});
+    
+    std::vector<PlacementLog::Entry> GetThreadPlacements() const override { return placements_.entries(); }
+    
+    /**
+     * Attach a signal to notify after each publish, for consumers using
+     * BlockingWait. Leave unset (nullptr) for spinning consumers.
+     */
+    void SetConsumerSignal(QueueSignal* signal) override { consumer_signal_ = signal; }
+    
     /**
      * Set callback for error handling
      */
-    void SetErrorCallback(std::function<void(const std::string&)> callback) {
+    void SetErrorCallback(std::function<void(const std::string&)> callback) override {
         error_callback_ = callback;
     }
     
+    void SetLogger(AsyncLogger* logger) override;
+    
 private:
     /**
-     * Process BBO records and convert to MarketDataPoint
+     * Publish state owned by one producer thread: the plain fetch uses
+     * primary_, every chunk worker of a parallel fetch has its own.
+     */
+    struct Producer {
+        // Records decoded but not yet published (unused when
+        // config::ZERO_COPY_PUBLISH decodes straight into queue slots)
+        std::array<MarketDataPoint, config::PUBLISH_BATCH_SIZE> staging;
+        size_t staged_count = 0;
+        std::unique_ptr<SpillFile<MarketDataPoint>> spill;
+        int lane = -1;  // Watermark lane of the current chunk, -1 = none
+        ThreadMetrics* metrics = nullptr;  // This producer's counters in metrics_
+        LogChannel* log = nullptr;         // This producer's log channel, if a logger is set
+    };
+    
+    /**
+     * Run one TimeseriesGetRange into the queue through producer, then
+     * flush its staged and spilled records. Replays a cached range
+     * instead, and on a cache miss writes the range to the cache as it
+     * streams. Throws on API errors.
      */
-    void ProcessBBORecord(
+    void RunFetch(
+        databento::Historical& client,
+        const std::string& dataset,
+        const std::vector<std::string>& symbols,
+        const std::string& start_time,
+        const std::string& end_time,
+        databento::Schema schema,
+        databento::SType stype_in,
+        Producer& producer
+    );
+    
+    /**
+     * Feed a cached DBN file through producer: records are decoded in
+     * place from a read-only mapping. Throws on I/O errors.
+     */
+    void ReplayFile(const std::string& path, const std::string& dataset, Producer& producer);
+    
+    /**
+     * Plan the request and fetch the chunks with parallel workers.
+     * Returns false if any chunk failed (errors go to the callback).
+     */
+    bool RunChunkedFetch(
+        const std::string& dataset,
+        const std::vector<std::string>& symbols,
+        const std::string& start_time,
+        const std::string& end_time,
+        databento::Schema schema,
+        databento::SType stype_in
+    );
+    
+    /**
+     * Merge a chunk's symbology into the published InstrumentUniverse.
+     */
+    void PublishInstruments(const databento::TsSymbolMap& symbol_map);
+    
+    /**
+     * Decode a record into MarketDataPoint events and publish them
+     */
+    void ProcessRecord(
         const databento::Record& record,
         const databento::TsSymbolMap& symbol_map,
-        const std::string& dataset
+        const std::string& dataset,
+        Producer& producer
     );
     
     /**
-     * Convert Databento fixed-price to double
+     * Wait until a record is due under the replay schedule, publishing the
+     * records already staged first so they are not held back.
+     */
+    void Pace(Producer& producer, int64_t timestamp);
+    
+    /**
+     * Publish one event: fill(MarketDataPoint&) writes it into a claimed
+     * queue slot (zero-copy) or the staging batch.
+     */
+    template<typename Fill>
+    void Emit(Producer& producer, const Fill& fill);
+    
+    /**
+     * Publish staged records to the queue with bulk pushes.
      */
-    double ConvertPrice(int64_t fixed_price) const;
+    void FlushStaged(Producer& producer);
+    
+    /**
+     * Publish records, applying the overflow policy to the part that does
+     * not fit in the queue
+     */
+    void Publish(Producer& producer, const MarketDataPoint* items, size_t count);
+    
+    /**
+     * Overflow helpers: push what fits now, wait for room, or evict the
+     * oldest records. Each returns the number of records pushed.
+     */
+    size_t PushAvailable(const MarketDataPoint* items, size_t count);
+    size_t PushBlocking(const MarketDataPoint* items, size_t count);
+    size_t PushEvicting(const MarketDataPoint* items, size_t count);
+    
+    /**
+     * Move spilled records back into the queue. With block set, waits for
+     * room until the spill is empty or a stop is requested.
+     */
+    void DrainSpill(Producer& producer, bool block);
+    
+    /**
+     * After count records up to last_timestamp went into the queue: wake
+     * the consumer, advance the producer's watermark lane, record metrics
+     */
+    void OnPublished(Producer& producer, size_t count, int64_t last_timestamp, int64_t latency_ns);
+    
+    /**
+     * Metrics bookkeeping shared by the staged and zero-copy publish paths
+     */
+    void RecordPushLatency(Producer& producer, size_t count, int64_t latency_ns);
+    void RecordOverruns(Producer& producer, size_t dropped);
     
     /**
      * Async fetch worker thread function
@@ -124,16 +341,51 @@ private:
     );
     
     // Member variables
+    std::string api_key_;
     std::unique_ptr<databento::Historical> client_;
-    std::unique_ptr<LockFreeRingBuffer<MarketDataPoint, 1024 * 1024>> data_queue_;
+    std::unique_ptr<DataQueue> data_queue_;
     PerformanceMetrics metrics_;
     std::atomic<bool> is_fetching_{false};
+    std::atomic<bool> stop_requested_{false};
     std::unique_ptr<std::thread> fetch_thread_;
     std::function<void(const std::string&)> error_callback_;
+    QueueSignal* consumer_signal_ = nullptr;
+    InstrumentUniverse instruments_;
+    std::mutex instruments_mutex_;
+    std::vector<uint32_t> known_instruments_;  // Union over the chunks of a fetch
+    
+    // Local DBN cache, nullptr = always stream from the API
+    std::unique_ptr<DbnCache> cache_;
+    
+    // Timestamp-paced replay
+    ReplayPacer pacer_;
+    
+    // Parallel fetch
+    FetchPlanOptions fetch_plan_;
+    FetchWatermark watermark_{config::MAX_FETCH_CHUNKS};
     
-    // Constants
-    static constexpr int64_t PRICE_SCALE = 1000000000LL;  // 1e9 for fixed-point conversion
-    static constexpr int64_t UNDEF_PRICE = 9223372036854775807LL;  // INT64_MAX
+    // Overflow handling (fetch thread only while fetching)
+    OverflowPolicy overflow_policy_ = OverflowPolicy::Drop;
+    std::chrono::milliseconds max_stall_{0};
+    std::string spill_directory_;
+    
+    // Publish state of the plain (unchunked) fetch
+    Producer primary_;
+    
+    // Metrics blocks of the parallel fetch worker slots (fetch thread only)
+    std::vector<ThreadMetrics*> worker_metrics_;
+    
+    // Hot-path logging; worker channels are kept across fetches like their metrics
+    AsyncLogger* logger_ = nullptr;
+    std::vector<LogChannel*> worker_logs_;
+    
+    // Thread placement
+    ThreadPlacement fetch_placement_;
+    std::vector<ThreadPlacement> worker_placements_;
+    PlacementLog placements_;
 };
 
+// Handler used by the engine; queue policy is selected in Config.hpp
+using DatabentoHandler = BasicDatabentoHandler<EngineDataQueue>;
+
 } // namespace market_data
\ No newline at end of file
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace market_data {
+
+/**
+ * MappedFile - RAII read-only memory mapping of a whole file.
+ *
+ * Advised for sequential access and pre-faulted (MAP_POPULATE), so a
+ * replay streams straight out of the page cache without read() copies.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw_errno("Failed to open", path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw_errno("Failed to stat", path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ > 0) {
+            int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+            flags |= MAP_POPULATE;
+#endif
+            void* p = ::mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw_errno("Failed to mmap", path);
+            }
+            data_ = static_cast<const std::uint8_t*>(p);
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);  // The mapping keeps the file alive
+    }
+
+    ~MappedFile() {
+        if (data_) {
+            ::munmap(const_cast<std::uint8_t*>(data_), size_);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    [[noreturn]] static void throw_errno(const char* what, const std::string& path) {
+        std::ostringstream oss;
+        oss << what << " " << path << ": " << std::strerror(errno);
+        throw std::runtime_error(oss.str());
+    }
+
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+/**
+ * Layout of a DBN file prelude: "DBN", version byte, u32 LE metadata length.
+ */
+struct DbnPrelude {
+    static constexpr std::size_t SIZE = 8;
+
+    std::uint8_t version = 0;
+    std::size_t records_offset = 0;  // First record, after the metadata
+
+    /**
+     * Parse the prelude of an uncompressed DBN file. Returns false for
+     * anything else (e.g. a zstd-compressed download).
+     */
+    static bool parse(const std::uint8_t* data, std::size_t size, DbnPrelude& out) {
+        if (size < SIZE || std::memcmp(data, "DBN", 3) != 0) {
+            return false;
+        }
+        std::uint32_t metadata_length = static_cast<std::uint32_t>(data[4])
+            | static_cast<std::uint32_t>(data[5]) << 8
+            | static_cast<std::uint32_t>(data[6]) << 16
+            | static_cast<std::uint32_t>(data[7]) << 24;
+        if (SIZE + metadata_length > size) {
+            return false;
+        }
+        out.version = data[3];
+        out.records_offset = SIZE + metadata_length;
+        return true;
+    }
+};
+
+/**
+ * DbnCache - where fetched ranges are kept on disk.
+ *
+ * One DBN file per (dataset, schema, input symbology, symbols, start, end),
+ * laid out as <directory>/<dataset>/<schema>/<start>_<end>_<hash>.dbn where
+ * the hash covers the sorted symbols and stype. Files are uncompressed DBN
+ * so they can be replayed in place from an mmap. A fetch writes its records
+ * to a ".partial" file as they stream through and only renames it into
+ * place once the range is complete, so an interrupted fetch never leaves a
+ * truncated cache entry.
+ */
+class DbnCache {
+public:
+    explicit DbnCache(std::string directory) : directory_(std::move(directory)) {}
+
+    const std::string& directory() const { return directory_; }
+
+    std::string PathFor(const std::string& dataset,
+                        const std::string& schema,
+                        int stype_in,
+                        std::vector<std::string> symbols,
+                        const std::string& start_time,
+                        const std::string& end_time) const {
+        std::sort(symbols.begin(), symbols.end());
+        std::ostringstream key;
+        key << stype_in;
+        for (const auto& symbol : symbols) {
+            key << '|' << symbol;
+        }
+
+        std::ostringstream name;
+        name << sanitize(start_time) << '_' << sanitize(end_time) << '_' << std::hex << fnv1a(key.str())
+             << ".dbn";
+        return (std::filesystem::path(directory_) / sanitize(dataset) / sanitize(schema) / name.str()).string();
+    }
+
+    static bool Contains(const std::string& path) {
+        std::error_code ec;
+        return std::filesystem::is_regular_file(path, ec) && std::filesystem::file_size(path, ec) > 0;
+    }
+
+    /**
+     * Partial file location for a cache entry (creates the directories).
+     */
+    static std::string PreparePartial(const std::string& path) {
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+        return path + ".partial";
+    }
+
+    /**
+     * Move a finished partial file into place.
+     */
+    static void Commit(const std::string& partial, const std::string& path) {
+        std::filesystem::rename(partial, path);
+    }
+
+    static void Discard(const std::string& partial) {
+        std::error_code ec;
+        std::filesystem::remove(partial, ec);
+    }
+
+private:
+    // Keep names portable: no path separators or ':' from ISO timestamps
+    static std::string sanitize(const std::string& text) {
+        std::string out = text;
+        for (char& c : out) {
+            bool keep = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+                        || c == '.' || c == '-';
+            if (!keep) {
+                c = '_';
+            }
+        }
+        return out;
+    }
+
+    static std::uint64_t fnv1a(const std::string& text) {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    std::string directory_;
+};
+
+} // namespace market_data
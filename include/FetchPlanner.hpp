@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * How a historical request is split for a parallel fetch.
+ * The window is cut into time_slices equal slices and the symbols into
+ * symbol_groups round-robin groups; parallelism workers (each with its
+ * own connection) fetch the resulting chunks in time order.
+ */
+struct FetchPlanOptions {
+    size_t time_slices = 1;
+    size_t symbol_groups = 1;
+    size_t parallelism = 1;
+};
+
+/**
+ * One piece of a planned fetch: [start_ns, end_ns) for a group of symbols.
+ */
+struct FetchChunk {
+    size_t index = 0;
+    int64_t start_ns = 0;
+    int64_t end_ns = 0;
+    std::string start_time;   // ISO 8601, as sent to the API
+    std::string end_time;
+    std::vector<std::string> symbols;
+};
+
+namespace detail {
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const auto yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+inline void civil_from_days(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const auto doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+// span * index / count without overflowing for any int64 span
+inline int64_t slice_offset(int64_t span, size_t index, size_t count) {
+    auto i = static_cast<int64_t>(index);
+    auto n = static_cast<int64_t>(count);
+    return span / n * i + span % n * i / n;
+}
+
+} // namespace detail
+
+/**
+ * Parse a UTC ISO 8601 timestamp ("YYYY-MM-DD", "YYYY-MM-DDTHH:MM",
+ * "YYYY-MM-DDTHH:MM:SS[.fraction]", optional trailing 'Z') into
+ * nanoseconds since the UNIX epoch. Throws std::invalid_argument.
+ */
+inline int64_t parse_timestamp_ns(const std::string& text) {
+    int year = 0;
+    unsigned month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    int consumed = 0;
+    int fields = std::sscanf(text.c_str(), "%4d-%2u-%2u%n", &year, &month, &day, &consumed);
+    if (fields != 3 || month < 1 || month > 12 || day < 1 || day > 31) {
+        throw std::invalid_argument("Invalid timestamp: " + text);
+    }
+
+    size_t pos = static_cast<size_t>(consumed);
+    int64_t fraction_ns = 0;
+    if (pos < text.size() && (text[pos] == 'T' || text[pos] == ' ')) {
+        int time_consumed = 0;
+        if (std::sscanf(text.c_str() + pos + 1, "%2u:%2u%n", &hour, &minute, &time_consumed) != 2) {
+            throw std::invalid_argument("Invalid timestamp: " + text);
+        }
+        pos += 1 + static_cast<size_t>(time_consumed);
+        if (pos < text.size() && text[pos] == ':') {
+            int sec_consumed = 0;
+            if (std::sscanf(text.c_str() + pos + 1, "%2u%n", &second, &sec_consumed) != 1) {
+                throw std::invalid_argument("Invalid timestamp: " + text);
+            }
+            pos += 1 + static_cast<size_t>(sec_consumed);
+        }
+        if (pos < text.size() && text[pos] == '.') {
+            int64_t scale = 100000000;
+            for (++pos; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++pos) {
+                fraction_ns += (text[pos] - '0') * scale;
+                scale /= 10;
+            }
+        }
+        if (hour > 23 || minute > 59 || second > 60) {
+            throw std::invalid_argument("Invalid timestamp: " + text);
+        }
+    }
+    if (pos < text.size() && text[pos] == 'Z') {
+        ++pos;
+    }
+    if (pos != text.size()) {
+        throw std::invalid_argument("Invalid timestamp: " + text);
+    }
+
+    int64_t days = detail::days_from_civil(year, month, day);
+    int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second;
+    return seconds * 1000000000LL + fraction_ns;
+}
+
+/**
+ * Format nanoseconds since the UNIX epoch as "YYYY-MM-DDTHH:MM:SS[.nnnnnnnnn]Z".
+ */
+inline std::string format_timestamp_ns(int64_t ns) {
+    int64_t seconds = ns / 1000000000LL;
+    int64_t fraction = ns % 1000000000LL;
+    if (fraction < 0) {
+        fraction += 1000000000LL;
+        --seconds;
+    }
+    int64_t days = seconds / 86400;
+    int64_t rem = seconds % 86400;
+    if (rem < 0) {
+        rem += 86400;
+        --days;
+    }
+    int64_t year;
+    unsigned month, day;
+    detail::civil_from_days(days, year, month, day);
+
+    char buf[64];
+    if (fraction == 0) {
+        std::snprintf(buf, sizeof(buf), "%04lld-%02u-%02uT%02lld:%02lld:%02lldZ",
+                      static_cast<long long>(year), month, day,
+                      static_cast<long long>(rem / 3600), static_cast<long long>(rem / 60 % 60),
+                      static_cast<long long>(rem % 60));
+    } else {
+        std::snprintf(buf, sizeof(buf), "%04lld-%02u-%02uT%02lld:%02lld:%02lld.%09lldZ",
+                      static_cast<long long>(year), month, day,
+                      static_cast<long long>(rem / 3600), static_cast<long long>(rem / 60 % 60),
+                      static_cast<long long>(rem % 60), static_cast<long long>(fraction));
+    }
+    return buf;
+}
+
+/**
+ * Split [start_time, end_time) x symbols into chunks, time-major: all
+ * symbol groups of slice 0, then slice 1, ... Workers take chunks in this
+ * order, so the chunks in flight always cover the oldest remaining data
+ * and the downstream reorder buffer only holds about parallelism chunks.
+ */
+inline std::vector<FetchChunk> plan_fetch(const std::vector<std::string>& symbols,
+                                          const std::string& start_time,
+                                          const std::string& end_time,
+                                          const FetchPlanOptions& options) {
+    int64_t start_ns = parse_timestamp_ns(start_time);
+    int64_t end_ns = parse_timestamp_ns(end_time);
+    if (end_ns <= start_ns) {
+        std::ostringstream oss;
+        oss << "Fetch window is empty: " << start_time << " - " << end_time;
+        throw std::invalid_argument(oss.str());
+    }
+
+    size_t slices = options.time_slices == 0 ? 1 : options.time_slices;
+    if (static_cast<uint64_t>(end_ns - start_ns) < slices) {
+        slices = static_cast<size_t>(end_ns - start_ns);
+    }
+    size_t groups = options.symbol_groups == 0 ? 1 : options.symbol_groups;
+    if (groups > symbols.size() && !symbols.empty()) {
+        groups = symbols.size();
+    }
+
+    std::vector<std::vector<std::string>> symbol_groups(groups);
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        symbol_groups[i % groups].push_back(symbols[i]);
+    }
+
+    std::vector<FetchChunk> chunks;
+    chunks.reserve(slices * groups);
+    int64_t span = end_ns - start_ns;
+    for (size_t s = 0; s < slices; ++s) {
+        // Slices are contiguous and end-exclusive, so no record is fetched twice
+        int64_t slice_start = start_ns + detail::slice_offset(span, s, slices);
+        int64_t slice_end = start_ns + detail::slice_offset(span, s + 1, slices);
+        for (size_t g = 0; g < groups; ++g) {
+            FetchChunk chunk;
+            chunk.index = chunks.size();
+            chunk.start_ns = slice_start;
+            chunk.end_ns = slice_end;
+            chunk.start_time = s == 0 ? start_time : format_timestamp_ns(slice_start);
+            chunk.end_time = s + 1 == slices ? end_time : format_timestamp_ns(slice_end);
+            chunk.symbols = symbol_groups[g];
+            chunks.push_back(std::move(chunk));
+        }
+    }
+    return chunks;
+}
+
+} // namespace market_data
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace market_data {
+
+/**
+ * Placement options for large, long-lived buffers (ring buffer slot arrays).
+ */
+struct MemoryOptions {
+    bool use_huge_pages = true;   // Try explicit 2 MiB pages, then transparent huge pages
+    int numa_node = -1;           // Preferred NUMA node, -1 = leave placement to the kernel
+    std::string shared_name;      // Named POSIX shared memory (SharedRingBuffer only), "" = private
+};
+
+/**
+ * How a HugePageRegion ended up being backed.
+ */
+enum class PageBacking {
+    HugeTlb,          // Explicit MAP_HUGETLB 2 MiB pages (needs vm.nr_hugepages)
+    TransparentHuge,  // Regular mapping with MADV_HUGEPAGE hint
+    Regular,          // Plain 4 KiB pages
+};
+
+inline const char* to_string(PageBacking backing) {
+    switch (backing) {
+        case PageBacking::HugeTlb:         return "hugetlb";
+        case PageBacking::TransparentHuge: return "thp";
+        case PageBacking::Regular:         return "regular";
+    }
+    return "unknown";
+}
+
+#if defined(__linux__)
+/**
+ * Prefer NUMA node for a not yet touched range (MPOL_PREFERRED).
+ */
+inline bool bind_memory_to_node(void* data, std::size_t size, int node) {
+    // Raw syscall instead of libnuma so the build has no extra dependency
+    constexpr int MPOL_PREFERRED_MODE = 1;
+    constexpr int MAX_NODES = 64;
+    if (node < 0 || node >= MAX_NODES) {
+        return false;
+    }
+    unsigned long nodemask = 1UL << node;
+    return ::syscall(SYS_mbind, data, size, MPOL_PREFERRED_MODE,
+                     &nodemask, MAX_NODES + 1, 0) == 0;
+}
+#endif
+
+/**
+ * HugePageRegion - RAII owner of an anonymous memory mapping.
+ *
+ * The size is rounded up to a whole number of 2 MiB pages. Allocation tries
+ * MAP_HUGETLB first and falls back to a regular mapping advised with
+ * MADV_HUGEPAGE, so it works on hosts without a reserved hugepage pool.
+ * When a NUMA node is requested the range is bound (MPOL_PREFERRED) before
+ * any page is touched, so the first write faults it in on that node.
+ *
+ * Memory is returned zero-filled and page aligned.
+ */
+class HugePageRegion {
+public:
+    static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    HugePageRegion() = default;
+
+    HugePageRegion(std::size_t bytes, const MemoryOptions& options) {
+        if (bytes == 0) {
+            return;
+        }
+        size_ = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+#if defined(__linux__)
+        if (options.use_huge_pages) {
+            data_ = map(MAP_HUGETLB);
+            if (data_) {
+                backing_ = PageBacking::HugeTlb;
+            }
+        }
+        if (!data_) {
+            data_ = map(0);
+            if (!data_) {
+                std::ostringstream oss;
+                oss << "Failed to map " << size_ << " bytes for buffer storage";
+                throw std::runtime_error(oss.str());
+            }
+            backing_ = PageBacking::Regular;
+#if defined(MADV_HUGEPAGE)
+            if (options.use_huge_pages && ::madvise(data_, size_, MADV_HUGEPAGE) == 0) {
+                backing_ = PageBacking::TransparentHuge;
+            }
+#endif
+        }
+        if (options.numa_node >= 0) {
+            numa_bound_ = bind_to_node(options.numa_node);
+        }
+#else
+        (void)options;
+        data_ = ::operator new(size_, std::align_val_t{HUGE_PAGE_SIZE});
+        std::memset(data_, 0, size_);
+        backing_ = PageBacking::Regular;
+#endif
+    }
+
+    ~HugePageRegion() { release(); }
+
+    HugePageRegion(const HugePageRegion&) = delete;
+    HugePageRegion& operator=(const HugePageRegion&) = delete;
+
+    HugePageRegion(HugePageRegion&& other) noexcept { *this = std::move(other); }
+
+    HugePageRegion& operator=(HugePageRegion&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            backing_ = other.backing_;
+            numa_bound_ = other.numa_bound_;
+        }
+        return *this;
+    }
+
+    void* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    PageBacking backing() const { return backing_; }
+    bool numa_bound() const { return numa_bound_; }
+
+private:
+#if defined(__linux__)
+    void* map(int extra_flags) const {
+        void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    bool bind_to_node(int node) const {
+        return bind_memory_to_node(data_, size_, node);
+    }
+#endif
+
+    void release() {
+        if (!data_) {
+            return;
+        }
+#if defined(__linux__)
+        ::munmap(data_, size_);
+#else
+        ::operator delete(data_, std::align_val_t{HUGE_PAGE_SIZE});
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+    PageBacking backing_ = PageBacking::Regular;
+    bool numa_bound_ = false;
+};
+
+} // namespace market_data
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * InstrumentUniverse - the instrument_ids a fetch is expected to produce.
+ *
+ * The handler publishes it from the TsSymbolMap as soon as the metadata
+ * arrives (before any record is pushed), and consumers pick it up to
+ * pre-size their InstrumentTables. Publishing is rare and cold; readers
+ * only compare version() on a table miss.
+ */
+class InstrumentUniverse {
+public:
+    void Publish(std::vector<uint32_t> ids) {
+        auto published = std::make_shared<const std::vector<uint32_t>>(std::move(ids));
+        std::atomic_store_explicit(&ids_, published, std::memory_order_release);
+        version_.fetch_add(1, std::memory_order_release);
+    }
+
+    std::shared_ptr<const std::vector<uint32_t>> Ids() const {
+        return std::atomic_load_explicit(&ids_, std::memory_order_acquire);
+    }
+
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+private:
+    std::shared_ptr<const std::vector<uint32_t>> ids_;
+    std::atomic<uint64_t> version_{0};
+};
+
+/**
+ * InstrumentTable - dense per-instrument state with O(1) un-hashed lookup.
+ *
+ * instrument_id -> compact slot goes through a two-level radix index
+ * (4096 ids per page, pages allocated only where ids exist), and slots
+ * index a contiguous, pre-sized array of cache-line-aligned entries.
+ * Known instruments are preloaded from an InstrumentUniverse, so the hot
+ * path is two dependent loads and never allocates. An unseen id takes the
+ * cold path: re-sync with the universe, then claim the next free slot.
+ *
+ * A table can be restricted to one partition (id % partitions == index)
+ * so sharded consumers only preload the instruments they own.
+ *
+ * Single-threaded: each consumer owns its table.
+ */
+template<typename Payload>
+class InstrumentTable {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    struct alignas(64) Entry {
+        int32_t instrument_id = 0;
+        Payload value{};
+    };
+
+    explicit InstrumentTable(size_t capacity, const InstrumentUniverse* universe = nullptr)
+        : universe_(universe) {
+        entries_.resize(capacity);
+    }
+
+    /**
+     * Only keep instruments with id % partitions == index.
+     */
+    void set_partition(uint32_t index, uint32_t partitions) {
+        partition_index_ = index;
+        partitions_ = partitions == 0 ? 1 : partitions;
+    }
+
+    /**
+     * Slot of an instrument, or NOT_FOUND.
+     */
+    uint32_t find(int32_t instrument_id) const {
+        auto id = static_cast<uint32_t>(instrument_id);
+        uint32_t page = id >> PAGE_BITS;
+        if (page >= pages_.size() || !pages_[page]) {
+            return NOT_FOUND;
+        }
+        return pages_[page][id & PAGE_MASK];
+    }
+
+    /**
+     * Hot path: state for an instrument, adding it on first sight.
+     * Returns nullptr only when the table is full.
+     */
+    Payload* find_or_add(int32_t instrument_id) {
+        uint32_t slot = find(instrument_id);
+        if (slot != NOT_FOUND) {
+            return &entries_[slot].value;
+        }
+        return add_slow(instrument_id);
+    }
+
+    /**
+     * Lookup without inserting, nullptr if unknown.
+     */
+    const Payload* get(int32_t instrument_id) const {
+        uint32_t slot = find(instrument_id);
+        return slot == NOT_FOUND ? nullptr : &entries_[slot].value;
+    }
+
+    /**
+     * Slot of a payload returned by find_or_add() or get().
+     */
+    uint32_t slot_of(const Payload* value) const {
+        auto offset = reinterpret_cast<const char*>(value) - reinterpret_cast<const char*>(&entries_.front().value);
+        return static_cast<uint32_t>(static_cast<size_t>(offset) / sizeof(Entry));
+    }
+
+    /**
+     * Assign slots for every id in the list (cold path).
+     */
+    void preload(const std::vector<uint32_t>& ids) {
+        for (uint32_t id : ids) {
+            if (id % partitions_ == partition_index_ && find(static_cast<int32_t>(id)) == NOT_FOUND) {
+                insert(static_cast<int32_t>(id));
+            }
+        }
+    }
+
+    /**
+     * Preload newly published instruments, if the universe changed.
+     */
+    void sync() {
+        if (!universe_) {
+            return;
+        }
+        uint64_t version = universe_->version();
+        if (version != synced_version_) {
+            if (auto ids = universe_->Ids()) {
+                preload(*ids);
+            }
+            synced_version_ = version;
+        }
+    }
+
+    /**
+     * Visit every used slot in slot order: f(instrument_id, payload).
+     */
+    template<typename F>
+    void for_each(F&& f) const {
+        for (size_t i = 0; i < size_; ++i) {
+            f(entries_[i].instrument_id, entries_[i].value);
+        }
+    }
+
+    template<typename F>
+    void for_each(F&& f) {
+        for (size_t i = 0; i < size_; ++i) {
+            f(entries_[i].instrument_id, entries_[i].value);
+        }
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return entries_.size(); }
+
+    /**
+     * Records dropped because the table was full.
+     */
+    uint64_t overflow_count() const { return overflows_; }
+
+private:
+    static constexpr uint32_t PAGE_BITS = 12;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+    static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+
+    __attribute__((noinline)) Payload* add_slow(int32_t instrument_id) {
+        sync();
+        uint32_t slot = find(instrument_id);
+        if (slot == NOT_FOUND) {
+            slot = insert(instrument_id);
+        }
+        if (slot == NOT_FOUND) {
+            ++overflows_;
+            return nullptr;
+        }
+        return &entries_[slot].value;
+    }
+
+    uint32_t insert(int32_t instrument_id) {
+        if (size_ == entries_.size()) {
+            return NOT_FOUND;
+        }
+        auto id = static_cast<uint32_t>(instrument_id);
+        uint32_t page = id >> PAGE_BITS;
+        if (page >= pages_.size()) {
+            pages_.resize(page + 1);
+        }
+        if (!pages_[page]) {
+            pages_[page] = std::make_unique<uint32_t[]>(PAGE_SIZE);
+            for (uint32_t i = 0; i < PAGE_SIZE; ++i) {
+                pages_[page][i] = NOT_FOUND;
+            }
+        }
+        auto slot = static_cast<uint32_t>(size_++);
+        entries_[slot].instrument_id = instrument_id;
+        pages_[page][id & PAGE_MASK] = slot;
+        return slot;
+    }
+
+    std::vector<Entry> entries_;
+    size_t size_ = 0;
+    std::vector<std::unique_ptr<uint32_t[]>> pages_;
+    const InstrumentUniverse* universe_;
+    uint64_t synced_version_ = 0;
+    uint32_t partition_index_ = 0;
+    uint32_t partitions_ = 1;
+    uint64_t overflows_ = 0;
+};
+
+} // namespace market_data
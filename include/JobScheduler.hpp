@@ -0,0 +1,220 @@
+#pragma once
+
+#include "MarketDataSource.hpp"
+#include "RuntimeConfig.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * Outcome of one scheduled job.
+ */
+struct JobResult {
+    enum class Status : uint8_t {
+        Completed,    // The source finished the range
+        Failed,       // The source reported an error during the job
+        TimedOut,     // Stopped after the job timeout
+        Interrupted,  // Stopped because the run was cancelled
+    };
+
+    std::string name;
+    size_t worker = 0;
+    Status status = Status::Completed;
+    uint64_t records = 0;     // Published by the source
+    uint64_t overruns = 0;
+    double seconds = 0.0;
+};
+
+inline const char* to_string(JobResult::Status status) {
+    switch (status) {
+        case JobResult::Status::Completed:   return "completed";
+        case JobResult::Status::Failed:      return "failed";
+        case JobResult::Status::TimedOut:    return "timed out";
+        case JobResult::Status::Interrupted: return "interrupted";
+    }
+    return "unknown";
+}
+
+/**
+ * JobScheduler - runs a list of fetch jobs over a fixed pool of sources.
+ *
+ * Each worker is a long-lived MarketDataSource (in the engine one
+ * DatabentoHandler with its own client connection, DBN cache and
+ * pre-faulted queue, drained by its own consumers). Jobs start in list
+ * order on the first idle worker; a worker is idle once its previous job
+ * has finished and its consumers have processed every record it
+ * published (an empty queue is not enough: a consumer may still be
+ * working through a popped batch or holding records for reordering). So
+ * per-job metrics never mix two jobs, and the next fetch's metrics reset
+ * never races a consumer. Jobs running past the timeout are stopped.
+ *
+ * Run() is driven from the calling thread and polls the workers; the
+ * sources do the fetching on their own threads.
+ *
+ * Template parameters:
+ * - QueueT: queue type of the sources
+ */
+template<typename QueueT>
+class JobScheduler {
+public:
+    using Source = MarketDataSource<QueueT>;
+
+    struct Options {
+        std::chrono::seconds job_timeout{0};           // 0 = no limit
+        std::chrono::milliseconds poll_interval{10};
+        std::chrono::milliseconds tick_interval{1000};
+        std::function<void(const FetchJob&, size_t worker)> on_start;
+        std::function<void(const JobResult&)> on_finish;
+        std::function<void(const std::string&)> on_error;  // Source errors, from the fetch threads
+        // Per worker: the queue is drained by another process (shared-memory
+        // queue), whose consumer counters are not visible here, so only an
+        // empty queue is waited for. Missing = local consumers
+        std::vector<bool> remote_consumers;
+    };
+
+    /**
+     * Takes over the error callback of every worker (forwarded to
+     * options.on_error). The sources must outlive the scheduler.
+     */
+    JobScheduler(const std::vector<Source*>& workers, Options options)
+        : options_(std::move(options)) {
+        if (workers.empty()) {
+            throw std::invalid_argument("JobScheduler needs at least one worker");
+        }
+        for (Source* source : workers) {
+            auto worker = std::make_unique<Worker>();
+            worker->source = source;
+            Worker* raw = worker.get();
+            source->SetErrorCallback([this, raw](const std::string& error) {
+                raw->failed.store(true, std::memory_order_relaxed);
+                if (options_.on_error) {
+                    options_.on_error(error);
+                }
+            });
+            workers_.push_back(std::move(worker));
+        }
+    }
+
+    ~JobScheduler() {
+        for (auto& worker : workers_) {
+            worker->source->SetErrorCallback({});
+        }
+    }
+
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    /**
+     * Run every job, calling tick every tick_interval, until all have
+     * finished or keep_going() turns false (running jobs are then stopped
+     * and reported as interrupted, the rest are not started). Returns the
+     * results in finishing order.
+     */
+    template<typename KeepGoing, typename Tick>
+    std::vector<JobResult> Run(const std::vector<FetchJob>& jobs, KeepGoing&& keep_going, Tick&& tick) {
+        std::vector<JobResult> results;
+        size_t next = 0;
+        auto last_tick = std::chrono::steady_clock::now();
+        while (true) {
+            bool cancelled = !keep_going();
+            auto now = std::chrono::steady_clock::now();
+            size_t active = 0;
+            for (size_t w = 0; w < workers_.size(); ++w) {
+                Worker& worker = *workers_[w];
+                if (worker.job) {
+                    if (cancelled) {
+                        worker.source->Stop();
+                        results.push_back(Finish(w, JobResult::Status::Interrupted, now));
+                    } else if (!worker.source->IsRunning()) {
+                        results.push_back(Finish(w, worker.failed.load() ? JobResult::Status::Failed
+                                                                          : JobResult::Status::Completed, now));
+                    } else if (options_.job_timeout.count() > 0 && now - worker.started > options_.job_timeout) {
+                        worker.source->Stop();
+                        results.push_back(Finish(w, JobResult::Status::TimedOut, now));
+                    }
+                }
+                if (!worker.job && !cancelled && next < jobs.size() && Idle(w)) {
+                    Begin(w, jobs[next++], now);
+                }
+                active += worker.job ? 1 : 0;
+            }
+            if (active == 0 && (cancelled || next == jobs.size())) {
+                break;
+            }
+            if (now - last_tick >= options_.tick_interval) {
+                tick();
+                last_tick = now;
+            }
+            std::this_thread::sleep_for(options_.poll_interval);
+        }
+        return results;
+    }
+
+    size_t workers() const { return workers_.size(); }
+
+private:
+    struct Worker {
+        Source* source = nullptr;
+        const FetchJob* job = nullptr;             // Running job, nullptr = none
+        std::chrono::steady_clock::time_point started;
+        std::atomic<bool> failed{false};
+    };
+
+    // The producers have stopped, so messages_received (records that
+    // reached the queue, see ThreadMetrics) is final. Consumers count
+    // records once processed; evicted ones were taken back by the producer
+    bool Idle(size_t w) const {
+        const Worker& worker = *workers_[w];
+        if (!worker.source->GetQueue().empty()) {
+            return false;
+        }
+        if (w < options_.remote_consumers.size() && options_.remote_consumers[w]) {
+            return true;
+        }
+        const PerformanceMetrics& metrics = worker.source->GetMetrics();
+        uint64_t received = metrics.messages_received();
+        return metrics.messages_processed() + metrics.records_evicted.load() >= received;
+    }
+
+    void Begin(size_t w, const FetchJob& job, std::chrono::steady_clock::time_point now) {
+        Worker& worker = *workers_[w];
+        worker.job = &job;
+        worker.started = now;
+        worker.failed.store(false);
+        if (options_.on_start) {
+            options_.on_start(job, w);
+        }
+        worker.source->Start(job.request);
+    }
+
+    JobResult Finish(size_t w, JobResult::Status status, std::chrono::steady_clock::time_point now) {
+        Worker& worker = *workers_[w];
+        const PerformanceMetrics& metrics = worker.source->GetMetrics();
+        JobResult result;
+        result.name = worker.job->name;
+        result.worker = w;
+        result.status = status;
+        result.records = metrics.messages_received();
+        result.overruns = metrics.buffer_overruns();
+        result.seconds = std::chrono::duration<double>(now - worker.started).count();
+        worker.job = nullptr;
+        if (options_.on_finish) {
+            options_.on_finish(result);
+        }
+        return result;
+    }
+
+    Options options_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+} // namespace market_data
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Config.hpp"
+#include "MarketDataSource.hpp"
+#include "RecordDecoder.hpp"
+#include "ThreadAffinity.hpp"
+#include "Types.hpp"
+#include "WaitStrategy.hpp"
+#include <databento/dbn.hpp>
+#include <databento/live.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * BasicLiveHandler - real-time feed from the Databento live gateway.
+ *
+ * Subscribes through databento::LiveThreaded and decodes BBO, trades and
+ * MBP-1 / MBP-10 records in the client's receive callback straight into the same queue
+ * type the historical handler uses, so consumers cannot tell the sources
+ * apart. Each record is pushed as soon as it is decoded (no staging: a
+ * live feed must not hold data back), and a full queue drops and counts
+ * an overrun rather than stalling the socket.
+ *
+ * Instrument ids are published to GetInstruments() as the gateway sends
+ * its symbol mappings. The receive thread can be pinned to a core, and the
+ * ts_recv -> enqueue latency of every record goes into a histogram in the
+ * metrics.
+ *
+ * Template parameters:
+ * - QueueT: Queue shared with consumers, explicitly instantiated in
+ *   LiveHandler.cpp for the same queue types as the historical handler.
+ *   The receive thread is the only producer, so SpscRingBuffer works.
+ */
+template<typename QueueT>
+class BasicLiveHandler : public MarketDataSource<QueueT> {
+public:
+    using DataQueue = QueueT;
+
+    // queue_size must be a power of 2
+    explicit BasicLiveHandler(const std::string& api_key,
+                              size_t queue_size = 1024 * 1024,
+                              const MemoryOptions& queue_memory = {});
+
+    ~BasicLiveHandler() override;
+
+    BasicLiveHandler(const BasicLiveHandler&) = delete;
+    BasicLiveHandler& operator=(const BasicLiveHandler&) = delete;
+
+    /**
+     * Initialize the handler with API key from environment
+     */
+    static std::unique_ptr<BasicLiveHandler> CreateFromEnv(size_t queue_size = 1024 * 1024,
+                                                           const MemoryOptions& queue_memory = {});
+
+    /**
+     * Subscribe to request.symbols on request.dataset and start the
+     * session. Supported schemas: "bbo-1s", "bbo-1m", "trades", "mbp-1",
+     * "mbp-10". The time range is ignored.
+     */
+    void Start(const SourceRequest& request) override;
+
+    /**
+     * End the session and join the receive thread.
+     */
+    void Stop() override;
+
+    bool IsRunning() const override { return is_running_.load(); }
+
+    DataQueue& GetQueue() override { return *data_queue_; }
+    const PerformanceMetrics& GetMetrics() const override { return metrics_; }
+    const InstrumentUniverse& GetInstruments() const override { return instruments_; }
+    void SetConsumerSignal(QueueSignal* signal) override { consumer_signal_ = signal; }
+
+    void SetErrorCallback(std::function<void(const std::string&)> callback) override {
+        error_callback_ = callback;
+    }
+
+    void SetLogger(AsyncLogger* logger) override {
+        receive_log_ = logger ? &logger->register_thread("live receive") : nullptr;
+    }
+
+    /**
+     * Core and scheduling of the client's receive thread (core -1 =
+     * unpinned). Takes effect on the next Start().
+     */
+    void SetReceivePlacement(const ThreadPlacement& placement) { receive_placement_ = placement; }
+
+    bool ReceiveThreadPinned() const { return receive_pinned_.load(); }
+
+    std::vector<PlacementLog::Entry> GetThreadPlacements() const override { return placements_.entries(); }
+
+private:
+    /**
+     * Receive-thread callback: decode and enqueue one record.
+     */
+    databento::KeepGoing OnRecord(const databento::Record& record);
+
+    /**
+     * Session errors: report, then let the client reconnect unless stopping.
+     */
+    databento::ExceptionAction OnException(const std::exception& e);
+
+    void Publish(const MarketDataPoint& data_point);
+    void AddInstrument(uint32_t instrument_id);
+    void ReportError(const std::string& message);
+
+    std::string api_key_;
+    std::unique_ptr<DataQueue> data_queue_;
+    std::unique_ptr<databento::LiveThreaded> client_;
+    PerformanceMetrics metrics_;
+    ThreadMetrics& receive_metrics_;        // Written by the receive thread only
+    InstrumentUniverse instruments_;
+    std::atomic<bool> is_running_{false};
+    std::atomic<bool> stop_requested_{false};
+    std::function<void(const std::string&)> error_callback_;
+    QueueSignal* consumer_signal_ = nullptr;
+    LogChannel* receive_log_ = nullptr;     // Receive thread's log channel, if set
+    std::mutex session_mutex_;   // Start/Stop
+
+    ThreadPlacement receive_placement_;
+    bool pin_pending_ = false;              // Receive thread only
+    std::vector<uint32_t> mapped_ids_;      // Receive thread only, sorted
+    std::atomic<bool> receive_pinned_{false};
+    PlacementLog placements_;
+};
+
+// Live handler used by the engine, same queue as DatabentoHandler
+using LiveHandler = BasicLiveHandler<EngineDataQueue>;
+
+} // namespace market_data
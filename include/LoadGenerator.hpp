@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * Shape of a synthetic feed.
+ */
+struct LoadProfile {
+    size_t instruments = 64;
+    size_t hot_instruments = 8;       // The first ids, which get hot_share of the events
+    double hot_share = 0.8;
+    double trade_share = 0.1;         // Events that are trade prints
+    double book_level_share = 0.6;    // MBP-10 level updates; the rest are quotes
+    size_t burst_size = 256;          // Events per burst
+    int64_t event_spacing_ns = 1000;  // ts_recv step between events of a burst
+    int64_t burst_gap_ns = 1000000;   // ts_recv step between bursts
+    uint64_t seed = 1;
+};
+
+/**
+ * LoadGenerator - synthetic MarketDataPoint stream for benchmarks and load
+ * tests, no API key or network needed.
+ *
+ * Events arrive in bursts of profile.burst_size, a hot set of instruments
+ * takes most of the flow, and every instrument's prices follow its own
+ * random walk around 100.00 with a one-to-four tick spread, so book,
+ * VWAP and rolling-window code see realistic values. ts_recv advances in
+ * event time (event_spacing_ns inside a burst, burst_gap_ns between
+ * bursts); pacing in wall time is up to the caller. Deterministic for a
+ * given seed.
+ */
+class LoadGenerator {
+public:
+    explicit LoadGenerator(const LoadProfile& profile = {})
+        : profile_(profile), state_(profile.seed | 1), mid_ticks_(profile.instruments, 10000) {
+        if (profile_.instruments == 0 || profile_.burst_size == 0) {
+            throw std::invalid_argument("LoadGenerator needs instruments and a burst size");
+        }
+        profile_.hot_instruments = std::min(std::max<size_t>(profile_.hot_instruments, 1), profile_.instruments);
+    }
+
+    const LoadProfile& profile() const { return profile_; }
+
+    /**
+     * Fill out[0, count) with the next events. Bursts continue across
+     * calls, so any count works.
+     */
+    void fill(MarketDataPoint* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            next(out[i]);
+        }
+    }
+
+    /**
+     * The rest of the current burst, or the next whole one, into out (at
+     * least profile().burst_size entries). Returns the number of events.
+     */
+    size_t next_burst(MarketDataPoint* out) {
+        size_t count = in_burst_ == profile_.burst_size ? profile_.burst_size : profile_.burst_size - in_burst_;
+        fill(out, count);
+        return count;
+    }
+
+    void next(MarketDataPoint& dp) {
+        if (in_burst_ == profile_.burst_size) {
+            in_burst_ = 0;
+            ts_ += profile_.burst_gap_ns;
+        } else if (in_burst_ > 0 || ts_ > 0) {
+            ts_ += profile_.event_spacing_ns;
+        }
+        in_burst_++;
+
+        size_t id = pick_instrument();
+        int64_t& mid = mid_ticks_[id];
+        mid = std::max<int64_t>(1000, mid + static_cast<int64_t>(uniform(3)) - 1);  // -1, 0 or +1 tick
+        int64_t half_spread = 1 + static_cast<int64_t>(uniform(2));
+
+        dp = MarketDataPoint();
+        dp.timestamp_delta = ts_;
+        dp.instrument_id = static_cast<int32_t>(id + 1);
+        double kind = unit();
+        if (kind < profile_.trade_share) {
+            bool buy = uniform(2) == 0;
+            dp.type = EventType::Trade;
+            dp.bid_px = price(buy ? mid + half_spread : mid - half_spread);
+            dp.bid_sz = 1 + static_cast<uint32_t>(uniform(20));
+            dp.side = buy ? 'B' : 'A';
+        } else {
+            uint8_t level = 0;
+            dp.type = EventType::Quote;
+            if (kind < profile_.trade_share + profile_.book_level_share) {
+                level = static_cast<uint8_t>(uniform(OrderBook::DEPTH));
+                dp.type = EventType::BookLevel;
+                dp.side = uniform(2) == 0 ? 'B' : 'A';
+            }
+            dp.level = level;
+            dp.bid_px = price(mid - half_spread - level);
+            dp.ask_px = price(mid + half_spread + level);
+            dp.bid_sz = 1 + static_cast<uint32_t>(uniform(500));
+            dp.ask_sz = 1 + static_cast<uint32_t>(uniform(500));
+        }
+    }
+
+private:
+    // One tick = 0.01
+    static Price price(int64_t ticks) {
+        if constexpr (config::FIXED_POINT_PRICES) {
+            return ticks * (PRICE_SCALE / 100);
+        } else {
+            return static_cast<double>(ticks) / 100.0;
+        }
+    }
+
+    size_t pick_instrument() {
+        if (unit() < profile_.hot_share || profile_.hot_instruments == profile_.instruments) {
+            return static_cast<size_t>(uniform(profile_.hot_instruments));
+        }
+        return profile_.hot_instruments +
+               static_cast<size_t>(uniform(profile_.instruments - profile_.hot_instruments));
+    }
+
+    // xorshift64*: cheap enough not to dominate what is being measured
+    uint64_t random() {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 2685821657736338717ULL;
+    }
+
+    uint64_t uniform(uint64_t bound) { return random() % bound; }
+
+    double unit() { return static_cast<double>(random() >> 11) * (1.0 / 9007199254740992.0); }
+
+    LoadProfile profile_;
+    uint64_t state_;
+    std::vector<int64_t> mid_ticks_;  // Per instrument, in ticks
+    int64_t ts_ = 0;
+    size_t in_burst_ = 0;
+};
+
+} // namespace market_data
@@ -1,13 +1,32 @@
 #pragma once
 
 #include "Types.hpp"
+#include "HugePageMemory.hpp"
 #include <atomic>
-#include <array>
 #include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
 #include <thread>
 
 namespace market_data {
 
+/**
+ * Slot storage layout for LockFreeRingBuffer.
+ *
+ * - Padded: one 64-byte cache line per slot holding sequence + payload.
+ *   Neighbouring slots never share a line, at the cost of padding
+ *   (8 wasted bytes per 48-byte MarketDataPoint).
+ * - Dense: sequence numbers and payloads in two separate packed arrays.
+ *   A sequential consumer streams sizeof(T) + 8 bytes per record, but
+ *   producer and consumer can touch the same line when the queue is
+ *   nearly empty, so prefer it for bursty / backlogged workloads.
+ */
+enum class SlotLayout {
+    Padded,
+    Dense,
+};
+
 /**
  * Multi-Producer Multi-Consumer Lock-Free Queue
  * 
@@ -15,35 +34,162 @@ namespace market_data {
  * 
  * Template parameters:
  * - T: Type of elements to store (MarketDataPoint in our case)
- * - N: Buffer size (must be power of 2 for efficient modulo with bitwise AND)
+ * - Layout: Slot storage layout (see SlotLayout)
+ *
+ * The buffer size is chosen at construction (must be power of 2 for efficient
+ * modulo with bitwise AND). Slots live in a HugePageRegion rather than inline,
+ * so large queues are backed by 2 MiB pages and can be placed on a NUMA node.
+ * All slots are initialised in the constructor, which also pre-faults the
+ * whole mapping up front instead of on the hot path.
  */
-template<typename T, size_t N>
+template<typename T, SlotLayout Layout = SlotLayout::Padded>
 class LockFreeRingBuffer {
-    static_assert((N & (N - 1)) == 0, "Buffer size must be power of 2");
-    static_assert(N >= 2, "Buffer size must be at least 2");
-    
 private:
-    // Each slot contains data + sequence number for MPMC coordination
+    using Sequence = std::atomic<std::size_t>;
+    
+    // Padded layout: each slot contains data + sequence number for MPMC coordination
     struct alignas(64) Slot {  // Cache line aligned to prevent false sharing
-        std::atomic<std::size_t> sequence{0};
+        Sequence sequence{0};
         T data{};
     };
     
+    static constexpr bool DENSE = Layout == SlotLayout::Dense;
+    static constexpr std::size_t CACHE_LINE = 64;
+    
+    std::size_t size_;          // Number of slots (power of 2)
+    std::size_t mask_;          // For efficient modulo operation
+    HugePageRegion storage_;    // Backing memory for the slot array(s)
+    Slot* buffer_ = nullptr;    // Padded layout
+    Sequence* sequences_ = nullptr;  // Dense layout: packed sequence numbers
+    T* payloads_ = nullptr;          // Dense layout: packed payloads
+    
     // Cache line separation to prevent false sharing between producer/consumer positions
-    alignas(64) std::array<Slot, N> buffer_;
-    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};  // Producer position
-    alignas(64) std::atomic<std::size_t> dequeue_pos_{0};  // Consumer position
+    struct Cursors {
+        alignas(64) std::atomic<std::size_t> enqueue_pos{0};  // Producer position
+        alignas(64) std::atomic<std::size_t> dequeue_pos{0};  // Consumer position
+    };
     
-    static constexpr std::size_t MASK = N - 1;  // For efficient modulo operation
+    Cursors local_cursors_;
+    Cursors* cursors_ = &local_cursors_;  // Or at the start of external memory
+    bool owns_slots_ = true;              // false: slots live in caller-provided memory
+    std::atomic<bool> closed_{false};     // End of stream, this process only
+    
+    static std::size_t validate_size(std::size_t size) {
+        if (size < 2 || (size & (size - 1)) != 0) {
+            std::ostringstream oss;
+            oss << "Ring buffer size must be a power of 2 and at least 2, got " << size;
+            throw std::invalid_argument(oss.str());
+        }
+        return size;
+    }
+    
+    // Dense layout places the payload array on the first cache line after the sequences
+    static std::size_t payload_offset(std::size_t size) {
+        return (size * sizeof(Sequence) + CACHE_LINE - 1) & ~(CACHE_LINE - 1);
+    }
+    
+    static std::size_t storage_bytes(std::size_t size) {
+        if constexpr (DENSE) {
+            return payload_offset(size) + size * sizeof(T);
+        } else {
+            return size * sizeof(Slot);
+        }
+    }
+    
+    // Point at the slot array(s) at base, constructing them when initialize is set
+    void place_slots(void* base, bool initialize) {
+        // Construct slots in place - each slot's sequence starts with its index
+        if constexpr (DENSE) {
+            sequences_ = reinterpret_cast<Sequence*>(static_cast<char*>(base));
+            payloads_ = reinterpret_cast<T*>(static_cast<char*>(base) + payload_offset(size_));
+            for (std::size_t i = 0; initialize && i < size_; ++i) {
+                new (&sequences_[i]) Sequence(i);
+                new (&payloads_[i]) T();
+            }
+        } else {
+            buffer_ = static_cast<Slot*>(base);
+            for (std::size_t i = 0; initialize && i < size_; ++i) {
+                Slot* slot = new (&buffer_[i]) Slot();
+                slot->sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    Sequence& sequence_at(std::size_t index) {
+        if constexpr (DENSE) {
+            return sequences_[index];
+        } else {
+            return buffer_[index].sequence;
+        }
+    }
+    
+    T& data_at(std::size_t index) {
+        if constexpr (DENSE) {
+            return payloads_[index];
+        } else {
+            return buffer_[index].data;
+        }
+    }
+    
+    // Slot index of a payload pointer handed out by try_claim()/try_peek()
+    std::size_t index_of(const T* item) const {
+        if constexpr (DENSE) {
+            return static_cast<std::size_t>(item - payloads_);
+        } else {
+            auto offset = reinterpret_cast<const char*>(item) - reinterpret_cast<const char*>(buffer_);
+            return static_cast<std::size_t>(offset) / sizeof(Slot);
+        }
+    }
     
 public:
-    LockFreeRingBuffer() {
-        // Initialize sequence numbers - each slot starts with its index
-        for (std::size_t i = 0; i < N; ++i) {
-            buffer_[i].sequence.store(i, std::memory_order_relaxed);
+    explicit LockFreeRingBuffer(std::size_t size, const MemoryOptions& options = {})
+        : size_(validate_size(size)),
+          mask_(size - 1),
+          storage_(storage_bytes(size), options) {
+        place_slots(storage_.data(), true);
+    }
+    
+    /**
+     * Queue laid out in caller-provided memory of external_bytes(size)
+     * bytes, 64-byte aligned: the positions, then the slots. Everything in
+     * it is addressed by index, so the same memory may be mapped at
+     * different addresses in different processes (T must then be
+     * trivially copyable). initialize = false adopts a queue set up
+     * earlier, e.g. by another process. The memory must outlive the queue,
+     * which leaves it as it is on destruction.
+     */
+    LockFreeRingBuffer(std::size_t size, void* memory, bool initialize)
+        : size_(validate_size(size)),
+          mask_(size - 1),
+          owns_slots_(false) {
+        static_assert(std::atomic<std::size_t>::is_always_lock_free,
+                      "Queue positions must be lock-free to be shared");
+        cursors_ = initialize ? new (memory) Cursors() : static_cast<Cursors*>(memory);
+        place_slots(static_cast<char*>(memory) + sizeof(Cursors), initialize);
+    }
+    
+    /**
+     * Bytes of external memory a queue of size slots takes.
+     */
+    static std::size_t external_bytes(std::size_t size) {
+        return sizeof(Cursors) + storage_bytes(size);
+    }
+    
+    ~LockFreeRingBuffer() {
+        for (std::size_t i = 0; owns_slots_ && i < size_; ++i) {
+            if constexpr (DENSE) {
+                sequences_[i].~Sequence();
+                payloads_[i].~T();
+            } else {
+                buffer_[i].~Slot();
+            }
         }
     }
     
+    // Concurrency supported by this queue, for callers that need to check
+    static constexpr bool MULTI_PRODUCER = true;
+    static constexpr bool MULTI_CONSUMER = true;
+    
     // Non-copyable to prevent accidental copies
     LockFreeRingBuffer(const LockFreeRingBuffer&) = delete;
     LockFreeRingBuffer& operator=(const LockFreeRingBuffer&) = delete;
@@ -55,17 +201,17 @@ public:
      * Multiple producer threads can call this concurrently.
      */
     bool try_push(const T& item) {
-        Slot* slot;
-        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Sequence* sequence;
+        std::size_t pos = cursors_->enqueue_pos.load(std::memory_order_relaxed);
         
         while (true) {
-            slot = &buffer_[pos & MASK];
-            std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+            sequence = &sequence_at(pos & mask_);
+            std::size_t seq = sequence->load(std::memory_order_acquire);
             std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
             
             if (diff == 0) {
                 // This slot is available for writing
-                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                if (cursors_->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
                     break; // Successfully claimed this slot
                 }
                 // CAS failed, another thread got this slot, retry with updated pos
@@ -76,15 +222,15 @@ public:
             }
             else {
                 // Another thread is working on this slot, update pos and retry
-                pos = enqueue_pos_.load(std::memory_order_relaxed);
+                pos = cursors_->enqueue_pos.load(std::memory_order_relaxed);
             }
         }
         
         // Write data to claimed slot
-        slot->data = item;
+        data_at(pos & mask_) = item;
         
         // Release the slot for consumers (increment sequence to pos + 1)
-        slot->sequence.store(pos + 1, std::memory_order_release);
+        sequence->store(pos + 1, std::memory_order_release);
         return true;
     }
     
@@ -95,17 +241,17 @@ public:
      * Multiple consumer threads can call this concurrently.
      */
     bool try_pop(T& item) {
-        Slot* slot;
-        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Sequence* sequence;
+        std::size_t pos = cursors_->dequeue_pos.load(std::memory_order_relaxed);
         
         while (true) {
-            slot = &buffer_[pos & MASK];
-            std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+            sequence = &sequence_at(pos & mask_);
+            std::size_t seq = sequence->load(std::memory_order_acquire);
             std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
             
             if (diff == 0) {
                 // This slot contains data ready for reading
-                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                if (cursors_->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
                     break; // Successfully claimed this slot
                 }
                 // CAS failed, another thread got this slot, retry with updated pos
@@ -116,26 +262,193 @@ public:
             }
             else {
                 // Another thread is working on this slot, update pos and retry
-                pos = dequeue_pos_.load(std::memory_order_relaxed);
+                pos = cursors_->dequeue_pos.load(std::memory_order_relaxed);
             }
         }
         
         // Read data from claimed slot
-        item = slot->data;
+        item = data_at(pos & mask_);
         
-        // Release the slot for producers (increment sequence to pos + N)
-        slot->sequence.store(pos + N, std::memory_order_release);
+        // Release the slot for producers (increment sequence to pos + size)
+        sequence->store(pos + size_, std::memory_order_release);
         return true;
     }
     
+    /**
+     * Attempt to push up to count items (multi-producer safe).
+     * Claims a contiguous run of free slots with a single CAS and returns
+     * the number of items actually pushed (0 if the buffer is full).
+     * Items are published in order, so consumers never see a gap.
+     */
+    std::size_t try_push_bulk(const T* items, std::size_t count) {
+        if (count == 0) {
+            return 0;
+        }
+        
+        std::size_t pos = cursors_->enqueue_pos.load(std::memory_order_relaxed);
+        std::size_t claimed;
+        
+        while (true) {
+            std::size_t seq = sequence_at(pos & mask_).load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            
+            if (diff == 0) {
+                // First slot is free, extend the claim over the following free slots
+                claimed = 1;
+                while (claimed < count &&
+                       sequence_at((pos + claimed) & mask_).load(std::memory_order_acquire) == pos + claimed) {
+                    ++claimed;
+                }
+                if (cursors_->enqueue_pos.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+                    break; // Successfully claimed [pos, pos + claimed)
+                }
+                // CAS failed, another thread moved the position, retry with updated pos
+            }
+            else if (diff < 0) {
+                // Queue is full
+                return 0;
+            }
+            else {
+                // Another thread is working on this slot, update pos and retry
+                pos = cursors_->enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        
+        for (std::size_t i = 0; i < claimed; ++i) {
+            std::size_t index = (pos + i) & mask_;
+            data_at(index) = items[i];
+            sequence_at(index).store(pos + i + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+    
+    /**
+     * Attempt to pop up to count items (multi-consumer safe).
+     * Claims a contiguous run of ready slots with a single CAS and returns
+     * the number of items actually popped (0 if the buffer is empty).
+     */
+    std::size_t try_pop_bulk(T* items, std::size_t count) {
+        if (count == 0) {
+            return 0;
+        }
+        
+        std::size_t pos = cursors_->dequeue_pos.load(std::memory_order_relaxed);
+        std::size_t claimed;
+        
+        while (true) {
+            std::size_t seq = sequence_at(pos & mask_).load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            
+            if (diff == 0) {
+                // First slot is ready, extend the claim over the following ready slots
+                claimed = 1;
+                while (claimed < count &&
+                       sequence_at((pos + claimed) & mask_).load(std::memory_order_acquire) == pos + claimed + 1) {
+                    ++claimed;
+                }
+                if (cursors_->dequeue_pos.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+                    break; // Successfully claimed [pos, pos + claimed)
+                }
+                // CAS failed, another thread moved the position, retry with updated pos
+            }
+            else if (diff < 0) {
+                // Queue is empty
+                return 0;
+            }
+            else {
+                // Another thread is working on this slot, update pos and retry
+                pos = cursors_->dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        
+        for (std::size_t i = 0; i < claimed; ++i) {
+            std::size_t index = (pos + i) & mask_;
+            items[i] = data_at(index);
+            sequence_at(index).store(pos + i + size_, std::memory_order_release);
+        }
+        return claimed;
+    }
+    
+    /**
+     * Zero-copy producer API (multi-producer safe).
+     * Reserves the next slot and returns a pointer to it, or nullptr if the
+     * buffer is full. The caller writes the record in place and must then
+     * call commit() with the same pointer to publish it.
+     */
+    T* try_claim() {
+        std::size_t pos = cursors_->enqueue_pos.load(std::memory_order_relaxed);
+        
+        while (true) {
+            std::size_t seq = sequence_at(pos & mask_).load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            
+            if (diff == 0) {
+                if (cursors_->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return &data_at(pos & mask_);
+                }
+            }
+            else if (diff < 0) {
+                return nullptr;  // Queue is full
+            }
+            else {
+                pos = cursors_->enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    /**
+     * Publish a slot obtained from try_claim() to consumers.
+     */
+    void commit(T* slot) {
+        // The claimed slot still holds sequence == pos, and only we can touch it
+        Sequence& sequence = sequence_at(index_of(slot));
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    
+    /**
+     * Zero-copy consumer API (multi-consumer safe).
+     * Claims the next ready slot and returns a pointer to the record in
+     * place, or nullptr if the buffer is empty. The caller must call
+     * release() with the same pointer once it is done reading.
+     */
+    const T* try_peek() {
+        std::size_t pos = cursors_->dequeue_pos.load(std::memory_order_relaxed);
+        
+        while (true) {
+            std::size_t seq = sequence_at(pos & mask_).load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            
+            if (diff == 0) {
+                if (cursors_->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return &data_at(pos & mask_);
+                }
+            }
+            else if (diff < 0) {
+                return nullptr;  // Queue is empty
+            }
+            else {
+                pos = cursors_->dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    /**
+     * Hand a slot obtained from try_peek() back to producers.
+     */
+    void release(const T* slot) {
+        // The peeked slot holds sequence == pos + 1; the next lap expects pos + size
+        Sequence& sequence = sequence_at(index_of(slot));
+        sequence.store(sequence.load(std::memory_order_relaxed) + size_ - 1, std::memory_order_release);
+    }
+    
     /**
      * Get current buffer utilization (0.0 to 1.0).
      * Useful for monitoring but not guaranteed to be exact due to concurrent access.
      */
     double utilization() const {
-        std::size_t enq_pos = enqueue_pos_.load(std::memory_order_relaxed);
-        std::size_t deq_pos = dequeue_pos_.load(std::memory_order_relaxed);
-        return static_cast<double>(enq_pos - deq_pos) / N;
+        std::size_t enq_pos = cursors_->enqueue_pos.load(std::memory_order_relaxed);
+        std::size_t deq_pos = cursors_->dequeue_pos.load(std::memory_order_relaxed);
+        return static_cast<double>(enq_pos - deq_pos) / static_cast<double>(size_);
     }
     
     /**
@@ -143,8 +456,8 @@ public:
      * Not guaranteed to be exact due to concurrent access.
      */
     size_t size() const {
-        std::size_t enq_pos = enqueue_pos_.load(std::memory_order_relaxed);
-        std::size_t deq_pos = dequeue_pos_.load(std::memory_order_relaxed);
+        std::size_t enq_pos = cursors_->enqueue_pos.load(std::memory_order_relaxed);
+        std::size_t deq_pos = cursors_->dequeue_pos.load(std::memory_order_relaxed);
         return static_cast<size_t>(enq_pos - deq_pos);
     }
     
@@ -152,9 +465,29 @@ public:
         return size() == 0;
     }
     
-    static constexpr size_t capacity() {
-        return N - 1;  // One slot reserved to distinguish full from empty
+    size_t capacity() const {
+        return size_;  // Per-slot sequences tell full from empty, no slot reserved
     }
+    
+    /**
+     * Mark the end of the stream once the last producer has returned.
+     * Everything pushed before is visible to a consumer that reads
+     * closed() and then finds the queue empty.
+     */
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+    
+    /**
+     * How the slot array ended up being backed (hugetlb, THP or regular pages).
+     */
+    PageBacking page_backing() const { return storage_.backing(); }
+    
+    /**
+     * Bytes of memory reserved for the slot array(s).
+     */
+    size_t memory_bytes() const { return storage_.size(); }
+    
+    static constexpr SlotLayout layout() { return Layout; }
 };
 
 } // namespace market_data
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "AsyncLogger.hpp"
+#include "CompactRingBuffer.hpp"
+#include "Config.hpp"
+#include "InstrumentTable.hpp"
+#include "LockFreeRingBuffer.hpp"
+#include "SharedMemoryQueue.hpp"
+#include "SpscRingBuffer.hpp"
+#include "ThreadAffinity.hpp"
+#include "Types.hpp"
+#include "WaitStrategy.hpp"
+#include <databento/enums.hpp>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace market_data {
+
+// Queue types the handlers can publish into
+using MpmcDataQueue = LockFreeRingBuffer<MarketDataPoint,
+    config::QUEUE_DENSE_LAYOUT ? SlotLayout::Dense : SlotLayout::Padded>;
+using SpscDataQueue = std::conditional_t<config::QUEUE_COMPACT, CompactRingBuffer, SpscRingBuffer<MarketDataPoint>>;
+
+using SharedDataQueue = SharedRingBuffer<MarketDataPoint, MpmcDataQueue::layout()>;
+
+// Queue used by the engine; policy is selected in Config.hpp
+using EngineDataQueue = std::conditional_t<config::QUEUE_SHARED_MEMORY, SharedDataQueue,
+    std::conditional_t<config::QUEUE_SPSC, SpscDataQueue, MpmcDataQueue>>;
+
+// Logged by the producer threads once per 1000 dropped records
+inline constexpr LogFormat QUEUE_OVERRUN_LOG{LogLevel::Error, "Queue overrun detected. Queue utilization: {}%"};
+
+/**
+ * What to subscribe to or fetch. Live sources ignore the time range.
+ */
+struct SourceRequest {
+    std::string dataset;
+    std::vector<std::string> symbols;
+    std::string start_time;   // ISO 8601 (historical only)
+    std::string end_time;
+    std::string schema = "bbo-1s";
+    databento::SType stype_in = databento::SType::Parent;
+};
+
+/**
+ * MarketDataSource - a producer feeding MarketDataPoints into a queue.
+ *
+ * Implemented by the historical (BasicDatabentoHandler) and live
+ * (BasicLiveHandler) handlers so the engine can run either behind the
+ * same consumers. Each source owns its queue; consumers take it from
+ * GetQueue() and drain it the same way regardless of the source.
+ */
+template<typename QueueT>
+class MarketDataSource {
+public:
+    using DataQueue = QueueT;
+
+    virtual ~MarketDataSource() = default;
+
+    /**
+     * Start producing in the background. Errors go to the error callback.
+     */
+    virtual void Start(const SourceRequest& request) = 0;
+
+    /**
+     * Stop producing and join the producer thread(s).
+     */
+    virtual void Stop() = 0;
+
+    /**
+     * True while the source is still producing (a historical fetch ends on
+     * its own, a live session runs until stopped).
+     */
+    virtual bool IsRunning() const = 0;
+
+    virtual DataQueue& GetQueue() = 0;
+    virtual const PerformanceMetrics& GetMetrics() const = 0;
+    virtual const InstrumentUniverse& GetInstruments() const = 0;
+
+    /**
+     * Notify this signal after each publish (consumers using BlockingWait).
+     */
+    virtual void SetConsumerSignal(QueueSignal* signal) = 0;
+
+    virtual void SetErrorCallback(std::function<void(const std::string&)> callback) = 0;
+
+    /**
+     * Route hot-path reports (queue overruns) from the producer threads
+     * through this logger instead of formatting them for the error
+     * callback. Set before Start(); the logger must outlive the source.
+     */
+    virtual void SetLogger(AsyncLogger* logger) = 0;
+
+    /**
+     * Placement of the producer threads of the current (or last) run, as
+     * each thread read it back when it started.
+     */
+    virtual std::vector<PlacementLog::Entry> GetThreadPlacements() const = 0;
+};
+
+} // namespace market_data
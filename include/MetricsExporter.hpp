@@ -0,0 +1,643 @@
+#pragma once
+
+#include "Types.hpp"
+#include "SharedMemoryQueue.hpp"
+#include "ThreadAffinity.hpp"
+#include "ThreadMetrics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace market_data {
+
+/**
+ * Shared-memory metrics page, for co-located tools that would rather read
+ * memory than scrape HTTP:
+ *
+ *   MetricsPageHeader                  64 bytes
+ *   MetricsPageEntry[capacity]         count of them in use
+ *
+ * Entries are the exporter's series, e.g.
+ * mde_queue_depth{queue="worker0"}, with their value. The header's
+ * sequence is a seqlock: odd while the exporter rewrites the page, so a
+ * reader copies the page and retries if the sequence changed or was odd
+ * (MetricsPageReader does this).
+ */
+struct MetricsPageHeader {
+    char magic[8];                    // "MDEMETR"
+    uint32_t version;
+    uint32_t entry_bytes;             // sizeof(MetricsPageEntry)
+    uint32_t capacity;                // Entries the page has room for
+    uint32_t count;                   // Entries written by the last sample
+    std::atomic<uint64_t> sequence;   // Seqlock, even = stable
+    int64_t sample_ns;                // Wall clock of the last sample
+    int64_t interval_ns;
+    uint64_t samples;
+    uint32_t dropped;                 // Series that did not fit the page
+    uint32_t reserved;
+};
+
+struct MetricsPageEntry {
+    char series[120];                 // NUL-terminated, truncated if longer
+    double value;
+};
+
+static_assert(sizeof(MetricsPageHeader) == 64, "MetricsPageHeader should stay one cache line");
+static_assert(sizeof(MetricsPageEntry) == 128, "MetricsPageEntry should stay two cache lines");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Metrics page sequence must be lock-free");
+
+inline constexpr char METRICS_PAGE_MAGIC[8] = {'M', 'D', 'E', 'M', 'E', 'T', 'R', '\0'};
+inline constexpr uint32_t METRICS_PAGE_VERSION = 1;
+
+/**
+ * Read side of the metrics page, from any process.
+ */
+class MetricsPageReader {
+public:
+    explicit MetricsPageReader(const std::string& name)
+        : region_(SharedMemoryRegion::attach(name, no_huge_pages())) {
+        if (region_.size() < sizeof(MetricsPageHeader)) {
+            throw std::runtime_error("Shared memory '" + name + "' is too small for a metrics page");
+        }
+        header_ = static_cast<const MetricsPageHeader*>(region_.data());
+        if (std::memcmp(header_->magic, METRICS_PAGE_MAGIC, sizeof(METRICS_PAGE_MAGIC)) != 0 ||
+            header_->version != METRICS_PAGE_VERSION || header_->entry_bytes != sizeof(MetricsPageEntry) ||
+            region_.size() < sizeof(MetricsPageHeader) + header_->capacity * sizeof(MetricsPageEntry)) {
+            throw std::runtime_error("Shared memory '" + name + "' is not a metrics page of this version");
+        }
+        entries_ = reinterpret_cast<const MetricsPageEntry*>(header_ + 1);
+    }
+
+    /**
+     * A consistent copy of the last sample, false if nothing was sampled
+     * yet or the writer kept rewriting the page.
+     */
+    bool read(std::vector<std::pair<std::string, double>>& out, int64_t* sample_ns = nullptr) const {
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            uint64_t before = header_->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t count = std::min(header_->count, header_->capacity);
+            int64_t stamp = header_->sample_ns;
+            copy_.assign(entries_, entries_ + count);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header_->sequence.load(std::memory_order_relaxed) != before) {
+                continue;
+            }
+            if (before == 0) {
+                return false;
+            }
+            out.clear();
+            for (const MetricsPageEntry& entry : copy_) {
+                out.emplace_back(std::string(entry.series, strnlen(entry.series, sizeof(entry.series))), entry.value);
+            }
+            if (sample_ns) {
+                *sample_ns = stamp;
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    static MemoryOptions no_huge_pages() {
+        MemoryOptions options;
+        options.use_huge_pages = false;
+        return options;
+    }
+
+    SharedMemoryRegion region_;
+    const MetricsPageHeader* header_ = nullptr;
+    const MetricsPageEntry* entries_ = nullptr;
+    mutable std::vector<MetricsPageEntry> copy_;
+};
+
+/**
+ * MetricsExporter - publishes the engine's metrics while it runs.
+ *
+ * A background thread samples every interval what was registered before
+ * Start(): PerformanceMetrics totals and latency summaries per source,
+ * queue depths, and per-instrument message counts. It derives rates
+ * from the change since the previous sample and publishes the result as
+ * Prometheus text on an HTTP endpoint (GET /metrics) and/or into a
+ * shared-memory page (MetricsPageHeader).
+ *
+ * Sampling only reads, with relaxed loads: the per-thread counter blocks
+ * and histograms, the per-instrument InstrumentCounters the consumers and
+ * shard workers keep, and the queue positions. No hot thread is asked for
+ * anything. The HTTP server runs on the same thread, one short request at
+ * a time, so a slow scraper delays the next sample but never a hot
+ * thread.
+ */
+class MetricsExporter {
+public:
+    struct Options {
+        std::chrono::milliseconds interval{1000};
+        int http_port = 0;                      // 0 = no HTTP endpoint, -1 = any free port
+        std::string http_bind = "127.0.0.1";    // Listen address
+        std::string shared_name;                // Metrics page name, "" = none
+        size_t page_entries = 4096;             // Series the page has room for
+        size_t max_instruments = 1024;          // Instruments exported, lowest ids first
+        ThreadPlacement placement;              // Exporter thread (never SCHED_FIFO)
+    };
+
+    /**
+     * Opens the listening socket and creates the page; throws if either
+     * fails.
+     */
+    explicit MetricsExporter(const Options& options) : options_(options) {
+        options_.placement.fifo_priority = 0;
+        if (options_.interval.count() <= 0) {
+            throw std::invalid_argument("Metrics export interval must be positive");
+        }
+        if (options_.http_port != 0) {
+            OpenListener();
+        }
+        if (!options_.shared_name.empty()) {
+            MemoryOptions memory;
+            memory.use_huge_pages = false;  // A few hundred KiB
+            size_t bytes = sizeof(MetricsPageHeader) + options_.page_entries * sizeof(MetricsPageEntry);
+            page_ = SharedMemoryRegion::create(options_.shared_name, bytes, memory);
+            auto* header = new (page_.data()) MetricsPageHeader();
+            std::memcpy(header->magic, METRICS_PAGE_MAGIC, sizeof(header->magic));
+            header->version = METRICS_PAGE_VERSION;
+            header->entry_bytes = static_cast<uint32_t>(sizeof(MetricsPageEntry));
+            header->capacity = static_cast<uint32_t>(options_.page_entries);
+            header->interval_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.interval).count();
+            header->sequence.store(0, std::memory_order_release);
+        }
+    }
+
+    ~MetricsExporter() {
+        Stop();
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+        }
+    }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * A source's metrics, exported with source="label". Register before
+     * Start(); metrics must outlive the exporter.
+     */
+    void add_source(const std::string& label, const PerformanceMetrics& metrics) {
+        check_not_running();
+        sources_.push_back({label, &metrics, 0, 0});
+    }
+
+    /**
+     * A queue's depth (slots in use) and capacity, exported with
+     * queue="label".
+     */
+    template<typename Queue>
+    void add_queue(const std::string& label, const Queue& queue) {
+        add_queue(label, [&queue] { return queue.size(); }, queue.capacity());
+    }
+
+    // Depth read through a callable, e.g. ShardedPipeline::shard_queue_size()
+    void add_queue(const std::string& label, std::function<size_t()> depth, size_t capacity) {
+        check_not_running();
+        queues_.push_back({label, std::move(depth), capacity});
+    }
+
+    /**
+     * Per-instrument counts of one consumer or shard worker, e.g.
+     * ShardedPipeline::shard_instruments(). Counts of the same instrument
+     * from several threads are added up. counts must outlive the exporter.
+     */
+    void add_instruments(const InstrumentCounters& counts) {
+        check_not_running();
+        instrument_sources_.push_back(&counts);
+    }
+
+    void Start() {
+        if (running_.exchange(true)) {
+            return;
+        }
+        thread_ = std::thread([this] {
+            placements_.record("metrics", apply_thread_placement(options_.placement));
+            Run();
+        });
+    }
+
+    /**
+     * Take a last sample and join the thread.
+     */
+    void Stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    // Prometheus text of the last sample
+    std::string text() const {
+        std::lock_guard<std::mutex> lock(text_mutex_);
+        return text_;
+    }
+
+    uint64_t samples() const { return samples_.load(); }
+    uint64_t http_requests() const { return http_requests_.load(); }
+
+    // Port the endpoint listens on (the one picked for -1), 0 = none
+    int http_port() const { return bound_port_; }
+
+    const std::string& shared_name() const { return options_.shared_name; }
+
+    std::vector<PlacementLog::Entry> thread_placements() const { return placements_.entries(); }
+
+private:
+    struct SourceEntry {
+        std::string label;
+        const PerformanceMetrics* metrics;
+        uint64_t last_received;
+        uint64_t last_processed;
+    };
+
+    struct QueueEntry {
+        std::string label;
+        std::function<size_t()> depth;
+        size_t capacity;
+    };
+
+    struct Family {
+        std::string name;
+        const char* type;
+        const char* help;
+        std::vector<std::pair<std::string, double>> samples;  // Full series, value
+    };
+
+    // Families in output order, built fresh each sample; a deque keeps
+    // the returned references valid
+    class Families {
+    public:
+        Family& add(const std::string& name, const char* type, const char* help) {
+            families_.push_back({name, type, help, {}});
+            return families_.back();
+        }
+
+        static void sample(Family& family, const std::string& labels, double value, const char* suffix = "") {
+            std::string series = family.name + suffix;
+            if (!labels.empty()) {
+                series += "{" + labels + "}";
+            }
+            family.samples.emplace_back(std::move(series), value);
+        }
+
+        const std::deque<Family>& all() const { return families_; }
+
+    private:
+        std::deque<Family> families_;
+    };
+
+    void check_not_running() const {
+        if (running_.load()) {
+            throw std::logic_error("Register metrics before MetricsExporter::Start()");
+        }
+    }
+
+    static std::runtime_error socket_error(const char* what) {
+        std::ostringstream oss;
+        oss << "Metrics endpoint " << what << " failed: " << std::strerror(errno);
+        return std::runtime_error(oss.str());
+    }
+
+    void OpenListener() {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (listen_fd_ < 0) {
+            throw socket_error("socket");
+        }
+        int one = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(options_.http_port < 0 ? 0 : options_.http_port));
+        if (::inet_pton(AF_INET, options_.http_bind.c_str(), &address.sin_addr) != 1) {
+            throw std::invalid_argument("Invalid metrics bind address: " + options_.http_bind);
+        }
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            throw socket_error("bind");
+        }
+        if (::listen(listen_fd_, 16) != 0) {
+            throw socket_error("listen");
+        }
+        socklen_t length = sizeof(address);
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+        bound_port_ = ntohs(address.sin_port);
+    }
+
+    void Run() {
+        using Clock = std::chrono::steady_clock;
+        auto next_sample = Clock::now();
+        while (true) {
+            bool stopping = !running_.load(std::memory_order_acquire);
+            auto now = Clock::now();
+            if (now >= next_sample || stopping) {
+                Sample();
+                next_sample = now + options_.interval;
+            }
+            if (stopping) {
+                break;
+            }
+            // Wait for a scrape until the next sample, waking up now and
+            // then to notice Stop()
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_sample - Clock::now());
+            int timeout_ms = static_cast<int>(std::clamp<int64_t>(wait.count(), 0, 100));
+            if (listen_fd_ < 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+                continue;
+            }
+            pollfd listener{listen_fd_, POLLIN, 0};
+            if (::poll(&listener, 1, timeout_ms) > 0 && (listener.revents & POLLIN)) {
+                int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+                if (client >= 0) {
+                    Serve(client);
+                    ::close(client);
+                }
+            }
+        }
+    }
+
+    // One request per connection; reads and writes time out after 200 ms
+    void Serve(int client) {
+        timeval timeout{0, 200000};
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        char request[2048];
+        size_t have = 0;
+        while (have < sizeof(request) - 1) {
+            ssize_t n = ::recv(client, request + have, sizeof(request) - 1 - have, 0);
+            if (n <= 0) {
+                break;
+            }
+            have += static_cast<size_t>(n);
+            request[have] = '\0';
+            if (std::strstr(request, "\r\n\r\n") || std::strstr(request, "\n\n")) {
+                break;
+            }
+        }
+        request[have] = '\0';
+        http_requests_.fetch_add(1, std::memory_order_relaxed);
+
+        std::string status = "200 OK";
+        std::string body;
+        if (std::strncmp(request, "GET /metrics", 12) == 0 &&
+            (request[12] == ' ' || request[12] == '?')) {
+            body = text();
+        } else if (std::strncmp(request, "GET / ", 6) == 0) {
+            body = "Market data engine metrics: /metrics\n";
+        } else {
+            status = "404 Not Found";
+            body = "Not found\n";
+        }
+        std::string response = "HTTP/1.0 " + status +
+                               "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t n = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    // key="value"; backslash, double quote and newline are escaped as the text format requires
+    static std::string label(const char* key, const std::string& value) {
+        std::string out = std::string(key) + "=\"";
+        for (char c : value) {
+            if (c == '\\' || c == '"') {
+                out += '\\';
+                out += c;
+            } else if (c == '\n') {
+                out += "\\n";
+            } else {
+                out += c;
+            }
+        }
+        out += '"';
+        return out;
+    }
+
+    static void summary(Families& families, const std::string& name, const char* help,
+                        const std::vector<std::pair<std::string, HistogramSnapshot>>& histograms) {
+        Family& family = families.add(name, "summary", help);
+        for (const auto& [labels, histogram] : histograms) {
+            if (histogram.count == 0) {
+                continue;
+            }
+            std::string prefix = labels.empty() ? "" : labels + ",";
+            Families::sample(family, prefix + "quantile=\"0.5\"", static_cast<double>(histogram.percentile(50.0)));
+            Families::sample(family, prefix + "quantile=\"0.99\"", static_cast<double>(histogram.percentile(99.0)));
+            Families::sample(family, prefix + "quantile=\"0.999\"", static_cast<double>(histogram.percentile(99.9)));
+            Families::sample(family, prefix + "quantile=\"1\"", static_cast<double>(histogram.max));
+            Families::sample(family, labels, static_cast<double>(histogram.sum), "_sum");
+            Families::sample(family, labels, static_cast<double>(histogram.count), "_count");
+        }
+    }
+
+    void Sample() {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = samples_.load() == 0 ? 0.0 : std::chrono::duration<double>(now - last_sample_).count();
+        last_sample_ = now;
+        // A counter below its previous value was reset (next job): count from zero
+        auto rate = [elapsed](uint64_t current, uint64_t previous) {
+            if (elapsed <= 0.0) {
+                return 0.0;
+            }
+            return static_cast<double>(current >= previous ? current - previous : current) / elapsed;
+        };
+
+        Families families;
+        Family& received = families.add("mde_messages_received_total", "counter", "Records published into the queue");
+        Family& processed = families.add("mde_messages_processed_total", "counter", "Records taken out by consumers");
+        Family& receive_rate = families.add("mde_receive_rate", "gauge", "Records published per second");
+        Family& process_rate = families.add("mde_process_rate", "gauge", "Records consumed per second");
+        Family& overruns = families.add("mde_buffer_overruns_total", "counter", "Records dropped on a full queue");
+        Family& stalls = families.add("mde_backpressure_stalls_total", "counter", "Publishes that waited for room");
+        Family& stall_seconds = families.add("mde_backpressure_stall_seconds_total", "counter",
+                                             "Time producers spent waiting for room");
+        Family& evicted = families.add("mde_records_evicted_total", "counter", "Oldest records dropped for room");
+        Family& spilled = families.add("mde_records_spilled_total", "counter", "Records written to the spill file");
+        std::vector<std::pair<std::string, HistogramSnapshot>> push, feed, queue, process, end_to_end;
+        for (SourceEntry& source : sources_) {
+            const PerformanceMetrics& metrics = *source.metrics;
+            std::string labels = label("source", source.label);
+            uint64_t in = metrics.messages_received();
+            uint64_t out = metrics.messages_processed();
+            Families::sample(received, labels, static_cast<double>(in));
+            Families::sample(processed, labels, static_cast<double>(out));
+            Families::sample(receive_rate, labels, rate(in, source.last_received));
+            Families::sample(process_rate, labels, rate(out, source.last_processed));
+            source.last_received = in;
+            source.last_processed = out;
+            Families::sample(overruns, labels, static_cast<double>(metrics.buffer_overruns()));
+            Families::sample(stalls, labels, static_cast<double>(metrics.backpressure_stalls.load()));
+            Families::sample(stall_seconds, labels, static_cast<double>(metrics.backpressure_stall_ns.load()) / 1e9);
+            Families::sample(evicted, labels, static_cast<double>(metrics.records_evicted.load()));
+            Families::sample(spilled, labels, static_cast<double>(metrics.records_spilled.load()));
+            push.emplace_back(labels, metrics.push_latency());
+            feed.emplace_back(labels, metrics.feed_latency());
+            queue.emplace_back(labels, metrics.queue_latency());
+            process.emplace_back(labels, metrics.process_latency());
+            end_to_end.emplace_back(labels, metrics.end_to_end_latency());
+        }
+        summary(families, "mde_push_latency_ns", "Publish call latency", push);
+        summary(families, "mde_feed_latency_ns", "Gateway or sender timestamp to enqueued (live)", feed);
+        summary(families, "mde_queue_latency_ns", "Enqueue to dequeue", queue);
+        summary(families, "mde_process_latency_ns", "Dequeue to stats updated", process);
+        summary(families, "mde_end_to_end_latency_ns", "Enqueue to stats updated", end_to_end);
+
+        Family& depth = families.add("mde_queue_depth", "gauge", "Queue slots in use");
+        Family& capacity = families.add("mde_queue_capacity", "gauge", "Queue slots");
+        for (const QueueEntry& entry : queues_) {
+            std::string labels = label("queue", entry.label);
+            Families::sample(depth, labels, static_cast<double>(entry.depth()));
+            Families::sample(capacity, labels, static_cast<double>(entry.capacity));
+        }
+
+        std::map<int32_t, uint64_t> instruments;
+        for (const InstrumentCounters* counts : instrument_sources_) {
+            counts->for_each([&instruments](int32_t id, uint64_t messages) { instruments[id] += messages; });
+        }
+        Family& instrument_messages = families.add("mde_instrument_messages_total", "counter",
+                                                   "Records processed per instrument");
+        Family& instrument_rate = families.add("mde_instrument_message_rate", "gauge",
+                                               "Records processed per instrument per second");
+        size_t exported = 0;
+        for (const auto& [id, messages] : instruments) {
+            if (exported++ == options_.max_instruments) {
+                break;
+            }
+            std::string labels = label("instrument", std::to_string(id));
+            auto previous = last_instruments_.find(id);
+            Families::sample(instrument_messages, labels, static_cast<double>(messages));
+            Families::sample(instrument_rate, labels,
+                             rate(messages, previous == last_instruments_.end() ? 0 : previous->second));
+        }
+        last_instruments_ = std::move(instruments);
+
+        uint64_t sample_count = samples_.load() + 1;
+        Family& exporter = families.add("mde_exporter_samples_total", "counter", "Samples taken by the exporter");
+        Families::sample(exporter, "", static_cast<double>(sample_count));
+
+        Publish(families);
+        samples_.store(sample_count);
+    }
+
+    static void append_value(std::string& out, double value) {
+        char digits[32];
+        int n;
+        if (std::isfinite(value) && value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+            n = std::snprintf(digits, sizeof(digits), "%.0f", value);
+        } else {
+            n = std::snprintf(digits, sizeof(digits), "%.9g", value);
+        }
+        out.append(digits, static_cast<size_t>(std::max(n, 0)));
+    }
+
+    void Publish(const Families& families) {
+        std::string text;
+        for (const Family& family : families.all()) {
+            if (family.samples.empty()) {
+                continue;
+            }
+            text += "# HELP " + family.name + " " + family.help + "\n";
+            text += "# TYPE " + family.name + " " + family.type + "\n";
+            for (const auto& [series, value] : family.samples) {
+                text += series;
+                text += ' ';
+                append_value(text, value);
+                text += '\n';
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(text_mutex_);
+            text_.swap(text);
+        }
+
+        if (!page_.data()) {
+            return;
+        }
+        auto* header = static_cast<MetricsPageHeader*>(page_.data());
+        auto* entries = reinterpret_cast<MetricsPageEntry*>(header + 1);
+        uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+        header->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint32_t count = 0;
+        uint32_t dropped = 0;
+        for (const Family& family : families.all()) {
+            for (const auto& [series, value] : family.samples) {
+                if (count == header->capacity) {
+                    ++dropped;
+                    continue;
+                }
+                MetricsPageEntry& entry = entries[count++];
+                size_t length = std::min(series.size(), sizeof(entry.series) - 1);
+                std::memcpy(entry.series, series.data(), length);
+                entry.series[length] = '\0';
+                entry.value = value;
+            }
+        }
+        header->count = count;
+        header->dropped = dropped;
+        header->samples = samples_.load() + 1;
+        header->sample_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        header->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    Options options_;
+    std::vector<SourceEntry> sources_;
+    std::vector<QueueEntry> queues_;
+    std::vector<const InstrumentCounters*> instrument_sources_;
+
+    // Exporter thread
+    std::chrono::steady_clock::time_point last_sample_;
+    std::map<int32_t, uint64_t> last_instruments_;
+
+    int listen_fd_ = -1;
+    int bound_port_ = 0;
+    SharedMemoryRegion page_;
+
+    mutable std::mutex text_mutex_;
+    std::string text_;
+    std::atomic<uint64_t> samples_{0};
+    std::atomic<uint64_t> http_requests_{0};
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    PlacementLog placements_;
+};
+
+} // namespace market_data
@@ -0,0 +1,749 @@
+#pragma once
+
+#include "Types.hpp"
+#include "AsyncLogger.hpp"
+#include "Backpressure.hpp"
+#include "InstrumentTable.hpp"
+#include "MarketDataSource.hpp"
+#include "SpscRingBuffer.hpp"
+#include "ThreadAffinity.hpp"
+#include "WaitStrategy.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace market_data {
+
+/**
+ * Where a multicast feed is published and how the sockets are set up.
+ * A unicast group address also works (one subscriber, or testing without
+ * multicast routing).
+ */
+struct MulticastOptions {
+    std::string group = "239.192.0.1";
+    uint16_t port = 31001;
+    std::string interface;               // Local interface address, "" = kernel's choice
+    int ttl = 1;                         // Hops; 1 = stay on the local network
+    bool loopback = true;                // Deliver to subscribers on the publishing host
+    size_t payload_bytes = 1472;         // Per datagram: 1500-byte MTU minus IP and UDP headers
+    int socket_buffer_bytes = 4 << 20;   // SO_SNDBUF / SO_RCVBUF
+    int busy_poll_us = 0;                // Receiver SO_BUSY_POLL, 0 = off
+};
+
+/**
+ * Datagram layout: a MulticastHeader, then count raw MarketDataPoints
+ * (host byte order, so publisher and subscribers must share the
+ * architecture and the price representation). sequence numbers records,
+ * so a datagram carries records sequence .. sequence + count - 1. A
+ * heartbeat has count 0 and the next sequence, which lets subscribers
+ * spot losses at the tail of a burst.
+ */
+struct MulticastHeader {
+    uint32_t magic;       // MULTICAST_MAGIC
+    uint16_t version;
+    uint16_t count;       // Records in the datagram, 0 = heartbeat
+    uint64_t session;     // Publisher start time (ns); a new session restarts the sequence
+    uint64_t sequence;
+    int64_t send_ns;      // System clock when sent
+};
+
+static_assert(sizeof(MulticastHeader) == 32, "Multicast header layout changed");
+
+inline constexpr uint32_t MULTICAST_MAGIC = 0x4645444D;  // "MDEF"
+inline constexpr uint16_t MULTICAST_VERSION = config::FIXED_POINT_PRICES ? 0x8001 : 1;
+
+/**
+ * Records that fit in one datagram of payload_bytes.
+ */
+inline size_t multicast_records_per_datagram(size_t payload_bytes) {
+    size_t records = payload_bytes > sizeof(MulticastHeader)
+                         ? (payload_bytes - sizeof(MulticastHeader)) / sizeof(MarketDataPoint) : 0;
+    if (records == 0) {
+        throw std::invalid_argument("Multicast payload too small for one record");
+    }
+    return std::min<size_t>(records, UINT16_MAX);
+}
+
+namespace multicast_detail {
+
+inline std::runtime_error socket_error(const std::string& what) {
+    std::ostringstream oss;
+    oss << "Multicast " << what << " failed: " << std::strerror(errno);
+    return std::runtime_error(oss.str());
+}
+
+inline in_addr parse_address(const std::string& address) {
+    in_addr parsed{};
+    if (::inet_pton(AF_INET, address.c_str(), &parsed) != 1) {
+        throw std::invalid_argument("Invalid IPv4 address: " + address);
+    }
+    return parsed;
+}
+
+inline bool is_multicast(in_addr address) {
+    return IN_MULTICAST(ntohl(address.s_addr));
+}
+
+template<typename T>
+void set_option(int fd, int level, int name, const T& value, const char* what) {
+    if (::setsockopt(fd, level, name, &value, sizeof(value)) != 0) {
+        throw socket_error(what);
+    }
+}
+
+/**
+ * Owned UDP socket descriptor.
+ */
+class UdpSocket {
+public:
+    UdpSocket() {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            throw socket_error("socket");
+        }
+    }
+
+    ~UdpSocket() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    int fd() const { return fd_; }
+
+private:
+    int fd_ = -1;
+};
+
+// Sending socket and the group address to send to
+inline std::unique_ptr<UdpSocket> open_sender(const MulticastOptions& options, sockaddr_in& destination) {
+    auto sock = std::make_unique<UdpSocket>();
+    destination = sockaddr_in{};
+    destination.sin_family = AF_INET;
+    destination.sin_port = htons(options.port);
+    destination.sin_addr = parse_address(options.group);
+    set_option(sock->fd(), SOL_SOCKET, SO_SNDBUF, options.socket_buffer_bytes, "SO_SNDBUF");
+    if (is_multicast(destination.sin_addr)) {
+        set_option(sock->fd(), IPPROTO_IP, IP_MULTICAST_TTL, options.ttl, "IP_MULTICAST_TTL");
+        set_option(sock->fd(), IPPROTO_IP, IP_MULTICAST_LOOP, static_cast<unsigned char>(options.loopback ? 1 : 0),
+                   "IP_MULTICAST_LOOP");
+        if (!options.interface.empty()) {
+            set_option(sock->fd(), IPPROTO_IP, IP_MULTICAST_IF, parse_address(options.interface),
+                       "IP_MULTICAST_IF");
+        }
+    }
+    return sock;
+}
+
+// Receiving socket bound to the port (and joined to the group); reads time
+// out every receive_timeout so the receive thread can notice a stop
+inline std::unique_ptr<UdpSocket> open_receiver(const MulticastOptions& options,
+                                                std::chrono::milliseconds receive_timeout) {
+    auto sock = std::make_unique<UdpSocket>();
+    in_addr group = parse_address(options.group);
+    set_option(sock->fd(), SOL_SOCKET, SO_REUSEADDR, 1, "SO_REUSEADDR");  // Several subscribers per host
+    set_option(sock->fd(), SOL_SOCKET, SO_RCVBUF, options.socket_buffer_bytes, "SO_RCVBUF");
+#if defined(SO_BUSY_POLL)
+    if (options.busy_poll_us > 0) {
+        set_option(sock->fd(), SOL_SOCKET, SO_BUSY_POLL, options.busy_poll_us, "SO_BUSY_POLL");
+    }
+#endif
+    timeval timeout{};
+    timeout.tv_sec = static_cast<time_t>(receive_timeout.count() / 1000);
+    timeout.tv_usec = static_cast<suseconds_t>(receive_timeout.count() % 1000 * 1000);
+    set_option(sock->fd(), SOL_SOCKET, SO_RCVTIMEO, timeout, "SO_RCVTIMEO");
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(options.port);
+    local.sin_addr = group;  // Only this group's traffic (or the unicast address itself)
+    if (::bind(sock->fd(), reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0) {
+        throw socket_error("bind");
+    }
+    if (is_multicast(group)) {
+        ip_mreq membership{};
+        membership.imr_multiaddr = group;
+        membership.imr_interface.s_addr = options.interface.empty() ? htonl(INADDR_ANY)
+                                                                    : parse_address(options.interface).s_addr;
+        set_option(sock->fd(), IPPROTO_IP, IP_ADD_MEMBERSHIP, membership, "IP_ADD_MEMBERSHIP");
+    }
+    return sock;
+}
+
+inline int64_t system_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace multicast_detail
+
+/**
+ * MulticastPublisher - fans the processed stream out to other processes
+ * over UDP multicast.
+ *
+ * Like ColumnarCapture it is fed by the thread that processes the stream
+ * (append() per record, flush() per batch) through an SPSC queue, so the
+ * consumer never makes a system call. A sender thread packs what it pops
+ * into datagrams of up to payload_bytes and hands up to batch_datagrams of
+ * them to the kernel with one sendmmsg. Datagrams are sent as soon as
+ * records are there, not held until full. An idle sender sends a heartbeat
+ * every heartbeat interval.
+ *
+ * A full queue back-pressures the producer, or drops (counted) with
+ * drop_on_full. Failed sends are counted and their records skipped, so
+ * subscribers see a sequence gap.
+ *
+ * Exactly one thread may call append() / flush().
+ */
+class MulticastPublisher {
+public:
+    struct Options {
+        MulticastOptions network;
+        size_t queue_size = 256 * 1024;              // Records, power of 2
+        size_t batch_datagrams = 32;                 // Datagrams per sendmmsg
+        std::chrono::milliseconds heartbeat{100};
+        bool drop_on_full = false;                   // false = back-pressure the producer
+        ThreadPlacement placement;                   // Sender thread
+        MemoryOptions queue_memory;
+    };
+
+    /**
+     * Open the sending socket. Throws on a bad address or socket error.
+     */
+    explicit MulticastPublisher(const Options& options)
+        : options_(options),
+          per_datagram_(multicast_records_per_datagram(options.network.payload_bytes)),
+          session_(static_cast<uint64_t>(multicast_detail::system_now_ns())),
+          queue_(options.queue_size, options.queue_memory) {
+        if (options_.batch_datagrams == 0) {
+            options_.batch_datagrams = 1;
+        }
+        socket_ = multicast_detail::open_sender(options_.network, destination_);
+    }
+
+    ~MulticastPublisher() {
+        Stop();
+    }
+
+    MulticastPublisher(const MulticastPublisher&) = delete;
+    MulticastPublisher& operator=(const MulticastPublisher&) = delete;
+
+    void Start() {
+        if (started_.exchange(true)) {
+            return;
+        }
+        sender_ = std::thread([this] {
+            placements_.record("multicast send", apply_thread_placement(options_.placement));
+            SendLoop();
+        });
+    }
+
+    /**
+     * Send what was appended, then a final heartbeat, and join the sender.
+     * Call once the producer has flushed for the last time.
+     */
+    void Stop() {
+        if (!started_.load() || stopping_.exchange(true)) {
+            return;
+        }
+        signal_.wake_all();
+        if (sender_.joinable()) {
+            sender_.join();
+        }
+    }
+
+    /**
+     * Producer: stage one record, publishing a batch when the stage fills.
+     */
+    void append(const MarketDataPoint& dp) {
+        stage_[staged_++] = dp;
+        if (staged_ == stage_.size()) {
+            flush();
+        }
+    }
+
+    void append(const MarketDataPoint* items, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            append(items[i]);
+        }
+    }
+
+    /**
+     * Producer: hand the staged records to the sender thread.
+     */
+    void flush() {
+        if (staged_ == 0) {
+            return;
+        }
+        size_t pushed = 0;
+        backoff_.reset();
+        while (pushed < staged_) {
+            size_t n = queue_.try_push_bulk(stage_.data() + pushed, staged_ - pushed);
+            if (n > 0) {
+                pushed += n;
+                signal_.notify();
+                backoff_.reset();
+            } else if (options_.drop_on_full) {
+                queue_drops_.store(queue_drops_.load(std::memory_order_relaxed) + (staged_ - pushed),
+                                   std::memory_order_relaxed);
+                break;
+            } else {
+                backoff_.pause();
+            }
+        }
+        staged_ = 0;
+    }
+
+    /**
+     * Progress counters (relaxed, readable from any thread).
+     */
+    uint64_t records_sent() const { return records_sent_.load(std::memory_order_relaxed); }
+    uint64_t datagrams_sent() const { return datagrams_sent_.load(std::memory_order_relaxed); }
+    uint64_t send_errors() const { return send_errors_.load(std::memory_order_relaxed); }
+    uint64_t records_dropped() const { return queue_drops_.load(std::memory_order_relaxed); }
+
+    size_t records_per_datagram() const { return per_datagram_; }
+    const MulticastOptions& network() const { return options_.network; }
+
+    std::vector<PlacementLog::Entry> thread_placements() const { return placements_.entries(); }
+
+private:
+    static constexpr size_t STAGE_RECORDS = 64;
+
+    void SendLoop() {
+        size_t capacity = per_datagram_ * options_.batch_datagrams;
+        std::vector<MarketDataPoint> records(capacity);
+        headers_.resize(options_.batch_datagrams);
+        iov_.resize(2 * options_.batch_datagrams);
+        messages_.resize(options_.batch_datagrams);
+
+        BlockingWait wait(signal_, 1000, options_.heartbeat);
+        auto last_send = std::chrono::steady_clock::now();
+        while (true) {
+            size_t popped = queue_.try_pop_bulk(records.data(), records.size());
+            if (popped > 0) {
+                Send(records.data(), popped);
+                last_send = std::chrono::steady_clock::now();
+                wait.reset();
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire)) {
+                // The producer is done, so an empty queue stays empty
+                if (queue_.empty()) {
+                    break;
+                }
+                continue;
+            }
+            if (std::chrono::steady_clock::now() - last_send >= options_.heartbeat) {
+                Send(nullptr, 0);
+                last_send = std::chrono::steady_clock::now();
+            }
+            wait.idle([this] { return !queue_.empty() || stopping_.load(); });
+        }
+        Send(nullptr, 0);  // Final sequence, for tail gap detection
+    }
+
+    // One sendmmsg per batch_datagrams; count == 0 sends a heartbeat
+    void Send(MarketDataPoint* records, size_t count) {
+        size_t datagrams = count == 0 ? 1 : (count + per_datagram_ - 1) / per_datagram_;
+        int64_t now_ns = multicast_detail::system_now_ns();
+        for (size_t d = 0; d < datagrams; ++d) {
+            size_t first = d * per_datagram_;
+            size_t n = std::min(per_datagram_, count - first);
+            MulticastHeader& header = headers_[d];
+            header.magic = MULTICAST_MAGIC;
+            header.version = MULTICAST_VERSION;
+            header.count = static_cast<uint16_t>(n);
+            header.session = session_;
+            header.sequence = sequence_;
+            header.send_ns = now_ns;
+            sequence_ += n;
+
+            iov_[2 * d] = {&header, sizeof(header)};
+            iov_[2 * d + 1] = {records + first, n * sizeof(MarketDataPoint)};
+            msghdr& message = messages_[d].msg_hdr;
+            message = msghdr{};
+            message.msg_name = &destination_;
+            message.msg_namelen = sizeof(destination_);
+            message.msg_iov = &iov_[2 * d];
+            message.msg_iovlen = n > 0 ? 2 : 1;
+        }
+
+        size_t sent = 0;
+        while (sent < datagrams) {
+            int rc = ::sendmmsg(socket_->fd(), &messages_[sent], static_cast<unsigned>(datagrams - sent), 0);
+            if (rc < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                // Skip the rest of the batch; subscribers see the gap
+                send_errors_.store(send_errors_.load(std::memory_order_relaxed) + (datagrams - sent),
+                                   std::memory_order_relaxed);
+                break;
+            }
+            for (int i = 0; i < rc; ++i) {
+                records_sent_.store(records_sent_.load(std::memory_order_relaxed) + headers_[sent + static_cast<size_t>(i)].count,
+                                    std::memory_order_relaxed);
+            }
+            sent += static_cast<size_t>(rc);
+            datagrams_sent_.store(datagrams_sent_.load(std::memory_order_relaxed) + static_cast<uint64_t>(rc),
+                                  std::memory_order_relaxed);
+        }
+    }
+
+    Options options_;
+    size_t per_datagram_;
+    uint64_t session_;
+    SpscRingBuffer<MarketDataPoint> queue_;
+    QueueSignal signal_;
+    std::thread sender_;
+    std::atomic<bool> started_{false};
+    std::atomic<bool> stopping_{false};
+    PlacementLog placements_;
+
+    // Producer side
+    alignas(64) std::array<MarketDataPoint, STAGE_RECORDS> stage_;
+    size_t staged_ = 0;
+    Backoff backoff_;
+    std::atomic<uint64_t> queue_drops_{0};
+
+    // Sender side
+    alignas(64) std::unique_ptr<multicast_detail::UdpSocket> socket_;
+    sockaddr_in destination_{};
+    uint64_t sequence_ = 0;
+    std::vector<MulticastHeader> headers_;
+    std::vector<iovec> iov_;
+    std::vector<mmsghdr> messages_;
+    std::atomic<uint64_t> records_sent_{0};
+    std::atomic<uint64_t> datagrams_sent_{0};
+    std::atomic<uint64_t> send_errors_{0};
+};
+
+// Logged by the subscriber's receive thread for every sequence gap
+inline constexpr LogFormat MULTICAST_GAP_LOG{LogLevel::Warning,
+    "Multicast gap: expected sequence {}, got {} ({} records lost)"};
+
+/**
+ * BasicMulticastSubscriber - MarketDataSource fed by a MulticastPublisher
+ * in another process.
+ *
+ * A receive thread reads up to RECEIVE_BATCH datagrams per recvmmsg,
+ * checks each one's sequence against the next expected record and pushes
+ * its records into the local queue, where the usual consumers (or a
+ * ShardedPipeline) drain them. A jump in the sequence counts a gap and the
+ * records lost in it; records seen before (reordered or duplicated
+ * datagrams) are skipped. A new publisher session restarts the sequence.
+ * Like the live handler it never blocks: a full queue drops and counts an
+ * overrun. Instrument ids are published to GetInstruments() as they are
+ * first seen. The send -> enqueue latency of each datagram goes into the
+ * feed latency histogram.
+ *
+ * Runs until stopped. Start() ignores the request: what arrives is what
+ * the publisher fetched.
+ *
+ * Template parameters:
+ * - QueueT: Queue shared with consumers; the receive thread is the only
+ *   producer, so SpscRingBuffer works.
+ */
+template<typename QueueT>
+class BasicMulticastSubscriber : public MarketDataSource<QueueT> {
+public:
+    using DataQueue = QueueT;
+
+    // queue_size must be a power of 2
+    explicit BasicMulticastSubscriber(const MulticastOptions& network,
+                                      size_t queue_size = 1024 * 1024,
+                                      const MemoryOptions& queue_memory = {},
+                                      size_t instrument_capacity = 4096)
+        : network_(network),
+          per_datagram_(multicast_records_per_datagram(network.payload_bytes)),
+          data_queue_(std::make_unique<DataQueue>(queue_size, queue_memory)),
+          receive_metrics_(metrics_.register_thread()),
+          seen_(instrument_capacity) {
+        TscClock::instance();  // Calibrate now rather than on the first enqueue stamp
+    }
+
+    ~BasicMulticastSubscriber() override {
+        Stop();
+    }
+
+    BasicMulticastSubscriber(const BasicMulticastSubscriber&) = delete;
+    BasicMulticastSubscriber& operator=(const BasicMulticastSubscriber&) = delete;
+
+    /**
+     * Join the group and start the receive thread.
+     */
+    void Start(const SourceRequest& request) override {
+        (void)request;
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        if (is_running_.load()) {
+            ReportError("Multicast subscriber already running");
+            return;
+        }
+        try {
+            socket_ = multicast_detail::open_receiver(network_, RECEIVE_TIMEOUT);
+        } catch (const std::exception& e) {
+            ReportError(std::string("Failed to join multicast feed: ") + e.what());
+            return;
+        }
+        metrics_.Reset();
+        placements_.clear();
+        synced_ = false;
+        stop_requested_ = false;
+        is_running_ = true;
+        receive_thread_ = std::thread([this] {
+            placements_.record("multicast receive", apply_thread_placement(receive_placement_));
+            ReceiveLoop();
+        });
+    }
+
+    /**
+     * Leave the group and join the receive thread.
+     */
+    void Stop() override {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        stop_requested_ = true;
+        if (receive_thread_.joinable()) {
+            receive_thread_.join();  // Reads time out, so this takes at most RECEIVE_TIMEOUT
+        }
+        socket_.reset();
+        is_running_ = false;
+    }
+
+    bool IsRunning() const override { return is_running_.load(); }
+
+    DataQueue& GetQueue() override { return *data_queue_; }
+    const PerformanceMetrics& GetMetrics() const override { return metrics_; }
+    const InstrumentUniverse& GetInstruments() const override { return instruments_; }
+    void SetConsumerSignal(QueueSignal* signal) override { consumer_signal_ = signal; }
+
+    void SetErrorCallback(std::function<void(const std::string&)> callback) override {
+        error_callback_ = callback;
+    }
+
+    void SetLogger(AsyncLogger* logger) override {
+        receive_log_ = logger ? &logger->register_thread("multicast receive") : nullptr;
+    }
+
+    /**
+     * Core and scheduling of the receive thread. Takes effect on the next
+     * Start().
+     */
+    void SetReceivePlacement(const ThreadPlacement& placement) { receive_placement_ = placement; }
+
+    std::vector<PlacementLog::Entry> GetThreadPlacements() const override { return placements_.entries(); }
+
+    /**
+     * Feed health (relaxed, readable from any thread).
+     */
+    uint64_t datagrams_received() const { return datagrams_.load(std::memory_order_relaxed); }
+    uint64_t gaps() const { return gaps_.load(std::memory_order_relaxed); }
+    uint64_t records_lost() const { return lost_.load(std::memory_order_relaxed); }
+    uint64_t duplicates() const { return duplicates_.load(std::memory_order_relaxed); }
+    uint64_t malformed() const { return malformed_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t RECEIVE_BATCH = 32;
+    static constexpr std::chrono::milliseconds RECEIVE_TIMEOUT{100};
+
+    void ReceiveLoop() {
+        size_t datagram_bytes = sizeof(MulticastHeader) + per_datagram_ * sizeof(MarketDataPoint);
+        // One slot per datagram, with room to spare so an oversized one shows as malformed
+        size_t slot_records = (datagram_bytes + sizeof(MarketDataPoint) - 1) / sizeof(MarketDataPoint) + 1;
+        std::vector<MarketDataPoint> buffer(RECEIVE_BATCH * slot_records);
+        std::array<iovec, RECEIVE_BATCH> iov;
+        std::array<mmsghdr, RECEIVE_BATCH> messages;
+        for (size_t i = 0; i < RECEIVE_BATCH; ++i) {
+            iov[i] = {&buffer[i * slot_records], slot_records * sizeof(MarketDataPoint)};
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_iov = &iov[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        while (!stop_requested_.load(std::memory_order_relaxed)) {
+            int rc = ::recvmmsg(socket_->fd(), messages.data(), RECEIVE_BATCH, MSG_WAITFORONE, nullptr);
+            if (rc < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    ReportError(multicast_detail::socket_error("receive").what());
+                    std::this_thread::sleep_for(RECEIVE_TIMEOUT);
+                }
+                continue;
+            }
+            int64_t now_ns = multicast_detail::system_now_ns();
+            for (int i = 0; i < rc; ++i) {
+                auto* data = reinterpret_cast<uint8_t*>(&buffer[static_cast<size_t>(i) * slot_records]);
+                OnDatagram(data, messages[static_cast<size_t>(i)].msg_len, now_ns);
+            }
+        }
+    }
+
+    void OnDatagram(uint8_t* data, size_t bytes, int64_t now_ns) {
+        MulticastHeader header;
+        if (bytes < sizeof(header)) {
+            malformed_.store(malformed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != MULTICAST_MAGIC || header.version != MULTICAST_VERSION ||
+            bytes != sizeof(header) + size_t{header.count} * sizeof(MarketDataPoint)) {
+            malformed_.store(malformed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        datagrams_.store(datagrams_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        if (!synced_ || header.session != session_) {
+            // First datagram of a session: nothing before it counts as lost
+            synced_ = true;
+            session_ = header.session;
+            expected_ = header.sequence;
+        }
+        uint64_t first = header.sequence;
+        uint64_t end = header.sequence + header.count;
+        if (end <= expected_ && header.count > 0) {
+            duplicates_.store(duplicates_.load(std::memory_order_relaxed) + header.count, std::memory_order_relaxed);
+            return;
+        }
+        if (first > expected_) {
+            uint64_t lost = first - expected_;
+            gaps_.store(gaps_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            lost_.store(lost_.load(std::memory_order_relaxed) + lost, std::memory_order_relaxed);
+            ReportGap(expected_, first, lost);
+        }
+        size_t skip = first < expected_ ? static_cast<size_t>(expected_ - first) : 0;  // Partly seen
+        expected_ = std::max(expected_, end);
+        if (header.count == 0) {
+            return;  // Heartbeat
+        }
+
+        // MarketDataPoint is packed, so records are read in place after the header
+        auto* records = reinterpret_cast<MarketDataPoint*>(data + sizeof(header)) + skip;
+        size_t count = header.count - skip;
+        Publish(records, count, now_ns - header.send_ns);
+    }
+
+    void Publish(MarketDataPoint* records, size_t count, int64_t transit_ns) {
+        ThreadMetrics& metrics = receive_metrics_;  // Receive thread is the only writer
+        for (size_t i = 0; i < count; ++i) {
+            if (seen_.find(records[i].instrument_id) == InstrumentTable<char>::NOT_FOUND) {
+                AddInstrument(records[i].instrument_id);
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        stamp_enqueue(records, count);
+        size_t pushed = data_queue_->try_push_bulk(records, count);
+        metrics.messages_received.add(pushed);  // Published records only; drops are overruns
+        if (pushed < count) {
+            uint64_t before = metrics.buffer_overruns.load();
+            metrics.buffer_overruns.add(count - pushed);
+            if ((before + 999) / 1000 != (before + (count - pushed) + 999) / 1000) {
+                ReportOverrun();
+            }
+        }
+        if (pushed > 0 && consumer_signal_) {
+            consumer_signal_->notify();
+        }
+        auto push_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        metrics.total_latency_ns.add(push_ns);
+        metrics.max_latency_ns.raise(push_ns);
+        metrics.push_latency.record(push_ns);
+        if (transit_ns > 0) {
+            metrics.feed_latency.record(static_cast<uint64_t>(transit_ns));
+        }
+    }
+
+    // Cold: once per instrument
+    __attribute__((noinline)) void AddInstrument(int32_t instrument_id) {
+        if (!seen_.find_or_add(instrument_id)) {
+            return;  // Table full; consumers add it on first sight anyway
+        }
+        auto id = static_cast<uint32_t>(instrument_id);
+        mapped_ids_.insert(std::lower_bound(mapped_ids_.begin(), mapped_ids_.end(), id), id);
+        instruments_.Publish(mapped_ids_);
+    }
+
+    void ReportGap(uint64_t expected, uint64_t got, uint64_t lost) {
+        if (receive_log_) {
+            receive_log_->log(MULTICAST_GAP_LOG, expected, got, lost);
+        } else {
+            std::ostringstream oss;
+            oss << "Multicast gap: expected sequence " << expected << ", got " << got
+                << " (" << lost << " records lost)";
+            ReportError(oss.str());
+        }
+    }
+
+    void ReportOverrun() {
+        if (receive_log_) {
+            receive_log_->log(QUEUE_OVERRUN_LOG, data_queue_->utilization() * 100.0);
+        } else {
+            std::ostringstream oss;
+            oss << "Queue overrun detected. Queue utilization: " << data_queue_->utilization() * 100.0 << "%";
+            ReportError(oss.str());
+        }
+    }
+
+    void ReportError(const std::string& message) {
+        if (error_callback_) {
+            error_callback_(message);
+        }
+    }
+
+    MulticastOptions network_;
+    size_t per_datagram_;
+    std::unique_ptr<DataQueue> data_queue_;
+    PerformanceMetrics metrics_;
+    ThreadMetrics& receive_metrics_;
+    InstrumentUniverse instruments_;
+    std::function<void(const std::string&)> error_callback_;
+    QueueSignal* consumer_signal_ = nullptr;
+    LogChannel* receive_log_ = nullptr;
+    ThreadPlacement receive_placement_;
+    PlacementLog placements_;
+
+    std::unique_ptr<multicast_detail::UdpSocket> socket_;
+    std::thread receive_thread_;
+    std::mutex session_mutex_;   // Start/Stop
+    std::atomic<bool> is_running_{false};
+    std::atomic<bool> stop_requested_{false};
+
+    // Receive thread only
+    bool synced_ = false;
+    uint64_t session_ = 0;
+    uint64_t expected_ = 0;      // Sequence of the next record
+    InstrumentTable<char> seen_;
+    std::vector<uint32_t> mapped_ids_;   // Sorted
+    std::atomic<uint64_t> datagrams_{0};
+    std::atomic<uint64_t> gaps_{0};
+    std::atomic<uint64_t> lost_{0};
+    std::atomic<uint64_t> duplicates_{0};
+    std::atomic<uint64_t> malformed_{0};
+};
+
+// Subscriber used by the engine; queue policy is selected in Config.hpp
+using MulticastSubscriber = BasicMulticastSubscriber<EngineDataQueue>;
+
+} // namespace market_data
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Types.hpp"
+#include <databento/enums.hpp>
+#include <databento/record.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace market_data {
+
+/**
+ * Conversion of DBN records into MarketDataPoint events, shared by the
+ * historical and live handlers.
+ *
+ * One record can produce several events (an MBP-1 trade is a trade print
+ * plus the resulting quote, an MBP-10 book change is one event per level
+ * it may have shifted). Decoders hand each event to emit(fill), where fill
+ * writes the event into whatever slot the caller chose - a staging batch
+ * or a claimed queue slot - so nothing is decoded twice or copied.
+ */
+
+inline constexpr int64_t UNDEF_PRICE = 9223372036854775807LL;  // INT64_MAX
+
+/**
+ * Convert a DBN fixed-point price to the engine's Price (0 when
+ * undefined). With FIXED_POINT_PRICES this is a plain copy, otherwise a
+ * divide by PRICE_SCALE.
+ */
+inline Price decode_price(int64_t fixed_price) {
+    if (fixed_price == UNDEF_PRICE) {
+        return 0;  // Undefined price
+    }
+    if constexpr (config::FIXED_POINT_PRICES) {
+        return fixed_price;
+    } else {
+        return static_cast<double>(fixed_price) / PRICE_SCALE;
+    }
+}
+
+/**
+ * ts_recv of any market record, in nanoseconds since UNIX epoch.
+ */
+template<typename Msg>
+inline int64_t record_ts_recv(const Msg& msg) {
+    return static_cast<int64_t>(msg.ts_recv.time_since_epoch().count());
+}
+
+/**
+ * Top of book from any record with ts_recv and levels[0] (BBO, MBP-1,
+ * MBP-10).
+ */
+template<typename Msg>
+inline void decode_top_of_book(const Msg& msg, MarketDataPoint& data_point) {
+    data_point.timestamp_delta = record_ts_recv(msg);
+    data_point.instrument_id = static_cast<int32_t>(msg.hd.instrument_id);
+    data_point.bid_px = decode_price(msg.levels[0].bid_px);
+    data_point.ask_px = decode_price(msg.levels[0].ask_px);
+    data_point.bid_sz = msg.levels[0].bid_sz;
+    data_point.ask_sz = msg.levels[0].ask_sz;
+    data_point.type = EventType::Quote;
+    data_point.side = 'N';
+    data_point.level = 0;
+    data_point.flags = msg.flags;
+}
+
+/**
+ * The trade print carried by a trades / MBP record (price, size, side).
+ */
+template<typename Msg>
+inline void decode_trade(const Msg& msg, MarketDataPoint& data_point) {
+    data_point.timestamp_delta = record_ts_recv(msg);
+    data_point.instrument_id = static_cast<int32_t>(msg.hd.instrument_id);
+    data_point.bid_px = decode_price(msg.price);
+    data_point.ask_px = 0;
+    data_point.bid_sz = msg.size;
+    data_point.ask_sz = 0;
+    data_point.type = EventType::Trade;
+    data_point.side = static_cast<char>(msg.side);
+    data_point.level = 0;
+    data_point.flags = msg.flags;
+}
+
+/**
+ * One depth level of an MBP-10 record.
+ */
+inline void decode_book_level(const databento::Mbp10Msg& msg, size_t level, MarketDataPoint& data_point) {
+    data_point.timestamp_delta = record_ts_recv(msg);
+    data_point.instrument_id = static_cast<int32_t>(msg.hd.instrument_id);
+    data_point.bid_px = decode_price(msg.levels[level].bid_px);
+    data_point.ask_px = decode_price(msg.levels[level].ask_px);
+    data_point.bid_sz = msg.levels[level].bid_sz;
+    data_point.ask_sz = msg.levels[level].ask_sz;
+    data_point.type = EventType::BookLevel;
+    data_point.side = static_cast<char>(msg.side);
+    data_point.level = static_cast<uint8_t>(level);
+    data_point.flags = msg.flags;
+}
+
+/**
+ * BBO-1s / BBO-1m: one quote per interval.
+ */
+template<typename Emit>
+inline void decode_events(const databento::BboMsg& msg, Emit&& emit) {
+    emit([&msg](MarketDataPoint& dp) { decode_top_of_book(msg, dp); });
+}
+
+/**
+ * Trades: one print per record.
+ */
+template<typename Emit>
+inline void decode_events(const databento::TradeMsg& msg, Emit&& emit) {
+    emit([&msg](MarketDataPoint& dp) { decode_trade(msg, dp); });
+}
+
+/**
+ * MBP-1: the trade print for trade actions, then the top of book.
+ */
+template<typename Emit>
+inline void decode_events(const databento::Mbp1Msg& msg, Emit&& emit) {
+    if (msg.action == databento::Action::Trade) {
+        emit([&msg](MarketDataPoint& dp) { decode_trade(msg, dp); });
+    }
+    emit([&msg](MarketDataPoint& dp) { decode_top_of_book(msg, dp); });
+}
+
+/**
+ * MBP-10: trade actions give a print (the book changes on the following
+ * record). Any other action changes the book at `depth`, which can shift
+ * every level below it, so levels depth..9 are emitted; a clear emits all.
+ */
+template<typename Emit>
+inline void decode_events(const databento::Mbp10Msg& msg, Emit&& emit) {
+    if (msg.action == databento::Action::Trade) {
+        emit([&msg](MarketDataPoint& dp) { decode_trade(msg, dp); });
+        return;
+    }
+    size_t first = msg.action == databento::Action::Clear ? 0 : msg.depth;
+    for (size_t level = first; level < msg.levels.size(); ++level) {
+        emit([&msg, level](MarketDataPoint& dp) { decode_book_level(msg, level, dp); });
+    }
+}
+
+/**
+ * Call visit(msg) with the typed message for the schemas the engine
+ * understands (BBO, trades, MBP-1, MBP-10). Returns false for anything
+ * else (symbol mappings, system and error messages, ...).
+ */
+template<typename Visit>
+inline bool visit_market_record(const databento::Record& record, Visit&& visit) {
+    if (auto* bbo = record.GetIf<databento::BboMsg>()) {
+        visit(*bbo);
+    } else if (auto* mbp1 = record.GetIf<databento::Mbp1Msg>()) {
+        visit(*mbp1);
+    } else if (auto* mbp10 = record.GetIf<databento::Mbp10Msg>()) {
+        visit(*mbp10);
+    } else if (auto* trade = record.GetIf<databento::TradeMsg>()) {
+        visit(*trade);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Schema names accepted by the handlers.
+ */
+inline bool parse_schema(const std::string& name, databento::Schema& schema) {
+    if (name == "bbo-1s") {
+        schema = databento::Schema::Bbo1S;
+    } else if (name == "bbo-1m") {
+        schema = databento::Schema::Bbo1M;
+    } else if (name == "trades") {
+        schema = databento::Schema::Trades;
+    } else if (name == "mbp-1") {
+        schema = databento::Schema::Mbp1;
+    } else if (name == "mbp-10") {
+        schema = databento::Schema::Mbp10;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace market_data
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "Types.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * FetchWatermark - progress of the concurrent producers of a chunked fetch.
+ *
+ * Each chunk owns a lane holding the timestamp of the last record it
+ * published (initially the chunk's start), and its records are published
+ * in timestamp order. Every record not yet in the queue therefore has a
+ * timestamp >= current(), the minimum over unfinished lanes, which is what
+ * lets a consumer reorder with a bounded buffer.
+ *
+ * Inactive (no lanes) for single-producer fetches, consumers then pass
+ * records straight through.
+ */
+class FetchWatermark {
+public:
+    explicit FetchWatermark(size_t max_lanes = 256)
+        : lanes_(std::make_unique<Lane[]>(max_lanes)), max_lanes_(max_lanes) {}
+
+    /**
+     * Arm the watermark for a new fetch (not concurrent with advance()).
+     * starts[i] is the first timestamp chunk i can produce.
+     */
+    void begin(const std::vector<int64_t>& starts) {
+        if (starts.size() > max_lanes_) {
+            throw std::invalid_argument("Too many fetch chunks for the watermark");
+        }
+        active_lanes_.store(0, std::memory_order_release);
+        for (size_t i = 0; i < starts.size(); ++i) {
+            lanes_[i].timestamp.store(starts[i], std::memory_order_relaxed);
+            lanes_[i].done.store(false, std::memory_order_relaxed);
+        }
+        active_lanes_.store(starts.size(), std::memory_order_release);
+    }
+
+    /**
+     * Disarm after a single-producer fetch.
+     */
+    void clear() { active_lanes_.store(0, std::memory_order_release); }
+
+    /**
+     * Producer side: records up to timestamp have been published.
+     * Call after the push so a consumer that sees the new value also sees
+     * the records.
+     */
+    void advance(size_t lane, int64_t timestamp) {
+        lanes_[lane].timestamp.store(timestamp, std::memory_order_release);
+    }
+
+    /**
+     * Producer side: the chunk will publish nothing more.
+     */
+    void finish(size_t lane) {
+        lanes_[lane].done.store(true, std::memory_order_release);
+    }
+
+    bool active() const { return active_lanes_.load(std::memory_order_acquire) > 0; }
+
+    /**
+     * Lowest timestamp an unpublished record can still have;
+     * INT64_MAX once every chunk has finished.
+     */
+    int64_t current() const {
+        size_t lanes = active_lanes_.load(std::memory_order_acquire);
+        int64_t low = INT64_MAX;
+        for (size_t i = 0; i < lanes; ++i) {
+            if (!lanes_[i].done.load(std::memory_order_acquire)) {
+                low = std::min(low, lanes_[i].timestamp.load(std::memory_order_acquire));
+            }
+        }
+        return low;
+    }
+
+private:
+    struct alignas(64) Lane {
+        std::atomic<int64_t> timestamp{0};
+        std::atomic<bool> done{true};
+    };
+
+    std::unique_ptr<Lane[]> lanes_;
+    size_t max_lanes_;
+    std::atomic<size_t> active_lanes_{0};
+};
+
+/**
+ * ReorderBuffer - restores timestamp order behind a chunked fetch.
+ *
+ * pump() reads the watermark, drains the queue into a min-heap keyed by
+ * (timestamp, arrival), then releases every held record older than the
+ * watermark. Reading the watermark before draining is what makes this
+ * exact: anything published before that read is in the queue we drain.
+ * Ties keep arrival order, so records of one chunk never swap.
+ *
+ * Memory is bounded by how far the in-flight chunks run ahead of the
+ * oldest one, roughly parallelism chunks' worth of records. Single
+ * consumer only.
+ */
+class ReorderBuffer {
+public:
+    explicit ReorderBuffer(size_t batch_size = 256, size_t reserve = 64 * 1024)
+        : batch_(batch_size == 0 ? 1 : batch_size) {
+        heap_.reserve(reserve);
+    }
+
+    /**
+     * Drain queue, then hand records in timestamp order to sink(point).
+     * Returns the number of records popped from the queue.
+     */
+    template<typename Queue, typename Sink>
+    size_t pump(Queue& queue, const FetchWatermark& watermark, Sink&& sink) {
+        int64_t limit = watermark.current();
+
+        size_t total = 0;
+        while (true) {
+            size_t popped = queue.try_pop_bulk(batch_.data(), batch_.size());
+            for (size_t i = 0; i < popped; ++i) {
+                heap_.push_back({batch_[i], next_sequence_++});
+                std::push_heap(heap_.begin(), heap_.end(), Later{});
+            }
+            total += popped;
+            if (popped < batch_.size()) {
+                break;  // Short pop: the queue was empty at that point
+            }
+        }
+
+        while (!heap_.empty() && (limit == INT64_MAX || heap_.front().point.timestamp_delta < limit)) {
+            std::pop_heap(heap_.begin(), heap_.end(), Later{});
+            sink(heap_.back().point);
+            heap_.pop_back();
+        }
+        return total;
+    }
+
+    /**
+     * Release everything still held, in order (e.g. on shutdown).
+     */
+    template<typename Sink>
+    void flush(Sink&& sink) {
+        while (!heap_.empty()) {
+            std::pop_heap(heap_.begin(), heap_.end(), Later{});
+            sink(heap_.back().point);
+            heap_.pop_back();
+        }
+    }
+
+    size_t pending() const { return heap_.size(); }
+
+private:
+    struct Held {
+        MarketDataPoint point;
+        uint64_t sequence;
+    };
+
+    // std heaps are max-heaps, so "greater" puts the oldest record on top
+    struct Later {
+        bool operator()(const Held& a, const Held& b) const {
+            if (a.point.timestamp_delta != b.point.timestamp_delta) {
+                return a.point.timestamp_delta > b.point.timestamp_delta;
+            }
+            return a.sequence > b.sequence;
+        }
+    };
+
+    std::vector<MarketDataPoint> batch_;
+    std::vector<Held> heap_;
+    uint64_t next_sequence_ = 0;
+};
+
+} // namespace market_data
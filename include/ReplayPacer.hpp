@@ -0,0 +1,134 @@
+#pragma once
+
+#include "TscClock.hpp"
+#include "WaitStrategy.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace market_data {
+
+/**
+ * ReplayPacer - releases historical records on their original schedule.
+ *
+ * The first record paced after reset() anchors the replay: a record with
+ * timestamp ts is due (ts - first_ts) / speed nanoseconds after that. So
+ * speed 1 reproduces the recorded inter-arrival times and bursts, speed N
+ * compresses them N times, and speed 0 disables pacing (max speed).
+ *
+ * Waiting sleeps while the record is far off and spins on the TSC for the
+ * last SPIN_WINDOW, so releases land within a microsecond or so of their
+ * schedule without burning a core through long gaps. The anchor is shared,
+ * so several producers (chunk workers) can pace against the same clock.
+ */
+class ReplayPacer {
+public:
+    static constexpr int64_t SPIN_WINDOW_NS = 200000;       // Spin for the last 200 us
+    static constexpr int64_t MAX_SLEEP_NS = 10000000;       // Re-check stop every 10 ms
+
+    explicit ReplayPacer(double speed = 0.0) { set_speed(speed); }
+
+    /**
+     * 0 (or negative) = as fast as possible. Not concurrent with pacing.
+     */
+    void set_speed(double speed) { speed_ = speed > 0.0 ? speed : 0.0; }
+
+    double speed() const { return speed_; }
+
+    bool active() const { return speed_ > 0.0; }
+
+    /**
+     * Forget the anchor so the next record starts a new replay.
+     */
+    void reset() { anchor_ts_.store(UNANCHORED, std::memory_order_relaxed); }
+
+    /**
+     * Anchor explicitly, e.g. at the start of a chunked fetch so that
+     * chunks fetched out of order still share one schedule.
+     */
+    void anchor_at(int64_t ts) {
+        std::lock_guard<std::mutex> lock(anchor_mutex_);
+        anchor_wall_.store(TscClock::instance().now_ns(), std::memory_order_relaxed);
+        anchor_ts_.store(ts, std::memory_order_release);
+    }
+
+    /**
+     * Block until the record with timestamp ts is due (or stop is set).
+     * Returns how late the caller already was, in ns (0 if on time).
+     */
+    int64_t wait_until(int64_t ts, const std::atomic<bool>& stop) {
+        const TscClock& clock = TscClock::instance();
+        int64_t due = due_ns(ts);
+        int64_t now = clock.now_ns();
+        if (now >= due) {
+            return now - due;
+        }
+        while (!stop.load(std::memory_order_relaxed)) {
+            int64_t remaining = due - now;
+            if (remaining <= 0) {
+                break;
+            }
+            if (remaining > SPIN_WINDOW_NS) {
+                int64_t sleep = remaining - SPIN_WINDOW_NS;
+                std::this_thread::sleep_for(std::chrono::nanoseconds(sleep < MAX_SLEEP_NS ? sleep : MAX_SLEEP_NS));
+            } else {
+                cpu_relax();
+            }
+            now = clock.now_ns();
+        }
+        return 0;
+    }
+
+    /**
+     * Nanoseconds until a record is due (negative once overdue). Anchors
+     * the replay on first use.
+     */
+    int64_t due_in_ns(int64_t ts) {
+        return due_ns(ts) - TscClock::instance().now_ns();
+    }
+
+    /**
+     * Consumer side: how far behind schedule a record is being processed,
+     * i.e. now minus its release time. 0 when not pacing or not anchored.
+     */
+    int64_t lag_ns(int64_t ts) const {
+        int64_t anchor_ts = anchor_ts_.load(std::memory_order_acquire);
+        if (!active() || anchor_ts == UNANCHORED) {
+            return 0;
+        }
+        int64_t due = anchor_wall_.load(std::memory_order_relaxed) + scaled(ts - anchor_ts);
+        return TscClock::instance().now_ns() - due;
+    }
+
+private:
+    static constexpr int64_t UNANCHORED = std::numeric_limits<int64_t>::min();
+
+    int64_t scaled(int64_t delta) const {
+        return static_cast<int64_t>(static_cast<double>(delta) / speed_);
+    }
+
+    int64_t due_ns(int64_t ts) {
+        int64_t anchor_ts = anchor_ts_.load(std::memory_order_acquire);
+        if (anchor_ts == UNANCHORED) {
+            // First record anywhere anchors the replay (cold, once per fetch)
+            std::lock_guard<std::mutex> lock(anchor_mutex_);
+            anchor_ts = anchor_ts_.load(std::memory_order_relaxed);
+            if (anchor_ts == UNANCHORED) {
+                anchor_wall_.store(TscClock::instance().now_ns(), std::memory_order_relaxed);
+                anchor_ts_.store(ts, std::memory_order_release);
+                anchor_ts = ts;
+            }
+        }
+        return anchor_wall_.load(std::memory_order_relaxed) + scaled(ts - anchor_ts);
+    }
+
+    double speed_ = 0.0;
+    std::atomic<int64_t> anchor_ts_{UNANCHORED};
+    std::atomic<int64_t> anchor_wall_{0};
+    std::mutex anchor_mutex_;
+};
+
+} // namespace market_data
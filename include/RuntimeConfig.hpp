@@ -0,0 +1,416 @@
+#pragma once
+
+#include "Config.hpp"
+#include "FetchPlanner.hpp"
+#include "MarketDataSource.hpp"
+#include "RecordDecoder.hpp"
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * One historical fetch of a job list.
+ */
+struct FetchJob {
+    std::string name;
+    SourceRequest request;
+};
+
+/**
+ * EngineSettings - what the engine runs, chosen at startup.
+ *
+ * Defaults are the Config.hpp constants; a settings file and then the
+ * command line override them (see load_settings()). What selects types or
+ * layouts (queue policy, price representation, compact encoding, ...)
+ * stays compile-time in Config.hpp.
+ */
+struct EngineSettings {
+    size_t queue_size = config::QUEUE_SIZE;
+    bool live = config::USE_LIVE_FEED;
+    std::string live_schema = config::LIVE_SCHEMA;
+    std::vector<FetchJob> jobs;                   // Historical fetches, in start order
+    size_t job_workers = config::JOB_WORKERS;     // Handlers (each with its own queue) running jobs
+    int fetch_timeout_seconds = config::FETCH_TIMEOUT_SECONDS;  // Per job
+    std::string dbn_cache_directory = config::DBN_CACHE_DIRECTORY;
+    double replay_speed = config::REPLAY_SPEED;
+    FetchPlanOptions fetch_plan{config::FETCH_TIME_SLICES, config::FETCH_SYMBOL_GROUPS, config::FETCH_PARALLELISM};
+    std::string capture_path = config::CAPTURE_PATH;
+    int metrics_http_port = config::METRICS_HTTP_PORT;
+    std::string metrics_shared_name = config::METRICS_SHARED_NAME;
+    int metrics_interval_ms = config::METRICS_EXPORT_INTERVAL_MS;
+    bool help = false;                            // --help was given
+};
+
+namespace settings_detail {
+
+inline std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+inline std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item = trim(item);
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+inline size_t parse_size(const std::string& key, const std::string& value) {
+    size_t used = 0;
+    unsigned long long parsed = 0;
+    try {
+        parsed = std::stoull(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used != value.size() || value.empty() || value[0] == '-') {
+        throw std::invalid_argument(key + " expects a non-negative integer, got '" + value + "'");
+    }
+    return static_cast<size_t>(parsed);
+}
+
+// Non-negative integer setting stored as int
+inline int parse_int(const std::string& key, const std::string& value) {
+    size_t parsed = parse_size(key, value);
+    if (parsed > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::invalid_argument(key + " must be at most " + std::to_string(std::numeric_limits<int>::max()) +
+                                    ", got " + value);
+    }
+    return static_cast<int>(parsed);
+}
+
+inline double parse_double(const std::string& key, const std::string& value) {
+    size_t used = 0;
+    double parsed = 0.0;
+    try {
+        parsed = std::stod(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used != value.size() || value.empty()) {
+        throw std::invalid_argument(key + " expects a number, got '" + value + "'");
+    }
+    return parsed;
+}
+
+inline bool parse_bool(const std::string& key, const std::string& value) {
+    if (value == "true" || value == "1" || value == "yes" || value == "on") {
+        return true;
+    }
+    if (value == "false" || value == "0" || value == "no" || value == "off") {
+        return false;
+    }
+    throw std::invalid_argument(key + " expects true or false, got '" + value + "'");
+}
+
+// Keys of a job; top-level values are the defaults of every job
+inline bool is_job_key(const std::string& key) {
+    return key == "dataset" || key == "symbols" || key == "schema" || key == "start" || key == "end";
+}
+
+inline void apply_job_key(FetchJob& job, const std::string& key, const std::string& value) {
+    SourceRequest& request = job.request;
+    if (key == "dataset") {
+        request.dataset = value;
+    } else if (key == "symbols") {
+        request.symbols = split_list(value);
+    } else if (key == "schema") {
+        databento::Schema schema;
+        if (!parse_schema(value, schema)) {
+            throw std::invalid_argument("Unsupported schema '" + value + "'");
+        }
+        request.schema = value;
+    } else if (key == "start") {
+        parse_timestamp_ns(value);  // Validates
+        request.start_time = value;
+    } else if (key == "end") {
+        parse_timestamp_ns(value);
+        request.end_time = value;
+    }
+}
+
+inline void apply_engine_key(EngineSettings& settings, const std::string& key, const std::string& value) {
+    if (key == "queue_size") {
+        size_t size = parse_size(key, value);
+        if (size < 2 || (size & (size - 1)) != 0) {
+            throw std::invalid_argument("queue_size must be a power of 2, got " + value);
+        }
+        settings.queue_size = size;
+    } else if (key == "live") {
+        settings.live = parse_bool(key, value);
+    } else if (key == "live_schema") {
+        databento::Schema schema;
+        if (!parse_schema(value, schema)) {
+            throw std::invalid_argument("Unsupported schema '" + value + "'");
+        }
+        settings.live_schema = value;
+    } else if (key == "workers") {
+        settings.job_workers = parse_size(key, value);
+        if (settings.job_workers == 0) {
+            throw std::invalid_argument("workers must be at least 1");
+        }
+    } else if (key == "fetch_timeout_seconds") {
+        settings.fetch_timeout_seconds = parse_int(key, value);
+    } else if (key == "dbn_cache_directory") {
+        settings.dbn_cache_directory = value;
+    } else if (key == "replay_speed") {
+        settings.replay_speed = parse_double(key, value);
+        if (!(settings.replay_speed >= 0.0)) {
+            throw std::invalid_argument("replay_speed must not be negative, got " + value);
+        }
+    } else if (key == "fetch_time_slices") {
+        settings.fetch_plan.time_slices = parse_size(key, value);
+    } else if (key == "fetch_symbol_groups") {
+        settings.fetch_plan.symbol_groups = parse_size(key, value);
+    } else if (key == "fetch_parallelism") {
+        settings.fetch_plan.parallelism = parse_size(key, value);
+    } else if (key == "capture_path") {
+        settings.capture_path = value;
+    } else if (key == "metrics_http_port") {
+        settings.metrics_http_port = parse_int(key, value);
+        if (settings.metrics_http_port > 65535) {
+            throw std::invalid_argument("metrics_http_port must be at most 65535, got " + value);
+        }
+    } else if (key == "metrics_shared_name") {
+        settings.metrics_shared_name = value;
+    } else if (key == "metrics_interval_ms") {
+        settings.metrics_interval_ms = parse_int(key, value);
+        if (settings.metrics_interval_ms == 0) {
+            throw std::invalid_argument("metrics_interval_ms must be positive");
+        }
+    } else {
+        throw std::invalid_argument("Unknown setting '" + key + "'");
+    }
+}
+
+/**
+ * Collects settings in the order they are given and builds the job list
+ * once everything is read.
+ */
+class SettingsBuilder {
+public:
+    SettingsBuilder() {
+        defaults_.request.dataset = config::DATASET;
+        defaults_.request.symbols = config::SYMBOLS;
+        defaults_.request.start_time = config::START_TIME;
+        defaults_.request.end_time = config::END_TIME;
+        defaults_.request.schema = config::SCHEMA;
+    }
+
+    // job empty = top level
+    void set(const std::string& job, const std::string& key, const std::string& value) {
+        if (job.empty()) {
+            if (is_job_key(key)) {
+                apply_job_key(defaults_, key, value);
+            } else {
+                apply_engine_key(settings_, key, value);
+            }
+            return;
+        }
+        if (!is_job_key(key)) {
+            throw std::invalid_argument("'" + key + "' is not a job setting");
+        }
+        job_values_[job_index(job)].emplace_back(key, value);
+    }
+
+    void begin_job(const std::string& name) {
+        if (name.empty()) {
+            throw std::invalid_argument("Job section needs a name: [job NAME]");
+        }
+        if (job_lookup_.count(name)) {
+            throw std::invalid_argument("Duplicate job '" + name + "'");
+        }
+        job_index(name);
+    }
+
+    void help() { settings_.help = true; }
+
+    // Jobs inherit every top-level job key, wherever it appeared
+    EngineSettings build() {
+        EngineSettings settings = settings_;
+        for (size_t i = 0; i < job_names_.size(); ++i) {
+            FetchJob job = defaults_;
+            job.name = job_names_[i];
+            for (const auto& [key, value] : job_values_[i]) {
+                apply_job_key(job, key, value);
+            }
+            settings.jobs.push_back(std::move(job));
+        }
+        if (settings.jobs.empty()) {
+            FetchJob job = defaults_;
+            job.name = "default";
+            settings.jobs.push_back(std::move(job));
+        }
+        for (const FetchJob& job : settings.jobs) {
+            if (job.request.symbols.empty()) {
+                throw std::invalid_argument("Job '" + job.name + "' has no symbols");
+            }
+            if (parse_timestamp_ns(job.request.end_time) <= parse_timestamp_ns(job.request.start_time)) {
+                throw std::invalid_argument("Job '" + job.name + "' ends before it starts");
+            }
+        }
+        return settings;
+    }
+
+private:
+    size_t job_index(const std::string& name) {
+        auto it = job_lookup_.find(name);
+        if (it != job_lookup_.end()) {
+            return it->second;
+        }
+        job_lookup_[name] = job_names_.size();
+        job_names_.push_back(name);
+        job_values_.emplace_back();
+        return job_names_.size() - 1;
+    }
+
+    EngineSettings settings_;
+    FetchJob defaults_;
+    std::vector<std::string> job_names_;
+    std::map<std::string, size_t> job_lookup_;
+    std::vector<std::vector<std::pair<std::string, std::string>>> job_values_;
+};
+
+inline void read_settings_file(SettingsBuilder& builder, const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::invalid_argument("Cannot open settings file " + path);
+    }
+    std::string line;
+    std::string job;
+    size_t number = 0;
+    while (std::getline(file, line)) {
+        ++number;
+        try {
+            size_t comment = line.find('#');
+            line = trim(comment == std::string::npos ? line : line.substr(0, comment));
+            if (line.empty()) {
+                continue;
+            }
+            if (line.front() == '[') {
+                if (line.back() != ']' || line.compare(0, 4, "[job") != 0) {
+                    throw std::invalid_argument("Expected [job NAME], got " + line);
+                }
+                job = trim(line.substr(4, line.size() - 5));
+                builder.begin_job(job);
+                continue;
+            }
+            size_t equals = line.find('=');
+            if (equals == std::string::npos) {
+                throw std::invalid_argument("Expected key = value, got " + line);
+            }
+            builder.set(job, trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+        } catch (const std::invalid_argument& e) {
+            throw std::invalid_argument(path + ":" + std::to_string(number) + ": " + e.what());
+        }
+    }
+}
+
+} // namespace settings_detail
+
+/**
+ * Settings for this run: Config.hpp defaults, then the file given with
+ * --config (or -c), then the other options in order. Throws
+ * std::invalid_argument on an unknown key, a malformed value or an
+ * inconsistent job.
+ *
+ * The file holds "key = value" lines ('#' starts a comment) with the
+ * engine keys listed by settings_usage(), and optionally one section per
+ * job:
+ *
+ *     dataset = GLBX.MDP3
+ *     [job es-0610]
+ *     symbols = ES.FUT
+ *     start = 2022-06-10T14:30
+ *     end = 2022-06-10T14:35
+ *
+ * Job keys (dataset, symbols, schema, start, end) given at the top level
+ * or on the command line are the defaults of every job. Without job
+ * sections the defaults form the one job "default". Command-line options
+ * are "--key value" or "--key=value" with the same keys.
+ */
+inline EngineSettings load_settings(int argc, char** argv) {
+    settings_detail::SettingsBuilder builder;
+    std::vector<std::pair<std::string, std::string>> options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            builder.help();
+            continue;
+        }
+        if (arg.compare(0, 2, "--") != 0 && arg != "-c") {
+            throw std::invalid_argument("Unexpected argument '" + arg + "'");
+        }
+        std::string key = arg == "-c" ? "config" : arg.substr(2);
+        std::string value;
+        size_t equals = key.find('=');
+        if (equals != std::string::npos) {
+            value = key.substr(equals + 1);
+            key = key.substr(0, equals);
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            throw std::invalid_argument("Option --" + key + " needs a value");
+        }
+        for (char& c : key) {
+            c = c == '-' ? '_' : c;  // --queue-size == --queue_size
+        }
+        options.emplace_back(key, value);
+    }
+    // The file first, so the command line overrides it
+    for (const auto& [key, value] : options) {
+        if (key == "config") {
+            settings_detail::read_settings_file(builder, value);
+        }
+    }
+    for (const auto& [key, value] : options) {
+        if (key != "config") {
+            builder.set("", key, value);
+        }
+    }
+    return builder.build();
+}
+
+/**
+ * Help text for the command line.
+ */
+inline std::string settings_usage(const char* program) {
+    std::ostringstream oss;
+    oss << "Usage: " << program << " [--config FILE] [--KEY VALUE ...]\n"
+        << "\nJob keys (defaults of every job; per job in [job NAME] file sections):\n"
+        << "  dataset, symbols (comma separated), schema, start, end (ISO 8601, UTC)\n"
+        << "\nEngine keys:\n"
+        << "  queue_size             Engine queue slots per worker, power of 2\n"
+        << "  workers                Handlers, each with its own queue, running jobs concurrently\n"
+        << "  fetch_timeout_seconds  Stop a job that runs longer than this\n"
+        << "  dbn_cache_directory    DBN cache, empty = always download\n"
+        << "  replay_speed           1 = real time, N = N x faster, 0 = unpaced\n"
+        << "  fetch_time_slices, fetch_symbol_groups, fetch_parallelism\n"
+        << "                         Parallel fetch plan of each job\n"
+        << "  live, live_schema      Subscribe to the live gateway instead of running jobs\n"
+        << "  capture_path           Columnar capture of the processed stream, empty = off\n"
+        << "  metrics_http_port      Prometheus endpoint (GET /metrics), 0 = off\n"
+        << "  metrics_shared_name    Shared-memory metrics page, e.g. /mde_metrics, empty = off\n"
+        << "  metrics_interval_ms    Metrics sampling interval\n";
+    return oss.str();
+}
+
+} // namespace market_data
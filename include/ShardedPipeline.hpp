@@ -0,0 +1,399 @@
+#pragma once
+
+#include "Types.hpp"
+#include "CompactRingBuffer.hpp"
+#include "InstrumentTable.hpp"
+#include "ReorderBuffer.hpp"
+#include "SpscRingBuffer.hpp"
+#include "StreamTaps.hpp"
+#include "ThreadAffinity.hpp"
+#include "WaitStrategy.hpp"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * ShardedPipeline - fan-out stage that scales consumers past one core.
+ *
+ * A router thread drains the upstream queue and routes every record by
+ * instrument_id to one of K shard SPSC queues. Each shard is owned by one
+ * (optionally pinned) worker thread with its own InstrumentTable, so
+ * per-instrument ordering is preserved and no stats are shared between
+ * threads. While running, reports read each shard's counters
+ * (shard_metrics(), shard_instruments()); the full stats are merged once
+ * the workers have stopped, and since instruments are partitioned the
+ * merge is a plain union.
+ *
+ * The router never drops: a full shard queue back-pressures the router,
+ * which in turn back-pressures the upstream producer. Behind a chunked
+ * (multi-producer) fetch the router restores timestamp order with a
+ * ReorderBuffer before routing. The router also hands every routed record,
+ * in routing order, to the Options::taps that are set (capture, multicast).
+ *
+ * Template parameters:
+ * - UpstreamQueue: queue the handler publishes into (MPMC or SPSC)
+ */
+template<typename UpstreamQueue>
+class ShardedPipeline {
+public:
+    using StatsTable = InstrumentTable<InstrumentStats>;
+
+    struct Options {
+        size_t num_shards = 2;
+        size_t shard_queue_size = 64 * 1024;      // Per shard, power of 2
+        size_t batch_size = 256;                  // Records per bulk pop / push
+        std::vector<int> shard_cores;             // Core per shard, -1 / missing = unpinned
+        int router_core = -1;
+        int fifo_priority = 0;                    // SCHED_FIFO for the pinned threads, 0 = normal
+        WaitStrategyKind wait_strategy = WaitStrategyKind::SpinYield;
+        uint32_t spin_limit = 1000;
+        // numa_node -1 = put each shard queue on its worker core's node
+        // (the worker reads the slots; the router only writes them)
+        MemoryOptions queue_memory;
+        size_t instrument_capacity = 4096;        // Per shard
+        const InstrumentUniverse* instruments = nullptr;  // Preloads each shard's instruments
+        const FetchWatermark* watermark = nullptr;        // Set to reorder chunked fetches
+        StreamTaps taps;                                  // Copies of the routed stream
+    };
+
+    /**
+     * upstream_signal is the QueueSignal the upstream producer notifies, only
+     * needed when the router uses the blocking wait strategy.
+     */
+    ShardedPipeline(UpstreamQueue& upstream, PerformanceMetrics& metrics,
+                    QueueSignal& upstream_signal, const Options& options)
+        : upstream_(upstream), router_metrics_(metrics.register_thread()),
+          upstream_signal_(upstream_signal), options_(options) {
+        if (options_.num_shards == 0) {
+            throw std::invalid_argument("ShardedPipeline needs at least one shard");
+        }
+        if (options_.batch_size == 0) {
+            options_.batch_size = 1;
+        }
+        shards_.reserve(options_.num_shards);
+        for (size_t i = 0; i < options_.num_shards; ++i) {
+            MemoryOptions memory = options_.queue_memory;
+            if (memory.numa_node < 0) {
+                memory.numa_node = numa_node_of_core(shard_core(i));
+            }
+            shards_.push_back(std::make_unique<Shard>(options_.shard_queue_size, memory,
+                                                      options_.instrument_capacity, options_.instruments));
+            shards_.back()->stats.set_partition(static_cast<uint32_t>(i),
+                                                static_cast<uint32_t>(options_.num_shards));
+        }
+    }
+
+    ~ShardedPipeline() {
+        Stop();
+    }
+
+    ShardedPipeline(const ShardedPipeline&) = delete;
+    ShardedPipeline& operator=(const ShardedPipeline&) = delete;
+
+    /**
+     * Start the shard workers and the router.
+     */
+    void Start() {
+        if (running_.exchange(true)) {
+            return;
+        }
+        router_done_ = false;
+        placements_.clear();
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            ThreadPlacement placement{shard_core(i), options_.fifo_priority};
+            Shard& shard = *shards_[i];
+            with_wait_strategy(options_.wait_strategy, shard.signal, options_.spin_limit, [&](auto wait) {
+                shard.thread = std::thread([this, &shard, i, placement, wait]() mutable {
+                    PlacementStatus status = apply_thread_placement(placement);
+                    shard.pinned = status.pinned;
+                    placements_.record("shard " + std::to_string(i), status);
+                    WorkerLoop(shard, wait);
+                });
+            });
+        }
+        with_wait_strategy(options_.wait_strategy, upstream_signal_, options_.spin_limit, [&](auto wait) {
+            router_ = std::thread([this, wait]() mutable {
+                PlacementStatus status =
+                    apply_thread_placement({options_.router_core, options_.fifo_priority});
+                router_pinned_ = status.pinned;
+                placements_.record("router", status);
+                RouterLoop(wait);
+            });
+        });
+    }
+
+    /**
+     * Stop routing, let every worker drain its shard queue, and join.
+     */
+    void Stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        upstream_signal_.wake_all();
+        Join();
+    }
+
+    /**
+     * Wait for the end of the stream after the upstream queue was closed:
+     * the router routes the last record and exits, the workers drain
+     * their shards, and the stats are final as after Stop().
+     */
+    void Drain() {
+        if (!running_.load()) {
+            return;
+        }
+        upstream_signal_.wake_all();
+        Join();
+        running_ = false;
+    }
+
+    /**
+     * Merge per-shard stats into one report, keyed by instrument_id.
+     * Only after Drain() or Stop(): the workers own their tables while
+     * they run. Throws std::logic_error if the pipeline is running.
+     */
+    std::map<int, InstrumentStats> MergedStats() const {
+        if (running_.load()) {
+            throw std::logic_error("ShardedPipeline::MergedStats() while the workers run");
+        }
+        std::map<int, InstrumentStats> merged;
+        for (const auto& shard : shards_) {
+            shard->stats.for_each([&merged](int id, const InstrumentStats& stats) {
+                merged.emplace(id, stats);
+            });
+        }
+        return merged;
+    }
+
+    size_t num_shards() const { return shards_.size(); }
+
+    /**
+     * Records processed by a shard (relaxed, for reporting)
+     */
+    uint64_t shard_processed(size_t shard) const {
+        return shards_[shard]->metrics.messages_processed.load();
+    }
+
+    /**
+     * A shard worker's counters and latency histograms. Its queue latency
+     * runs from the producer's enqueue stamp, through the upstream queue
+     * and router, to the shard dequeue.
+     */
+    const ThreadMetrics& shard_metrics(size_t shard) const { return shards_[shard]->metrics; }
+
+    size_t shard_queue_size(size_t shard) const { return shards_[shard]->queue.size(); }
+
+    /**
+     * Records a shard worker processed per instrument, readable while it
+     * runs (relaxed, for live metrics).
+     */
+    const InstrumentCounters& shard_instruments(size_t shard) const { return shards_[shard]->instrument_counts; }
+
+    bool shard_pinned(size_t shard) const { return shards_[shard]->pinned.load(); }
+
+    bool router_pinned() const { return router_pinned_.load(); }
+
+    /**
+     * Placement of the router and shard workers, as each read it back
+     * when it started.
+     */
+    std::vector<PlacementLog::Entry> thread_placements() const { return placements_.entries(); }
+
+private:
+    int shard_core(size_t shard) const {
+        return shard < options_.shard_cores.size() ? options_.shard_cores[shard] : -1;
+    }
+
+    void Join() {
+        if (router_.joinable()) {
+            router_.join();
+        }
+        // Workers exit once the router is done and their queue is empty
+        router_done_ = true;
+        for (auto& shard : shards_) {
+            shard->signal.wake_all();
+        }
+        for (auto& shard : shards_) {
+            if (shard->thread.joinable()) {
+                shard->thread.join();
+            }
+        }
+    }
+
+    using ShardQueue = std::conditional_t<config::QUEUE_COMPACT, CompactRingBuffer, SpscRingBuffer<MarketDataPoint>>;
+
+    struct Shard {
+        Shard(size_t queue_size, const MemoryOptions& memory,
+              size_t instrument_capacity, const InstrumentUniverse* instruments)
+            : queue(queue_size, memory), stats(instrument_capacity, instruments),
+              instrument_counts(instrument_capacity) {}
+
+        ShardQueue queue;
+        QueueSignal signal;
+        std::thread thread;
+        std::atomic<bool> pinned{false};  // Set by the worker when it starts
+
+        // Owned by the worker thread
+        StatsTable stats;
+
+        // Written by the worker, read for reports
+        ThreadMetrics metrics;
+        InstrumentCounters instrument_counts;
+    };
+
+    size_t ShardOf(int32_t instrument_id) const {
+        return static_cast<uint32_t>(instrument_id) % shards_.size();
+    }
+
+    template<typename Wait>
+    void RouterLoop(Wait wait) {
+        std::vector<MarketDataPoint> batch(options_.batch_size);
+        // Per-shard staging so each shard gets one bulk push per batch
+        std::vector<std::vector<MarketDataPoint>> staged(shards_.size());
+        for (auto& s : staged) {
+            s.reserve(options_.batch_size);
+        }
+
+        ReorderBuffer reorder(options_.batch_size);
+        const FetchWatermark* watermark = options_.watermark;
+
+        // Upstream queue latency; stamps are kept, so shards measure from
+        // the producer's enqueue through both queues
+        const TscClock& clock = TscClock::instance();
+        uint64_t dequeued_tsc = 0;
+        size_t routed = 0;  // Counted as processed once out of the reorder stage
+
+        auto route = [this, &staged, &clock, &dequeued_tsc, &routed](const MarketDataPoint& point) {
+            routed++;
+            if constexpr (config::TRACK_RECORD_LATENCY) {
+                if (point.enqueue_tsc != 0) {
+                    router_metrics_.queue_latency.record(clock.elapsed_ns(point.enqueue_tsc, dequeued_tsc));
+                }
+            }
+            options_.taps.append(point);
+            size_t s = ShardOf(point.instrument_id);
+            staged[s].push_back(point);
+            if (staged[s].size() == options_.batch_size) {
+                PushToShard(*shards_[s], staged[s].data(), staged[s].size());
+                staged[s].clear();
+            }
+        };
+
+        while (running_.load(std::memory_order_relaxed)) {
+            bool closed = upstream_.closed();  // Before the pop, see Drain()
+            size_t popped = 0;
+            if (watermark && (watermark->active() || reorder.pending() > 0)) {
+                if constexpr (config::TRACK_RECORD_LATENCY) {
+                    dequeued_tsc = clock.ticks();
+                }
+                popped = reorder.pump(upstream_, *watermark, route);
+            } else {
+                popped = upstream_.try_pop_bulk(batch.data(), batch.size());
+                if constexpr (config::TRACK_RECORD_LATENCY) {
+                    dequeued_tsc = clock.ticks();
+                }
+                for (size_t i = 0; i < popped; ++i) {
+                    route(batch[i]);
+                }
+            }
+            if (routed > 0) {
+                router_metrics_.messages_processed.add(routed);
+                routed = 0;
+                FlushStaged(staged);
+            }
+            if (popped == 0) {
+                if (closed && upstream_.empty()) {
+                    break;
+                }
+                wait.idle([this] { return !upstream_.empty() || upstream_.closed() || !running_.load(); });
+                continue;
+            }
+            wait.reset();
+        }
+
+        // Hand on whatever the reorder stage still holds
+        reorder.flush(route);
+        router_metrics_.messages_processed.add(routed);
+        FlushStaged(staged);
+    }
+
+    void FlushStaged(std::vector<std::vector<MarketDataPoint>>& staged) {
+        for (size_t s = 0; s < shards_.size(); ++s) {
+            if (!staged[s].empty()) {
+                PushToShard(*shards_[s], staged[s].data(), staged[s].size());
+                staged[s].clear();
+            }
+        }
+        options_.taps.flush();
+    }
+
+    // Blocking push: a slow shard stalls the router rather than losing data
+    void PushToShard(Shard& shard, const MarketDataPoint* items, size_t count) {
+        size_t pushed = 0;
+        uint32_t spins = 0;
+        while (pushed < count) {
+            size_t n = shard.queue.try_push_bulk(items + pushed, count - pushed);
+            if (n > 0) {
+                pushed += n;
+                shard.signal.notify();
+                spins = 0;
+            } else if (++spins < options_.spin_limit) {
+                cpu_relax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    template<typename Wait>
+    void WorkerLoop(Shard& shard, Wait wait) {
+        std::vector<MarketDataPoint> batch(options_.batch_size);
+        const TscClock& clock = TscClock::instance();
+        shard.stats.sync();
+        while (true) {
+            size_t popped = shard.queue.try_pop_bulk(batch.data(), batch.size());
+            if (popped > 0) {
+                uint64_t dequeued_tsc = config::TRACK_RECORD_LATENCY ? clock.ticks() : 0;
+                for (size_t i = 0; i < popped; ++i) {
+                    if (InstrumentStats* stats = shard.stats.find_or_add(batch[i].instrument_id)) {
+                        stats->update(batch[i]);
+                        shard.instrument_counts.add(shard.stats.slot_of(stats), batch[i].instrument_id);
+                        if constexpr (config::TRACK_RECORD_LATENCY) {
+                            record_consumer_latency(batch[i], dequeued_tsc, clock.ticks(), shard.metrics, *stats);
+                        }
+                    }
+                }
+                shard.metrics.messages_processed.add(popped);
+                wait.reset();
+            } else if (router_done_.load(std::memory_order_acquire)) {
+                // The router has been joined, so an empty queue stays empty
+                if (shard.queue.empty()) {
+                    break;
+                }
+            } else {
+                wait.idle([this, &shard] { return !shard.queue.empty() || router_done_.load(); });
+            }
+        }
+    }
+
+    UpstreamQueue& upstream_;
+    ThreadMetrics& router_metrics_;  // Router thread only
+    QueueSignal& upstream_signal_;
+    Options options_;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::thread router_;
+    std::atomic<bool> router_pinned_{false};
+    PlacementLog placements_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> router_done_{false};
+};
+
+} // namespace market_data
@@ -0,0 +1,387 @@
+#pragma once
+
+#include "Types.hpp"
+#include "HugePageMemory.hpp"
+#include "LockFreeRingBuffer.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace market_data {
+
+/**
+ * SharedMemoryRegion - RAII mapping of a named POSIX shared-memory segment.
+ *
+ * create() makes a fresh segment of the requested size (replacing a stale
+ * one left by a crashed run) and unlinks the name again on destruction;
+ * processes still attached keep their mapping. attach() maps an existing
+ * segment whole. Every page is faulted in up front (a created segment
+ * after binding it to numa_node, an attached one with MAP_POPULATE), so
+ * there are no page faults on the hot path, and both advise transparent
+ * huge pages (shmem THP has to be enabled for that to take).
+ */
+class SharedMemoryRegion {
+public:
+    SharedMemoryRegion() = default;
+
+    static SharedMemoryRegion create(const std::string& name, std::size_t bytes, const MemoryOptions& options) {
+        SharedMemoryRegion region;
+        region.name_ = name;
+        ::shm_unlink(name.c_str());  // Attached readers of a stale segment keep it alive
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            throw error("shm_open", name);
+        }
+        region.owner_ = true;
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            ::close(fd);
+            throw error("ftruncate", name);
+        }
+        region.size_ = bytes;
+        region.map(fd, options, true);
+        return region;
+    }
+
+    static SharedMemoryRegion attach(const std::string& name, const MemoryOptions& options = {}) {
+        SharedMemoryRegion region;
+        region.name_ = name;
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) {
+            throw error("shm_open", name);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw error("fstat", name);
+        }
+        region.size_ = static_cast<std::size_t>(info.st_size);
+        region.map(fd, options, false);
+        return region;
+    }
+
+    static bool exists(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0) {
+            return false;
+        }
+        ::close(fd);
+        return true;
+    }
+
+    ~SharedMemoryRegion() { release(); }
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    SharedMemoryRegion(SharedMemoryRegion&& other) noexcept { *this = std::move(other); }
+
+    SharedMemoryRegion& operator=(SharedMemoryRegion&& other) noexcept {
+        if (this != &other) {
+            release();
+            name_ = std::move(other.name_);
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            owner_ = std::exchange(other.owner_, false);
+            backing_ = other.backing_;
+        }
+        return *this;
+    }
+
+    void* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const std::string& name() const { return name_; }
+    bool owner() const { return owner_; }
+    PageBacking backing() const { return backing_; }
+
+private:
+    static std::runtime_error error(const char* what, const std::string& name) {
+        std::ostringstream oss;
+        oss << what << " for shared memory '" << name << "' failed: " << std::strerror(errno);
+        return std::runtime_error(oss.str());
+    }
+
+    // Map fd whole and close it; the mapping keeps the segment open
+    void map(int fd, const MemoryOptions& options, bool created) {
+        void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED | (created ? 0 : MAP_POPULATE), fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            throw error("mmap", name_);
+        }
+        data_ = p;
+#if defined(MADV_HUGEPAGE)
+        if (options.use_huge_pages && ::madvise(data_, size_, MADV_HUGEPAGE) == 0) {
+            backing_ = PageBacking::TransparentHuge;
+        }
+#endif
+        if (created) {
+            // Bind first, then fault every page in on that node
+            if (options.numa_node >= 0) {
+                bind_memory_to_node(data_, size_, options.numa_node);
+            }
+            long page = ::sysconf(_SC_PAGESIZE);
+            auto step = static_cast<std::size_t>(page > 0 ? page : 4096);
+            auto* bytes = static_cast<volatile char*>(data_);
+            for (std::size_t offset = 0; offset < size_; offset += step) {
+                bytes[offset] = 0;
+            }
+        }
+    }
+
+    void release() {
+        if (data_) {
+            ::munmap(data_, size_);
+            data_ = nullptr;
+        }
+        if (owner_) {
+            ::shm_unlink(name_.c_str());
+            owner_ = false;
+        }
+        size_ = 0;
+    }
+
+    std::string name_;
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool owner_ = false;
+    PageBacking backing_ = PageBacking::Regular;
+};
+
+/**
+ * What a shared queue carries, so a consumer built with different record
+ * layout settings refuses to attach. 0 = unknown type (record size only).
+ */
+template<typename T>
+inline constexpr uint32_t SHARED_RECORD_TYPE = 0;
+
+template<>
+inline constexpr uint32_t SHARED_RECORD_TYPE<MarketDataPoint> =
+    config::FIXED_POINT_PRICES ? 0x4650444D : 0x3150444D;  // "MDPF" (fixed-point prices), "MDP1"
+
+/**
+ * SharedQueueHeader - first page of a shared queue segment.
+ *
+ * Fixed layout, no pointers. The producer fills it in, initializes the
+ * queue behind it and only then publishes state Ready; consumers check
+ * every field before touching the queue.
+ */
+struct SharedQueueHeader {
+    enum State : uint32_t { Initializing = 0, Ready = 1, Closed = 2 };
+
+    char magic[8];                 // SHARED_QUEUE_MAGIC
+    uint32_t version;
+    uint32_t header_bytes;         // Offset of the queue
+    uint64_t slots;                // Queue size (power of 2)
+    uint64_t queue_bytes;
+    uint32_t record_size;          // sizeof(T)
+    uint32_t record_type;          // SHARED_RECORD_TYPE<T>
+    uint32_t layout;               // SlotLayout
+    int32_t producer_pid;
+    int64_t created_ns;            // System clock
+    std::atomic<uint32_t> state;   // State; Closed once the producer is done
+};
+
+inline constexpr char SHARED_QUEUE_MAGIC[8] = {'M', 'D', 'E', 'S', 'H', 'M', 'Q', '\0'};
+inline constexpr uint32_t SHARED_QUEUE_VERSION = 1;
+inline constexpr std::size_t SHARED_QUEUE_HEADER_BYTES = 4096;
+
+static_assert(sizeof(SharedQueueHeader) <= SHARED_QUEUE_HEADER_BYTES, "Shared queue header outgrew its page");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Shared queue state must be lock-free");
+
+/**
+ * SharedRingBuffer - LockFreeRingBuffer in a named POSIX shared-memory
+ * segment, so consumers in other processes drain what this process
+ * publishes with no copy beyond the queue's own and no serialization.
+ *
+ * The segment is a SharedQueueHeader page followed by the queue
+ * (LockFreeRingBuffer's external layout: positions, then slots), all
+ * addressed by index, so each process may map it anywhere. It keeps the
+ * MPMC interface, so any number of producer threads and consumer
+ * processes may share it; consumers compete for records, as consumer
+ * threads do in-process.
+ *
+ * The (size, MemoryOptions) constructor creates the segment named
+ * options.shared_name, which lets it stand in for the engine queue
+ * (QUEUE_SHARED_MEMORY); the creator marks the queue Closed and unlinks
+ * the name when destroyed. attach() maps an existing queue after checking
+ * magic, version, record size and type, layout and size.
+ *
+ * Cross-process waiting is by polling: a QueueSignal only wakes threads
+ * of its own process.
+ *
+ * Template parameters:
+ * - T: Record type, trivially copyable
+ * - Layout: Slot storage layout (see SlotLayout)
+ */
+template<typename T, SlotLayout Layout = SlotLayout::Padded>
+class SharedRingBuffer {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "Shared queue records must be trivially copyable");
+
+    using Queue = LockFreeRingBuffer<T, Layout>;
+
+    static constexpr bool MULTI_PRODUCER = true;
+    static constexpr bool MULTI_CONSUMER = true;
+
+    /**
+     * Create the segment options.shared_name for a queue of size slots
+     * (power of 2). Throws if the name is empty or the segment cannot be
+     * created.
+     */
+    explicit SharedRingBuffer(std::size_t size, const MemoryOptions& options = {}) {
+        if (options.shared_name.empty()) {
+            throw std::invalid_argument("SharedRingBuffer needs MemoryOptions::shared_name");
+        }
+        std::size_t queue_bytes = Queue::external_bytes(size);
+        region_ = SharedMemoryRegion::create(options.shared_name, SHARED_QUEUE_HEADER_BYTES + queue_bytes, options);
+        header_ = new (region_.data()) SharedQueueHeader();
+        std::memcpy(header_->magic, SHARED_QUEUE_MAGIC, sizeof(header_->magic));
+        header_->version = SHARED_QUEUE_VERSION;
+        header_->header_bytes = static_cast<uint32_t>(SHARED_QUEUE_HEADER_BYTES);
+        header_->slots = size;
+        header_->queue_bytes = queue_bytes;
+        header_->record_size = static_cast<uint32_t>(sizeof(T));
+        header_->record_type = SHARED_RECORD_TYPE<T>;
+        header_->layout = static_cast<uint32_t>(Layout);
+        header_->producer_pid = static_cast<int32_t>(::getpid());
+        header_->created_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        queue_.emplace(size, queue_memory(), true);
+        header_->state.store(SharedQueueHeader::Ready, std::memory_order_release);
+    }
+
+    /**
+     * Map the queue another process created. Waits up to timeout for the
+     * creator to finish setting it up; throws if the segment does not
+     * exist, is not ready in time or does not match this build.
+     */
+    static std::unique_ptr<SharedRingBuffer> attach(const std::string& name,
+                                                    std::chrono::milliseconds timeout = std::chrono::seconds(1)) {
+        return std::unique_ptr<SharedRingBuffer>(new SharedRingBuffer(SharedMemoryRegion::attach(name), timeout));
+    }
+
+    ~SharedRingBuffer() {
+        queue_.reset();
+        if (region_.owner()) {
+            close();
+        }
+    }
+
+    SharedRingBuffer(const SharedRingBuffer&) = delete;
+    SharedRingBuffer& operator=(const SharedRingBuffer&) = delete;
+
+    bool try_push(const T& item) { return queue_->try_push(item); }
+    bool try_pop(T& item) { return queue_->try_pop(item); }
+    std::size_t try_push_bulk(const T* items, std::size_t count) { return queue_->try_push_bulk(items, count); }
+    std::size_t try_pop_bulk(T* items, std::size_t count) { return queue_->try_pop_bulk(items, count); }
+    T* try_claim() { return queue_->try_claim(); }
+    void commit(T* slot) { queue_->commit(slot); }
+    const T* try_peek() { return queue_->try_peek(); }
+    void release(const T* slot) { queue_->release(slot); }
+
+    double utilization() const { return queue_->utilization(); }
+    size_t size() const { return queue_->size(); }
+    bool empty() const { return queue_->empty(); }
+    size_t capacity() const { return queue_->capacity(); }
+    PageBacking page_backing() const { return region_.backing(); }
+    size_t memory_bytes() const { return region_.size(); }
+
+    /**
+     * Tell consumers no more records will come (the creator does this on
+     * destruction).
+     */
+    void close() { header_->state.store(SharedQueueHeader::Closed, std::memory_order_release); }
+
+    /**
+     * The producer closed the queue (a plain load, for idle consumers;
+     * see producer_done() for a producer that exited without closing).
+     */
+    bool closed() const {
+        return header_->state.load(std::memory_order_acquire) == SharedQueueHeader::Closed;
+    }
+
+    /**
+     * The producer closed the queue, or its process is gone (consumer
+     * side; cold, it may make a system call).
+     */
+    bool producer_done() const {
+        if (header_->state.load(std::memory_order_acquire) == SharedQueueHeader::Closed) {
+            return true;
+        }
+        return ::kill(static_cast<pid_t>(header_->producer_pid), 0) != 0 && errno == ESRCH;
+    }
+
+    const std::string& name() const { return region_.name(); }
+    const SharedQueueHeader& header() const { return *header_; }
+
+private:
+    SharedRingBuffer(SharedMemoryRegion region, std::chrono::milliseconds timeout)
+        : region_(std::move(region)) {
+        if (region_.size() < SHARED_QUEUE_HEADER_BYTES) {
+            throw std::runtime_error("Shared memory '" + region_.name() + "' is too small for a queue");
+        }
+        header_ = static_cast<SharedQueueHeader*>(region_.data());
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (header_->state.load(std::memory_order_acquire) == SharedQueueHeader::Initializing) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                throw std::runtime_error("Shared queue '" + region_.name() + "' was never made ready");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        validate();
+        queue_.emplace(static_cast<std::size_t>(header_->slots), queue_memory(), false);
+    }
+
+    void validate() const {
+        std::ostringstream oss;
+        const SharedQueueHeader& h = *header_;
+        if (std::memcmp(h.magic, SHARED_QUEUE_MAGIC, sizeof(h.magic)) != 0) {
+            oss << "is not a shared queue";
+        } else if (h.version != SHARED_QUEUE_VERSION) {
+            oss << "has version " << h.version << ", expected " << SHARED_QUEUE_VERSION;
+        } else if (h.record_size != sizeof(T) || h.record_type != SHARED_RECORD_TYPE<T>) {
+            oss << "holds " << h.record_size << "-byte records of type " << h.record_type << ", expected "
+                << sizeof(T) << "-byte records of type " << SHARED_RECORD_TYPE<T>;
+        } else if (h.layout != static_cast<uint32_t>(Layout)) {
+            oss << "uses another slot layout";
+        } else if (h.header_bytes != SHARED_QUEUE_HEADER_BYTES || h.slots < 2 || (h.slots & (h.slots - 1)) != 0 ||
+                   h.queue_bytes != Queue::external_bytes(static_cast<std::size_t>(h.slots)) ||
+                   region_.size() < h.header_bytes + h.queue_bytes) {
+            oss << "has an inconsistent size";
+        } else {
+            return;
+        }
+        throw std::runtime_error("Shared memory '" + region_.name() + "' " + oss.str());
+    }
+
+    void* queue_memory() const { return static_cast<char*>(region_.data()) + SHARED_QUEUE_HEADER_BYTES; }
+
+    SharedMemoryRegion region_;
+    SharedQueueHeader* header_ = nullptr;
+    std::optional<Queue> queue_;
+};
+
+// Whether a queue type lives in shared memory
+template<typename T>
+struct is_shared_queue : std::false_type {};
+
+template<typename T, SlotLayout Layout>
+struct is_shared_queue<SharedRingBuffer<T, Layout>> : std::true_type {};
+
+} // namespace market_data
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "MarketDataSource.hpp"
+#include "SharedMemoryQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * BasicSharedQueueFeed - MarketDataSource for a strategy process that
+ * consumes another engine's shared-memory queue (QUEUE_SHARED_MEMORY).
+ *
+ * There is no producer thread on this side: the records are already in
+ * the queue, written by the engine that created the segment, and the
+ * usual consumers (or a ShardedPipeline) pop them in place. The feed runs
+ * until stopped or until that engine has closed the queue (or exited) and
+ * the queue is empty. The metrics only hold this process's consumer
+ * counters, and the instrument universe stays empty: consumers add
+ * instruments on first sight. SetConsumerSignal() is ignored, since the
+ * producer cannot wake a thread of this process; poll instead.
+ *
+ * Template parameters:
+ * - QueueT: must be a SharedRingBuffer (the engine queue with
+ *   QUEUE_SHARED_MEMORY); any other queue type throws on construction.
+ */
+template<typename QueueT>
+class BasicSharedQueueFeed : public MarketDataSource<QueueT> {
+public:
+    using DataQueue = QueueT;
+
+    /**
+     * Attach to the queue name, waiting up to timeout for the producing
+     * engine to create it. Throws if it does not appear or does not match.
+     */
+    explicit BasicSharedQueueFeed(const std::string& name,
+                                  std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+        if constexpr (is_shared_queue<QueueT>::value) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (!SharedMemoryRegion::exists(name)) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    throw std::runtime_error("Shared queue '" + name + "' does not exist");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Producer not started yet
+            }
+            data_queue_ = QueueT::attach(name, timeout);
+        } else {
+            (void)name;
+            (void)timeout;
+            throw std::logic_error("Attaching to a shared queue needs QUEUE_SHARED_MEMORY");
+        }
+    }
+
+    ~BasicSharedQueueFeed() override = default;
+
+    BasicSharedQueueFeed(const BasicSharedQueueFeed&) = delete;
+    BasicSharedQueueFeed& operator=(const BasicSharedQueueFeed&) = delete;
+
+    /**
+     * Nothing to fetch: the producing engine chose what the queue carries.
+     */
+    void Start(const SourceRequest& request) override {
+        (void)request;
+        metrics_.Reset();
+        is_running_ = true;
+    }
+
+    void Stop() override { is_running_ = false; }
+
+    bool IsRunning() const override {
+        if (!is_running_.load()) {
+            return false;
+        }
+        if constexpr (is_shared_queue<QueueT>::value) {
+            return !(data_queue_->producer_done() && data_queue_->empty());
+        } else {
+            return false;
+        }
+    }
+
+    DataQueue& GetQueue() override { return *data_queue_; }
+    const PerformanceMetrics& GetMetrics() const override { return metrics_; }
+    const InstrumentUniverse& GetInstruments() const override { return instruments_; }
+    void SetConsumerSignal(QueueSignal* signal) override { (void)signal; }
+
+    void SetErrorCallback(std::function<void(const std::string&)> callback) override {
+        error_callback_ = callback;
+    }
+
+    void SetLogger(AsyncLogger* logger) override { (void)logger; }
+
+    std::vector<PlacementLog::Entry> GetThreadPlacements() const override { return {}; }
+
+private:
+    std::unique_ptr<DataQueue> data_queue_;
+    PerformanceMetrics metrics_;
+    InstrumentUniverse instruments_;
+    std::function<void(const std::string&)> error_callback_;
+    std::atomic<bool> is_running_{false};
+};
+
+// Feed used by the engine with SHARED_QUEUE_ATTACH
+using SharedQueueFeed = BasicSharedQueueFeed<EngineDataQueue>;
+
+} // namespace market_data
@@ -0,0 +1,289 @@
+#pragma once
+
+#include "Types.hpp"
+#include "HugePageMemory.hpp"
+#include <atomic>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+namespace market_data {
+
+/**
+ * Single-Producer Single-Consumer Lock-Free Queue
+ *
+ * Same interface as LockFreeRingBuffer, for the common one-fetcher /
+ * one-consumer pipeline. No CAS and no per-slot sequence numbers: the
+ * producer owns tail_, the consumer owns head_, and each side keeps a
+ * cached copy of the other's index so it only touches the shared line
+ * when the cached view says the queue is full (producer) or empty
+ * (consumer).
+ *
+ * Template parameters:
+ * - T: Type of elements to store (MarketDataPoint in our case)
+ *
+ * The buffer size is chosen at construction (must be power of 2) and the
+ * payload array is packed and backed by a HugePageRegion.
+ *
+ * Exactly one thread may push and exactly one thread may pop.
+ */
+template<typename T>
+class SpscRingBuffer {
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    std::size_t size_;          // Number of slots (power of 2)
+    std::size_t mask_;          // For efficient modulo operation
+    HugePageRegion storage_;    // Backing memory for the payload array
+    T* buffer_;
+
+    // Producer-owned line: write index + last observed consumer index
+    alignas(CACHE_LINE) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_{0};
+
+    // Consumer-owned line: read index + last observed producer index
+    alignas(CACHE_LINE) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_{0};
+    std::atomic<bool> closed_{false};  // Set once by the producer, read by the idle consumer
+
+    static std::size_t validate_size(std::size_t size) {
+        if (size < 2 || (size & (size - 1)) != 0) {
+            std::ostringstream oss;
+            oss << "Ring buffer size must be a power of 2 and at least 2, got " << size;
+            throw std::invalid_argument(oss.str());
+        }
+        return size;
+    }
+
+public:
+    explicit SpscRingBuffer(std::size_t size, const MemoryOptions& options = {})
+        : size_(validate_size(size)),
+          mask_(size - 1),
+          storage_(size * sizeof(T), options),
+          buffer_(static_cast<T*>(storage_.data())) {
+        // Construct every slot up front, which also pre-faults the mapping
+        for (std::size_t i = 0; i < size_; ++i) {
+            new (&buffer_[i]) T();
+        }
+    }
+
+    ~SpscRingBuffer() {
+        for (std::size_t i = 0; i < size_; ++i) {
+            buffer_[i].~T();
+        }
+    }
+
+    // Concurrency supported by this queue, for callers that need to check
+    static constexpr bool MULTI_PRODUCER = false;
+    static constexpr bool MULTI_CONSUMER = false;
+
+    // Non-copyable to prevent accidental copies
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /**
+     * Attempt to push an item to the buffer (producer thread only).
+     * Returns true if successful, false if buffer is full.
+     */
+    bool try_push(const T& item) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (tail - cached_head_ == size_) {
+            // Looks full from our cached view, refresh from the consumer
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == size_) {
+                return false;
+            }
+        }
+
+        buffer_[tail & mask_] = item;
+
+        // Publish the slot to the consumer
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Attempt to pop an item from the buffer (consumer thread only).
+     * Returns true if successful, false if buffer is empty.
+     */
+    bool try_pop(T& item) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+
+        if (head == cached_tail_) {
+            // Looks empty from our cached view, refresh from the producer
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+
+        item = buffer_[head & mask_];
+
+        // Hand the slot back to the producer
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Attempt to push up to count items (producer thread only).
+     * Returns the number of items actually pushed (0 if the buffer is full).
+     * All pushed items are published with a single index store.
+     */
+    std::size_t try_push_bulk(const T* items, std::size_t count) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+        std::size_t free_slots = size_ - (tail - cached_head_);
+        if (free_slots < count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            free_slots = size_ - (tail - cached_head_);
+        }
+
+        std::size_t n = count < free_slots ? count : free_slots;
+        for (std::size_t i = 0; i < n; ++i) {
+            buffer_[(tail + i) & mask_] = items[i];
+        }
+
+        if (n > 0) {
+            tail_.store(tail + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    /**
+     * Attempt to pop up to count items (consumer thread only).
+     * Returns the number of items actually popped (0 if the buffer is empty).
+     * All popped slots are handed back with a single index store.
+     */
+    std::size_t try_pop_bulk(T* items, std::size_t count) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+
+        std::size_t available = cached_tail_ - head;
+        if (available < count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            available = cached_tail_ - head;
+        }
+
+        std::size_t n = count < available ? count : available;
+        for (std::size_t i = 0; i < n; ++i) {
+            items[i] = buffer_[(head + i) & mask_];
+        }
+
+        if (n > 0) {
+            head_.store(head + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    /**
+     * Free slots (producer thread only). Only re-reads the consumer's index
+     * when the cached view shows fewer than wanted, so the result may be
+     * low but never too high.
+     */
+    std::size_t free_space(std::size_t wanted) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t free_slots = size_ - (tail - cached_head_);
+        if (free_slots < wanted) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            free_slots = size_ - (tail - cached_head_);
+        }
+        return free_slots;
+    }
+
+    /**
+     * Zero-copy producer API (producer thread only).
+     * Returns a pointer to the next free slot, or nullptr if the buffer is
+     * full. Write the record in place, then commit() to publish it. Only
+     * one slot may be claimed at a time.
+     */
+    T* try_claim() {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (tail - cached_head_ == size_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == size_) {
+                return nullptr;
+            }
+        }
+        return &buffer_[tail & mask_];
+    }
+
+    /**
+     * Publish the slot obtained from try_claim().
+     */
+    void commit(T* slot) {
+        (void)slot;
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Zero-copy consumer API (consumer thread only).
+     * Returns a pointer to the oldest record in place, or nullptr if the
+     * buffer is empty. Call release() once done reading it.
+     */
+    const T* try_peek() {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return nullptr;
+            }
+        }
+        return &buffer_[head & mask_];
+    }
+
+    /**
+     * Hand the slot obtained from try_peek() back to the producer.
+     */
+    void release(const T* slot) {
+        (void)slot;
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Get current buffer utilization (0.0 to 1.0).
+     * Useful for monitoring but not guaranteed to be exact due to concurrent access.
+     */
+    double utilization() const {
+        return static_cast<double>(size()) / static_cast<double>(size_);
+    }
+
+    /**
+     * Get current number of items in buffer.
+     * Not guaranteed to be exact due to concurrent access.
+     */
+    size_t size() const {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        return static_cast<size_t>(tail - head);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return size_;  // Monotonic indices, no slot reserved
+    }
+
+    /**
+     * End of stream: call once the producers have published their last
+     * record (and returned). A consumer that reads closed() before a pop
+     * that comes back empty has seen every record and can exit.
+     */
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    /**
+     * How the slot array ended up being backed (hugetlb, THP or regular pages).
+     */
+    PageBacking page_backing() const { return storage_.backing(); }
+
+    /**
+     * Bytes of memory reserved for the slot array.
+     */
+    size_t memory_bytes() const { return storage_.size(); }
+};
+
+} // namespace market_data
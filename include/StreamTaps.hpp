@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Types.hpp"
+#include "ColumnarCapture.hpp"
+#include "MulticastFeed.hpp"
+#include <cstddef>
+
+namespace market_data {
+
+/**
+ * StreamTaps - the optional copies of the processed stream.
+ *
+ * Whichever thread processes the stream (the consumer, or the router when
+ * sharded) appends every record in processing order and flushes after
+ * each batch; each attached tap then hands the batch to its own thread.
+ * Unset taps cost one branch per call.
+ */
+struct StreamTaps {
+    ColumnarCapture* capture = nullptr;      // Columnar file for offline analytics
+    MulticastPublisher* multicast = nullptr; // Datagrams to other processes
+
+    bool empty() const { return !capture && !multicast; }
+
+    void append(const MarketDataPoint& dp) {
+        if (capture) {
+            capture->append(dp);
+        }
+        if (multicast) {
+            multicast->append(dp);
+        }
+    }
+
+    void append(const MarketDataPoint* items, size_t count) {
+        if (capture) {
+            capture->append(items, count);
+        }
+        if (multicast) {
+            multicast->append(items, count);
+        }
+    }
+
+    void flush() {
+        if (capture) {
+            capture->flush();
+        }
+        if (multicast) {
+            multicast->flush();
+        }
+    }
+};
+
+} // namespace market_data
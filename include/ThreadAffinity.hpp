@@ -0,0 +1,233 @@
+#pragma once
+
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+namespace market_data {
+
+/**
+ * Pin the calling thread to a single CPU core.
+ * Returns false if the core is invalid or pinning is unsupported.
+ */
+inline bool pin_current_thread(int core) {
+#if defined(__linux__)
+    if (core < 0 || core >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+/**
+ * Switch the calling thread to SCHED_FIFO at priority (1-99). Needs
+ * CAP_SYS_NICE or an rtprio limit; returns false when refused.
+ */
+inline bool set_fifo_priority(int priority) {
+#if defined(__linux__)
+    if (priority < sched_get_priority_min(SCHED_FIFO) || priority > sched_get_priority_max(SCHED_FIFO)) {
+        return false;
+    }
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+    (void)priority;
+    return false;
+#endif
+}
+
+/**
+ * Put the calling thread back on normal (SCHED_OTHER) scheduling.
+ */
+inline bool set_normal_priority() {
+#if defined(__linux__)
+    sched_param param{};
+    return pthread_setschedparam(pthread_self(), SCHED_OTHER, &param) == 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Where and how one engine thread runs.
+ */
+struct ThreadPlacement {
+    int core = -1;           // -1 = let the kernel place the thread
+    int fifo_priority = 0;   // 1-99 = SCHED_FIFO (pinned threads only), 0 = normal scheduling
+};
+
+/**
+ * A thread's placement as read back from the kernel.
+ */
+struct PlacementStatus {
+    int requested_core = -1;
+    int requested_priority = 0;
+    int cpu = -1;            // CPU the thread was running on when checked
+    int allowed_cpus = 0;    // CPUs in the affinity mask
+    bool pinned = false;     // Affinity mask is exactly the requested core
+    bool realtime = false;   // Scheduled SCHED_FIFO
+    int priority = 0;
+
+    // Everything that was asked for took effect
+    bool ok() const {
+        return (requested_core < 0 || pinned) && (requested_priority == 0 || realtime);
+    }
+
+    std::string describe() const {
+        std::ostringstream oss;
+        oss << "cpu " << cpu;
+        if (requested_core >= 0) {
+            oss << (pinned ? ", pinned to " : ", NOT pinned to ") << requested_core;
+        } else {
+            oss << ", unpinned (" << allowed_cpus << " cpus allowed)";
+        }
+        if (realtime) {
+            oss << ", SCHED_FIFO " << priority;
+        } else if (requested_priority > 0) {
+            oss << ", SCHED_FIFO " << requested_priority << " refused";
+        }
+        return oss.str();
+    }
+};
+
+/**
+ * Read back the calling thread's CPU, affinity and scheduling policy.
+ */
+inline PlacementStatus current_placement(const ThreadPlacement& requested = {}) {
+    PlacementStatus status;
+    status.requested_core = requested.core;
+    status.requested_priority = requested.fifo_priority;
+#if defined(__linux__)
+    status.cpu = sched_getcpu();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        status.allowed_cpus = CPU_COUNT(&set);
+        status.pinned = requested.core >= 0 && requested.core < CPU_SETSIZE &&
+                        status.allowed_cpus == 1 && CPU_ISSET(requested.core, &set);
+    }
+    int policy = 0;
+    sched_param param{};
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0 && policy == SCHED_FIFO) {
+        status.realtime = true;
+        status.priority = param.sched_priority;
+    }
+#endif
+    return status;
+}
+
+/**
+ * Apply placement to the calling thread, then verify it. Called first
+ * thing on each engine thread. SCHED_FIFO is only requested together with
+ * a core: a real-time thread spinning wherever the kernel puts it can
+ * starve everything else on that core. Threads inherit placement from the
+ * thread that created them, so an unplaced thread drops an inherited
+ * SCHED_FIFO (its inherited affinity mask shows in allowed_cpus).
+ */
+inline PlacementStatus apply_thread_placement(const ThreadPlacement& placement) {
+    ThreadPlacement requested = placement;
+    if (placement.core >= 0) {
+        pin_current_thread(placement.core);
+        if (placement.fifo_priority > 0) {
+            set_fifo_priority(placement.fifo_priority);
+        }
+    } else {
+        requested.fifo_priority = 0;  // Not attempted, see above
+    }
+    if (requested.fifo_priority == 0 && current_placement().realtime) {
+        set_normal_priority();
+    }
+    return current_placement(requested);
+}
+
+/**
+ * Pin every current and future page of the process (mlockall), so hot
+ * paths never take a major fault. Needs CAP_IPC_LOCK or a large enough
+ * RLIMIT_MEMLOCK.
+ */
+inline bool lock_process_memory() {
+#if defined(__linux__)
+    return ::mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * NUMA node a CPU core belongs to (from sysfs), -1 when unknown.
+ */
+inline int numa_node_of_core(int core) {
+#if defined(__linux__)
+    if (core < 0) {
+        return -1;
+    }
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(core);
+    DIR* dir = ::opendir(path.c_str());
+    if (!dir) {
+        return -1;
+    }
+    int node = -1;
+    while (dirent* entry = ::readdir(dir)) {
+        if (std::strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = std::atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    ::closedir(dir);
+    return node;
+#else
+    (void)core;
+    return -1;
+#endif
+}
+
+/**
+ * Placement of each thread a component started, by role ("fetch",
+ * "shard 2", ...). Threads record themselves once at startup; reports read
+ * a copy.
+ */
+class PlacementLog {
+public:
+    struct Entry {
+        std::string role;
+        PlacementStatus status;
+    };
+
+    void record(const std::string& role, const PlacementStatus& status) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.push_back({role, status});
+    }
+
+    std::vector<Entry> entries() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace market_data
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace market_data {
+
+/**
+ * ThreadCounter - counter with exactly one writing thread.
+ *
+ * add() and raise() are a relaxed load and store instead of a locked
+ * read-modify-write, so an update is an ordinary write to a line the
+ * writer already owns. Any thread may load() concurrently.
+ */
+class ThreadCounter {
+public:
+    void add(uint64_t n) {
+        value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // Keep the largest value seen
+    void raise(uint64_t value) {
+        if (value > value_.load(std::memory_order_relaxed)) {
+            value_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t load() const { return value_.load(std::memory_order_relaxed); }
+
+    void reset() { value_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * LatencyHistogram - HDR-style log-linear histogram of nanosecond values.
+ *
+ * Values below 2^SUB_BUCKET_BITS get a bucket each; above that every
+ * power-of-two range is split into 2^SUB_BUCKET_BITS linear sub-buckets,
+ * so a value is reported within 1/32 (~3%) of what was recorded at any
+ * magnitude. Values of 2^MAX_MAGNITUDE ns (~18 minutes) and above share
+ * the last bucket. The exact maximum is kept separately.
+ *
+ * Single writer, like ThreadCounter: record() never does a locked
+ * operation. Readers take a HistogramSnapshot.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr unsigned MAX_MAGNITUDE = 40;
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKETS = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static size_t bucket_index(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        unsigned magnitude = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        if (magnitude >= MAX_MAGNITUDE) {
+            return BUCKETS - 1;
+        }
+        unsigned shift = magnitude - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS + static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+    }
+
+    // Largest value that maps to bucket index
+    static uint64_t bucket_upper(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        size_t shift = index / SUB_BUCKETS - 1;
+        uint64_t sub = index % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void record(uint64_t value) {
+        auto& bucket = counts_[bucket_index(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum_.add(value);
+        max_.raise(value);
+    }
+
+    uint64_t count_at(size_t index) const { return counts_[index].load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(); }
+    uint64_t max() const { return max_.load(); }
+
+    void reset() {
+        for (auto& bucket : counts_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        sum_.reset();
+        max_.reset();
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    ThreadCounter sum_;
+    ThreadCounter max_;
+};
+
+/**
+ * Plain copy of one or more LatencyHistograms, for reporting.
+ */
+struct HistogramSnapshot {
+    std::array<uint64_t, LatencyHistogram::BUCKETS> counts{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    void add(const LatencyHistogram& histogram) {
+        for (size_t i = 0; i < counts.size(); ++i) {
+            uint64_t n = histogram.count_at(i);
+            counts[i] += n;
+            count += n;
+        }
+        sum += histogram.sum();
+        if (histogram.max() > max) {
+            max = histogram.max();
+        }
+    }
+
+    /**
+     * Value at percentile (0-100]: the top of the bucket holding that
+     * rank, capped at the recorded maximum. 0 when empty.
+     */
+    uint64_t percentile(double percentile) const {
+        if (count == 0) {
+            return 0;
+        }
+        auto rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count)));
+        if (rank == 0) {
+            rank = 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint64_t upper = LatencyHistogram::bucket_upper(i);
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+
+    double mean() const {
+        return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count);
+    }
+};
+
+/**
+ * ThreadMetrics - the hot counters of one producer or consumer thread.
+ *
+ * Each thread that publishes or drains records registers its own block
+ * with PerformanceMetrics::register_thread() and is its only writer; the
+ * block is cache-line aligned so no two threads write the same line.
+ * PerformanceMetrics sums the blocks when read.
+ */
+struct alignas(64) ThreadMetrics {
+    ThreadCounter messages_received;   // Producer: records published into the queue (not overruns)
+    ThreadCounter messages_processed;  // Consumer: records taken off the queue
+    ThreadCounter total_latency_ns;    // Producer: time spent in publish calls
+    ThreadCounter max_latency_ns;
+    ThreadCounter buffer_overruns;     // Producer: records dropped (queue full)
+    LatencyHistogram push_latency;     // Producer: one sample per publish call
+    LatencyHistogram feed_latency;     // Live producer: ts_recv -> enqueued
+    LatencyHistogram queue_latency;    // Consumer: enqueue -> dequeue
+    LatencyHistogram process_latency;  // Consumer: dequeue -> stats updated
+    LatencyHistogram end_to_end_latency;  // Consumer: enqueue -> stats updated
+
+    // One consumed record (ns)
+    void record_latency(uint64_t queue_ns, uint64_t process_ns) {
+        queue_latency.record(queue_ns);
+        process_latency.record(process_ns);
+        end_to_end_latency.record(queue_ns + process_ns);
+    }
+
+    void reset() {
+        messages_received.reset();
+        messages_processed.reset();
+        total_latency_ns.reset();
+        max_latency_ns.reset();
+        buffer_overruns.reset();
+        push_latency.reset();
+        feed_latency.reset();
+        queue_latency.reset();
+        process_latency.reset();
+        end_to_end_latency.reset();
+    }
+};
+
+/**
+ * InstrumentCounters - records processed per instrument by one consumer
+ * thread, readable while it runs.
+ *
+ * Slots follow the consumer's InstrumentTable, so counting is one
+ * ThreadCounter add at the slot the stats lookup already found. A slot's
+ * instrument id is set (release) before its first count and never
+ * changes; readers walk the slots in use with acquire / relaxed loads.
+ * The capacity is fixed, so nothing moves under a reader.
+ */
+class InstrumentCounters {
+public:
+    explicit InstrumentCounters(size_t capacity) : slots_(capacity) {}
+
+    InstrumentCounters(const InstrumentCounters&) = delete;
+    InstrumentCounters& operator=(const InstrumentCounters&) = delete;
+
+    // Writer thread only: n more records of instrument_id, held in slot
+    void add(uint32_t slot, int32_t instrument_id, uint64_t n = 1) {
+        Slot& entry = slots_[slot];
+        if (entry.instrument_id.load(std::memory_order_relaxed) != instrument_id) {
+            claim(slot, instrument_id);
+        }
+        entry.messages.add(n);
+    }
+
+    // Any thread: f(instrument_id, messages) for every instrument counted
+    template<typename F>
+    void for_each(F&& f) const {
+        size_t used = used_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < used; ++i) {
+            int64_t id = slots_[i].instrument_id.load(std::memory_order_acquire);
+            if (id != NO_INSTRUMENT) {
+                f(static_cast<int32_t>(id), slots_[i].messages.load());
+            }
+        }
+    }
+
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    static constexpr int64_t NO_INSTRUMENT = -1;
+
+    struct Slot {
+        std::atomic<int64_t> instrument_id{NO_INSTRUMENT};
+        ThreadCounter messages;
+    };
+
+    // Once per slot
+    void claim(uint32_t slot, int32_t instrument_id) {
+        slots_[slot].instrument_id.store(instrument_id, std::memory_order_release);
+        if (slot >= used_.load(std::memory_order_relaxed)) {
+            used_.store(slot + 1, std::memory_order_release);
+        }
+    }
+
+    std::vector<Slot> slots_;
+    std::atomic<size_t> used_{0};  // Slots below this may have been claimed
+};
+
+} // namespace market_data
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace market_data {
+
+/**
+ * TscClock - cheap monotonic nanosecond clock.
+ *
+ * Reads the time-stamp counter (one RDTSC, no syscall, no vDSO) and
+ * converts ticks to nanoseconds with a factor calibrated once against
+ * steady_clock. Falls back to steady_clock where there is no invariant
+ * TSC (non-x86, or a CPU whose TSC rate follows frequency scaling).
+ *
+ * Timestamps are nanoseconds since the calibration point and are only
+ * comparable within one process. Use instance(); calibration takes
+ * about 10 ms on first use.
+ */
+class TscClock {
+public:
+    static const TscClock& instance() {
+        static const TscClock clock;
+        return clock;
+    }
+
+    /**
+     * Raw counter value, convert with to_ns(). The cheapest thing to store
+     * on a hot path.
+     */
+    uint64_t ticks() const {
+#if defined(__x86_64__) || defined(__i386__)
+        if (use_tsc_) {
+            return __rdtsc();
+        }
+#endif
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Signed: a reading from a core slightly behind the calibration base
+    // comes out a little negative instead of wrapping
+    int64_t to_ns(uint64_t ticks) const {
+        return static_cast<int64_t>(static_cast<double>(static_cast<int64_t>(ticks - base_ticks_)) * ns_per_tick_);
+    }
+
+    int64_t now_ns() const { return to_ns(ticks()); }
+
+    /**
+     * Nanoseconds between two ticks() readings, which may come from
+     * different cores; 0 when `to` is not later than `from`.
+     */
+    uint64_t elapsed_ns(uint64_t from, uint64_t to) const {
+        if (to <= from) {
+            return 0;
+        }
+        return static_cast<uint64_t>(static_cast<double>(to - from) * ns_per_tick_);
+    }
+
+    bool uses_tsc() const { return use_tsc_; }
+
+    double ns_per_tick() const { return ns_per_tick_; }
+
+private:
+    TscClock() {
+        use_tsc_ = has_invariant_tsc();
+        if (!use_tsc_) {
+            base_ticks_ = ticks();
+            return;
+        }
+
+        // Calibrate over a short busy interval against steady_clock
+        auto wall_start = std::chrono::steady_clock::now();
+        uint64_t tsc_start = ticks();
+        while (std::chrono::steady_clock::now() - wall_start < std::chrono::milliseconds(10)) {
+            std::this_thread::yield();
+        }
+        auto wall_end = std::chrono::steady_clock::now();
+        uint64_t tsc_end = ticks();
+
+        auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall_end - wall_start).count();
+        if (tsc_end > tsc_start) {
+            ns_per_tick_ = static_cast<double>(elapsed_ns) / static_cast<double>(tsc_end - tsc_start);
+        } else {
+            use_tsc_ = false;
+        }
+        base_ticks_ = ticks();
+    }
+
+    static bool has_invariant_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) && eax >= 0x80000007) {
+            __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+            return (edx & (1u << 8)) != 0;
+        }
+#endif
+        return false;
+    }
+
+    bool use_tsc_ = false;
+    double ns_per_tick_ = 1.0;
+    uint64_t base_ticks_ = 0;
+};
+
+} // namespace market_data
@@ -1,22 +1,98 @@
 #ifndef TYPES_HPP
 #define TYPES_HPP
 
+#include "Config.hpp"
+#include "ThreadMetrics.hpp"
+#include "TscClock.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
+// ================= Prices ==================
+// DBN prices are int64 in units of 1e-9. With config::FIXED_POINT_PRICES
+// they stay that way end to end; otherwise they are decoded to double.
+using Price = std::conditional_t<config::FIXED_POINT_PRICES, std::int64_t, double>;
+
+inline constexpr std::int64_t PRICE_SCALE = 1000000000LL;  // 1e9 for fixed-point conversion
+
+__extension__ typedef __int128 Int128;  // VWAP / microprice accumulators
+
+// Report-time conversion
+inline double price_to_double(Price px) {
+    if constexpr (config::FIXED_POINT_PRICES) {
+        return static_cast<double>(px) / PRICE_SCALE;
+    } else {
+        return px;
+    }
+}
+
+// Price in 1e-9 units (double prices rounded to the nearest unit), and back;
+// the round trip is exact for prices decoded from DBN. Out-of-range double
+// prices (DBN's undefined price among them) saturate
+inline std::int64_t price_to_fixed(Price px) {
+    if constexpr (config::FIXED_POINT_PRICES) {
+        return px;
+    } else {
+        double scaled = px * static_cast<double>(PRICE_SCALE);
+        if (!(std::fabs(scaled) < 9.2e18)) {
+            return scaled < 0.0 ? INT64_MIN : INT64_MAX;  // NaN too
+        }
+        return static_cast<std::int64_t>(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5);
+    }
+}
+
+inline Price price_from_fixed(std::int64_t fixed) {
+    if constexpr (config::FIXED_POINT_PRICES) {
+        return fixed;
+    } else {
+        return static_cast<double>(fixed) / PRICE_SCALE;
+    }
+}
+
+// num / den in price units as a double, exact up to the final rounding:
+// the integer quotient and remainder are converted separately
+inline double fixed_ratio_to_double(Int128 num, std::uint64_t den) {
+    Int128 quotient = num / den;
+    Int128 remainder = num % den;
+    double value = static_cast<double>(quotient) + static_cast<double>(remainder) / static_cast<double>(den);
+    return value / PRICE_SCALE;
+}
+
+// What a MarketDataPoint carries
+enum class EventType : std::uint8_t {
+    Quote = 0,      // Top of book: bid/ask price and size
+    Trade = 1,      // Trade print: price in bid_px, size in bid_sz, aggressor in side
+    BookLevel = 2   // One depth level after a book change: bid/ask at `level`
+};
 
 #pragma pack(push, 1) // Ensure no padding for cache alignment
 struct MarketDataPoint {
-    double bid_px;
-    double ask_px;
+    Price bid_px;
+    Price ask_px;
     std::int64_t timestamp_delta; // Delta from a base timestamp, or raw epoch ns
+    std::uint64_t enqueue_tsc;    // TscClock ticks when handed to the queue, 0 = not stamped
     std::int32_t instrument_id;   // Internal ID for the instrument
     std::uint32_t bid_sz;
     std::uint32_t ask_sz;
+    EventType type;               // Which of the fields above are meaningful
+    char side;                    // Trade aggressor / changed side: 'A', 'B' or 'N'
+    std::uint8_t level;           // BookLevel: depth (0 = top)
+    std::uint8_t flags;           // DBN record flags
     
     // Default constructor for queue initialization
-    MarketDataPoint() : bid_px(0.0), ask_px(0.0), timestamp_delta(0), 
-                       instrument_id(0), bid_sz(0), ask_sz(0) {}
+    MarketDataPoint() : bid_px(0), ask_px(0), timestamp_delta(0), enqueue_tsc(0),
+                       instrument_id(0), bid_sz(0), ask_sz(0),
+                       type(EventType::Quote), side('N'), level(0), flags(0) {}
+    
+    // Trade prints reuse the bid fields
+    Price trade_px() const { return bid_px; }
+    std::uint32_t trade_sz() const { return bid_sz; }
     
     // Utility function to get current timestamp
     static std::int64_t current_timestamp_ns() {
@@ -27,66 +103,540 @@ struct MarketDataPoint {
 };
 #pragma pack(pop)
 
+// Stamp records with the time they are handed to a queue, one clock read
+// per call; consumers turn it into queue latency (TRACK_RECORD_LATENCY)
+inline void stamp_enqueue(MarketDataPoint* items, std::size_t count) {
+    if constexpr (config::TRACK_RECORD_LATENCY) {
+        std::uint64_t now = market_data::TscClock::instance().ticks();
+        for (std::size_t i = 0; i < count; ++i) {
+            items[i].enqueue_tsc = now;
+        }
+    } else {
+        (void)items;
+        (void)count;
+    }
+}
+
 // Performance metrics for MPMC queue monitoring
+//
+// Counters bumped per record or per batch live in per-thread
+// market_data::ThreadMetrics blocks (see ThreadMetrics.hpp): every producer
+// and consumer thread registers one and writes only its own cache lines, and
+// the accessors below sum the blocks on read. Rare events stay shared atomics.
 struct PerformanceMetrics {
-    std::atomic<uint64_t> messages_received{0};
-    std::atomic<uint64_t> messages_processed{0};
-    std::atomic<uint64_t> total_latency_ns{0};
-    std::atomic<uint64_t> max_latency_ns{0};
-    std::atomic<uint64_t> buffer_overruns{0};     // Failed pushes (queue full)
+    using ThreadMetrics = market_data::ThreadMetrics;
+    using HistogramSnapshot = market_data::HistogramSnapshot;
+
     std::atomic<uint64_t> buffer_underruns{0};    // Failed pops (queue empty)
-    
-    // Calculate average latency
-    double avg_latency_us() const {
-        auto processed = messages_processed.load();
-        if (processed == 0) return 0.0;
-        return static_cast<double>(total_latency_ns.load()) / static_cast<double>(processed) / 1000.0;
+    std::atomic<uint64_t> backpressure_stalls{0};   // Publishes that had to wait for room
+    std::atomic<uint64_t> backpressure_stall_ns{0}; // Time producers spent waiting for room
+    std::atomic<uint64_t> records_evicted{0};       // Oldest records dropped to make room
+    std::atomic<uint64_t> records_spilled{0};       // Records written to the spill file
+    std::atomic<uint64_t> cache_hits{0};            // Ranges replayed from the local DBN cache
+    std::atomic<uint64_t> cache_misses{0};          // Ranges downloaded (and cached)
+    std::atomic<uint64_t> max_queue_depth{0};       // Deepest queue seen after a paced publish
+    std::atomic<uint64_t> replay_max_lag_ns{0};     // Furthest the paced producer fell behind schedule
+
+    PerformanceMetrics() = default;
+    PerformanceMetrics(const PerformanceMetrics&) = delete;
+    PerformanceMetrics& operator=(const PerformanceMetrics&) = delete;
 
+    ~PerformanceMetrics() {
+        for (auto& slot : threads_) {
+            delete slot.load(std::memory_order_relaxed);
+        }
     }
-    
-    // Push success rate
-    double push_success_rate() const {
-        auto received = messages_received.load();
+
+    /**
+     * Metrics block for one writing thread, valid for the lifetime of this
+     * object. Register once when the thread (or its role, e.g. a fetch
+     * worker slot) is set up, not per record. Throws std::length_error
+     * past config::MAX_METRICS_THREADS.
+     */
+    ThreadMetrics& register_thread() {
+        size_t index = thread_count_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= threads_.size()) {
+            thread_count_.fetch_sub(1, std::memory_order_relaxed);
+            throw std::length_error("PerformanceMetrics: too many registered threads");
+        }
+        auto* block = new ThreadMetrics();
+        threads_[index].store(block, std::memory_order_release);
+        return *block;
+    }
+
+    // Sums over the registered threads
+    uint64_t messages_received() const { return sum(&ThreadMetrics::messages_received); }
+    uint64_t messages_processed() const { return sum(&ThreadMetrics::messages_processed); }
+    uint64_t total_latency_ns() const { return sum(&ThreadMetrics::total_latency_ns); }
+    uint64_t buffer_overruns() const { return sum(&ThreadMetrics::buffer_overruns); }
+
+    uint64_t max_latency_ns() const {
+        uint64_t max = 0;
+        for_each_thread([&max](const ThreadMetrics& thread) {
+            max = std::max(max, thread.max_latency_ns.load());
+        });
+        return max;
+    }
+
+    // Publish-call latency (ns) merged over the producers
+    HistogramSnapshot push_latency() const { return merge(&ThreadMetrics::push_latency); }
+
+    // Live: gateway receive -> enqueued (ns)
+    HistogramSnapshot feed_latency() const { return merge(&ThreadMetrics::feed_latency); }
+
+    // Consumers (TRACK_RECORD_LATENCY): enqueue -> dequeue, dequeue -> stats
+    // updated, and the two together, per record (ns)
+    HistogramSnapshot queue_latency() const { return merge(&ThreadMetrics::queue_latency); }
+    HistogramSnapshot process_latency() const { return merge(&ThreadMetrics::process_latency); }
+    HistogramSnapshot end_to_end_latency() const { return merge(&ThreadMetrics::end_to_end_latency); }
+
+    // Average publish cost per record
+    double avg_latency_us() const {
+        auto received = messages_received();
         if (received == 0) return 0.0;
-        return 1.0 - (static_cast<double>(buffer_overruns.load()) / static_cast<double>(received));
+        return static_cast<double>(total_latency_ns()) / static_cast<double>(received) / 1000.0;
+    }
+
+    // Average live feed latency (gateway receive -> enqueued)
+    double avg_feed_latency_us() const {
+        return feed_latency().mean() / 1000.0;
+    }
 
+    // Push success rate: published / (published + dropped)
+    double push_success_rate() const {
+        auto received = messages_received();
+        auto offered = received + buffer_overruns();
+        if (offered == 0) return 0.0;
+        return static_cast<double>(received) / static_cast<double>(offered);
     }
 
-    // Reset all metrics
+    // Reset all metrics; per-thread blocks are only reset cleanly while
+    // their writers are idle (between fetches / sessions)
     void Reset() {
-        messages_received.store(0);
-        messages_processed.store(0);
-        total_latency_ns.store(0);
-        max_latency_ns.store(0);
-        buffer_overruns.store(0);
         buffer_underruns.store(0);
+        backpressure_stalls.store(0);
+        backpressure_stall_ns.store(0);
+        records_evicted.store(0);
+        records_spilled.store(0);
+        cache_hits.store(0);
+        cache_misses.store(0);
+        max_queue_depth.store(0);
+        replay_max_lag_ns.store(0);
+        for_each_thread([](ThreadMetrics& thread) { thread.reset(); });
+    }
+
+private:
+    template<typename Fn>
+    void for_each_thread(Fn&& fn) const {
+        size_t count = std::min(thread_count_.load(std::memory_order_acquire), threads_.size());
+        for (size_t i = 0; i < count; ++i) {
+            // nullptr while a registration is still in flight
+            if (ThreadMetrics* thread = threads_[i].load(std::memory_order_acquire)) {
+                fn(*thread);
+            }
+        }
     }
+
+    uint64_t sum(market_data::ThreadCounter ThreadMetrics::*counter) const {
+        uint64_t total = 0;
+        for_each_thread([&](const ThreadMetrics& thread) { total += (thread.*counter).load(); });
+        return total;
+    }
+
+    HistogramSnapshot merge(market_data::LatencyHistogram ThreadMetrics::*histogram) const {
+        HistogramSnapshot snapshot;
+        for_each_thread([&](const ThreadMetrics& thread) { snapshot.add(thread.*histogram); });
+        return snapshot;
+    }
+
+    std::array<std::atomic<ThreadMetrics*>, config::MAX_METRICS_THREADS> threads_{};
+    std::atomic<size_t> thread_count_{0};
 };
 
 // ================= VWAP Tracking ==================
+// Fixed-point prices accumulate price * qty exactly in 128 bits (an int64
+// price times a uint32 size, summed, cannot overflow in practice);
+// double prices use the original floating-point sums.
 struct VWAPTracker {
-    double cum_px_qty{0.0};
-    double cum_qty{0.0};
+    using Accumulator = std::conditional_t<config::FIXED_POINT_PRICES, Int128, double>;
+    using Quantity = std::conditional_t<config::FIXED_POINT_PRICES, std::uint64_t, double>;
 
-    void add(double price, double qty) {
-        cum_px_qty += price * qty;
+    Accumulator cum_px_qty{0};
+    Quantity cum_qty{0};
+
+    void add(Price price, std::uint32_t qty) {
+        cum_px_qty += static_cast<Accumulator>(price) * qty;
+        cum_qty += qty;
+    }
+
+    // Sums already multiplied out elsewhere (batch kernels)
+    void add_sums(Accumulator px_qty, Quantity qty) {
+        cum_px_qty += px_qty;
         cum_qty += qty;
     }
 
     double vwap() const {
-        return cum_qty > 0 ? cum_px_qty / cum_qty : 0.0;
+        if (cum_qty == 0) return 0.0;
+        if constexpr (config::FIXED_POINT_PRICES) {
+            return fixed_ratio_to_double(cum_px_qty, cum_qty);
+        } else {
+            return cum_px_qty / cum_qty;
+        }
     }
 };
 
-// Holds per-instrument stats (VWAP + counters, extendable later)
+// ================= L2 Order Book ==================
+// Ten price levels per side in a fixed array, one 24-byte entry per depth
+// so an update touches a single entry and the top-of-book queries read
+// only the first cache line. Updated in place, never allocates.
+struct alignas(64) OrderBook {
+    static constexpr std::size_t DEPTH = 10;
+
+    struct PriceLevel {
+        Price bid_px{0};
+        Price ask_px{0};
+        std::uint32_t bid_sz{0};
+        std::uint32_t ask_sz{0};
+    };
+
+    PriceLevel levels[DEPTH];
+    std::int64_t last_update_ts{0};
+    std::uint64_t updates{0};
+
+    // BookLevel events (MBP-10) set their depth, Quote events the top
+    void apply(const MarketDataPoint& dp) {
+        if (dp.level >= DEPTH) {
+            return;
+        }
+        PriceLevel& level = levels[dp.level];
+        level.bid_px = dp.bid_px;
+        level.ask_px = dp.ask_px;
+        level.bid_sz = dp.bid_sz;
+        level.ask_sz = dp.ask_sz;
+        last_update_ts = dp.timestamp_delta;
+        updates++;
+    }
+
+    // Both sides of the top level are quoted
+    bool has_top() const {
+        return levels[0].bid_sz > 0 && levels[0].ask_sz > 0;
+    }
+
+    double spread() const {
+        return has_top() ? price_to_double(levels[0].ask_px - levels[0].bid_px) : 0.0;
+    }
+
+    double mid() const {
+        if (!has_top()) return 0.0;
+        if constexpr (config::FIXED_POINT_PRICES) {
+            return fixed_ratio_to_double(static_cast<Int128>(levels[0].bid_px) + levels[0].ask_px, 2);
+        } else {
+            return (levels[0].bid_px + levels[0].ask_px) / 2.0;
+        }
+    }
+
+    // Size-weighted mid: leans toward the side with less size behind it
+    double microprice() const {
+        if (!has_top()) return 0.0;
+        if constexpr (config::FIXED_POINT_PRICES) {
+            Int128 weighted = static_cast<Int128>(levels[0].bid_px) * levels[0].ask_sz
+                            + static_cast<Int128>(levels[0].ask_px) * levels[0].bid_sz;
+            return fixed_ratio_to_double(weighted, std::uint64_t{levels[0].bid_sz} + levels[0].ask_sz);
+        } else {
+            double bid_sz = levels[0].bid_sz;
+            double ask_sz = levels[0].ask_sz;
+            return (levels[0].bid_px * ask_sz + levels[0].ask_px * bid_sz) / (bid_sz + ask_sz);
+        }
+    }
+
+    // Top-of-book size imbalance in [-1, 1], positive = more bid size
+    double imbalance() const {
+        double bid_sz = levels[0].bid_sz;
+        double ask_sz = levels[0].ask_sz;
+        double total = bid_sz + ask_sz;
+        return total > 0 ? (bid_sz - ask_sz) / total : 0.0;
+    }
+
+    // Size imbalance over the top n levels (O(n))
+    double depth_imbalance(std::size_t n = DEPTH) const {
+        double bid_sz = 0.0;
+        double ask_sz = 0.0;
+        for (std::size_t i = 0; i < n && i < DEPTH; ++i) {
+            bid_sz += levels[i].bid_sz;
+            ask_sz += levels[i].ask_sz;
+        }
+        double total = bid_sz + ask_sz;
+        return total > 0 ? (bid_sz - ask_sz) / total : 0.0;
+    }
+};
+
+// ================= Rolling Windows ==================
+// Trailing-window VWAP, realized volatility and average spread over a ring
+// of time buckets. Running totals are kept for the whole window; when event
+// time moves into a new bucket, the buckets that fell out of the window are
+// subtracted from the totals and reused. Each event costs O(1) (amortized
+// over bucket rollovers) and memory is fixed at Buckets per window.
+template<std::size_t Buckets>
+class RollingWindow {
+public:
+    using Accumulator = VWAPTracker::Accumulator;
+    using Quantity = VWAPTracker::Quantity;
+
+    explicit RollingWindow(std::int64_t window_ns = 1000000000LL) { set_window(window_ns); }
+
+    void set_window(std::int64_t window_ns) {
+        std::int64_t bucket = window_ns / static_cast<std::int64_t>(Buckets);
+        window_ns_ = window_ns;
+        bucket_ns_ = bucket > 0 ? bucket : 1;
+        head_ = -1;
+        for (Bucket& b : buckets_) {
+            b = Bucket{};
+        }
+        totals_ = Bucket{};
+    }
+
+    std::int64_t window_ns() const { return window_ns_; }
+
+    // return_sq: squared log return since the previous trade (0 for the first)
+    void add_trade(std::int64_t ts, Price price, std::uint32_t qty, double return_sq) {
+        Bucket& b = advance(ts);
+        Accumulator notional = static_cast<Accumulator>(price) * qty;
+        b.notional += notional;
+        b.qty += qty;
+        b.return_sq += return_sq;
+        b.trades++;
+        totals_.notional += notional;
+        totals_.qty += qty;
+        totals_.return_sq += return_sq;
+        totals_.trades++;
+    }
+
+    void add_spread(std::int64_t ts, Price spread) {
+        Bucket& b = advance(ts);
+        b.spread_sum += static_cast<Accumulator>(spread);
+        b.spreads++;
+        totals_.spread_sum += static_cast<Accumulator>(spread);
+        totals_.spreads++;
+    }
+
+    // As of the instrument's latest event
+    double vwap() const {
+        if (totals_.qty == 0) return 0.0;
+        if constexpr (config::FIXED_POINT_PRICES) {
+            return fixed_ratio_to_double(totals_.notional, totals_.qty);
+        } else {
+            return totals_.notional / totals_.qty;
+        }
+    }
+
+    // sqrt of summed squared trade-to-trade log returns (not annualized)
+    double volatility() const {
+        return totals_.return_sq > 0.0 ? std::sqrt(totals_.return_sq) : 0.0;
+    }
+
+    double avg_spread() const {
+        if (totals_.spreads == 0) return 0.0;
+        if constexpr (config::FIXED_POINT_PRICES) {
+            return fixed_ratio_to_double(totals_.spread_sum, totals_.spreads);
+        } else {
+            return totals_.spread_sum / static_cast<double>(totals_.spreads);
+        }
+    }
+
+    std::uint64_t trades() const { return totals_.trades; }
+
+private:
+    struct Bucket {
+        Accumulator notional{0};
+        Quantity qty{0};
+        Accumulator spread_sum{0};
+        double return_sq{0.0};
+        std::uint64_t trades{0};
+        std::uint64_t spreads{0};
+    };
+
+    // Bucket for ts, expiring whatever left the window on the way
+    Bucket& advance(std::int64_t ts) {
+        std::int64_t index = ts / bucket_ns_;
+        if (index > head_) {
+            if (head_ < 0 || index - head_ >= static_cast<std::int64_t>(Buckets)) {
+                for (Bucket& b : buckets_) {
+                    b = Bucket{};
+                }
+                totals_ = Bucket{};
+            } else {
+                for (std::int64_t k = head_ + 1; k <= index; ++k) {
+                    expire(buckets_[static_cast<std::size_t>(k) % Buckets]);
+                }
+            }
+            head_ = index;
+        }
+        // Late events (index < head_) count towards the newest bucket
+        return buckets_[static_cast<std::size_t>(head_) % Buckets];
+    }
+
+    void expire(Bucket& b) {
+        totals_.notional -= b.notional;
+        totals_.qty -= b.qty;
+        totals_.spread_sum -= b.spread_sum;
+        totals_.return_sq -= b.return_sq;
+        totals_.trades -= b.trades;
+        totals_.spreads -= b.spreads;
+        if (totals_.trades == 0) {
+            // Floating-point totals drift under repeated subtraction; an
+            // empty window is exactly zero
+            totals_.notional = 0;
+            totals_.qty = 0;
+            totals_.return_sq = 0.0;
+        }
+        if (totals_.spreads == 0) {
+            totals_.spread_sum = 0;
+        }
+        b = Bucket{};
+    }
+
+    std::int64_t window_ns_ = 0;
+    std::int64_t bucket_ns_ = 1;
+    std::int64_t head_ = -1;        // Bucket index of the latest event
+    Bucket totals_;
+    Bucket buckets_[Buckets];
+};
+
+// One RollingWindow per configured length, fed from trades and top-of-book
+// updates
+struct RollingStats {
+    using Window = RollingWindow<config::ROLLING_WINDOW_BUCKETS>;
+
+    Window windows[config::ROLLING_WINDOWS_NS.size() > 0 ? config::ROLLING_WINDOWS_NS.size() : 1];
+    Price last_trade_px{0};
+
+    RollingStats() {
+        for (std::size_t i = 0; i < config::ROLLING_WINDOWS_NS.size(); ++i) {
+            windows[i].set_window(config::ROLLING_WINDOWS_NS[i]);
+        }
+    }
+
+    static constexpr std::size_t size() { return config::ROLLING_WINDOWS_NS.size(); }
+
+    void add_trade(std::int64_t ts, Price price, std::uint32_t qty) {
+        double return_sq = 0.0;
+        if (last_trade_px > 0 && price > 0 && price != last_trade_px) {
+            double r = std::log(static_cast<double>(price) / static_cast<double>(last_trade_px));
+            return_sq = r * r;
+        }
+        last_trade_px = price;
+        for (std::size_t i = 0; i < size(); ++i) {
+            windows[i].add_trade(ts, price, qty, return_sq);
+        }
+    }
+
+    void add_spread(std::int64_t ts, Price spread) {
+        for (std::size_t i = 0; i < size(); ++i) {
+            windows[i].add_spread(ts, spread);
+        }
+    }
+};
+
+// ================= Record Latency ==================
+// Per-instrument consumer latency (TRACK_RECORD_LATENCY): averages and worst
+// case; the distributions live in the consuming thread's histograms
+struct RecordLatency {
+    std::uint64_t samples{0};
+    std::uint64_t queue_ns_total{0};    // Enqueue -> dequeue
+    std::uint64_t queue_ns_max{0};
+    std::uint64_t process_ns_total{0};  // Dequeue -> stats updated
+    std::uint64_t process_ns_max{0};
+
+    void add(std::uint64_t queue_ns, std::uint64_t process_ns) {
+        samples++;
+        queue_ns_total += queue_ns;
+        queue_ns_max = std::max(queue_ns_max, queue_ns);
+        process_ns_total += process_ns;
+        process_ns_max = std::max(process_ns_max, process_ns);
+    }
+
+    double avg_queue_us() const {
+        return samples == 0 ? 0.0 : static_cast<double>(queue_ns_total) / static_cast<double>(samples) / 1000.0;
+    }
+
+    double avg_process_us() const {
+        return samples == 0 ? 0.0 : static_cast<double>(process_ns_total) / static_cast<double>(samples) / 1000.0;
+    }
+};
+
+// Holds per-instrument stats (VWAP + book + counters, extendable later)
 struct InstrumentStats {
+    using Accumulator = VWAPTracker::Accumulator;
+
     VWAPTracker vwap_tracker;
     uint64_t trades_processed{0};
+    uint64_t quotes_processed{0};
+    uint64_t book_updates{0};
+    Accumulator spread_sum{0};      // Over updates that change a two-sided top of book
+    uint64_t spread_samples{0};
+    OrderBook book;
+    RollingStats rolling;
+    RecordLatency latency;
 
-    void update(double price, double qty) {
+    void update(Price price, std::uint32_t qty) {
         vwap_tracker.add(price, qty);
         trades_processed++;
     }
+
+    // VWAP comes from trade prints only; quotes and book levels feed the book
+    void update(const MarketDataPoint& dp) {
+        if (dp.type == EventType::Trade) {
+            update(dp.trade_px(), dp.trade_sz());
+            rolling.add_trade(dp.timestamp_delta, dp.trade_px(), dp.trade_sz());
+            return;
+        }
+        apply_book_event(dp);
+        if (changes_top(dp)) {
+            spread_sum += static_cast<Accumulator>(dp.ask_px - dp.bid_px);
+            spread_samples++;
+            rolling.add_spread(dp.timestamp_delta, dp.ask_px - dp.bid_px);
+        }
+    }
+
+    // Quote / BookLevel bookkeeping without the spread sum (batch kernels
+    // accumulate that themselves)
+    void apply_book_event(const MarketDataPoint& dp) {
+        if (dp.type == EventType::Quote) {
+            quotes_processed++;
+        } else {
+            book_updates++;
+        }
+        book.apply(dp);
+    }
+
+    // A Quote / BookLevel update that leaves both sides of the top quoted
+    static bool changes_top(const MarketDataPoint& dp) {
+        return dp.type != EventType::Trade && dp.level == 0 && dp.bid_sz > 0 && dp.ask_sz > 0;
+    }
+
+    double avg_spread() const {
+        if (spread_samples == 0) return 0.0;
+        if constexpr (config::FIXED_POINT_PRICES) {
+            return fixed_ratio_to_double(spread_sum, spread_samples);
+        } else {
+            return spread_sum / static_cast<double>(spread_samples);
+        }
+    }
 };
 
+// Consumer side of TRACK_RECORD_LATENCY: one record that left the queue at
+// dequeued_tsc and was folded into stats at updated_tsc (TscClock ticks)
+inline void record_consumer_latency(const MarketDataPoint& dp, std::uint64_t dequeued_tsc,
+                                    std::uint64_t updated_tsc, market_data::ThreadMetrics& thread,
+                                    InstrumentStats& stats) {
+    if (dp.enqueue_tsc == 0) {
+        return;  // Not stamped
+    }
+    const market_data::TscClock& clock = market_data::TscClock::instance();
+    std::uint64_t queue_ns = clock.elapsed_ns(dp.enqueue_tsc, dequeued_tsc);
+    std::uint64_t process_ns = clock.elapsed_ns(dequeued_tsc, updated_tsc);
+    thread.record_latency(queue_ns, process_ns);
+    stats.latency.add(queue_ns, process_ns);
+}
+
 #endif // TYPES_HPP
\ No newline at end of file
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace market_data {
+
+/**
+ * CPU hint for spin loops (PAUSE on x86, YIELD on ARM).
+ */
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * QueueSignal - producer -> consumer wake-up channel for blocking waits.
+ *
+ * Consumers park on a futex word; producers call notify() after publishing.
+ * notify() only enters the kernel when a consumer is actually parked, so
+ * the producer's steady-state cost is one fence and one relaxed load.
+ * Handlers only call notify() when a signal has been attached, so
+ * spinning deployments pay nothing at all.
+ */
+class QueueSignal {
+public:
+    /**
+     * Producer side: wake parked consumers, if any.
+     * Call after the records have been published to the queue.
+     */
+    void notify() {
+        // Pairs with the fence in wait(): either we see the waiter, or the
+        // waiter sees the data we just published
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) != 0) {
+            wake_all();
+        }
+    }
+
+    /**
+     * Unconditional wake-up, e.g. on shutdown.
+     */
+    void wake_all() {
+        epoch_.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+        ::syscall(SYS_futex, &epoch_, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    }
+
+    /**
+     * Consumer side: park until notified, ready() returns true, or the
+     * timeout expires. Spurious returns are allowed, callers re-check.
+     */
+    template<typename Ready>
+    void wait(Ready&& ready, std::chrono::nanoseconds timeout) {
+        uint32_t epoch = epoch_.load(std::memory_order_acquire);
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!ready()) {
+#if defined(__linux__)
+            timespec ts;
+            ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+            ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+            ::syscall(SYS_futex, &epoch_, FUTEX_WAIT_PRIVATE, epoch, &ts, nullptr, 0);
+#else
+            (void)epoch;
+            std::this_thread::sleep_for(timeout);
+#endif
+        }
+
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<uint32_t> epoch_{0};    // Futex word, bumped on every wake
+    alignas(64) std::atomic<uint32_t> waiters_{0};  // Consumers currently parked
+};
+
+/**
+ * Wait strategies for ring buffer consumers.
+ *
+ * A consumer calls idle(ready) each time a pop comes back empty and reset()
+ * after it got data. ready() should return true once the queue is non-empty
+ * (or the consumer should stop), so blocking strategies can re-check it
+ * after announcing themselves and never sleep through a publish.
+ */
+
+// Lowest latency, burns a full core
+class BusySpinWait {
+public:
+    template<typename Ready>
+    void idle(Ready&&) { cpu_relax(); }
+    void reset() {}
+};
+
+// Spin for a while, then give the core back to the scheduler between polls
+class SpinYieldWait {
+public:
+    explicit SpinYieldWait(uint32_t spin_limit = 1000) : spin_limit_(spin_limit) {}
+
+    template<typename Ready>
+    void idle(Ready&&) {
+        if (spins_ < spin_limit_) {
+            ++spins_;
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    void reset() { spins_ = 0; }
+
+private:
+    uint32_t spin_limit_;
+    uint32_t spins_ = 0;
+};
+
+// Spin briefly, then park on a QueueSignal the producer notifies
+class BlockingWait {
+public:
+    explicit BlockingWait(QueueSignal& signal,
+                          uint32_t spin_limit = 1000,
+                          std::chrono::nanoseconds timeout = std::chrono::milliseconds(100))
+        : signal_(&signal), spin_limit_(spin_limit), timeout_(timeout) {}
+
+    template<typename Ready>
+    void idle(Ready&& ready) {
+        if (spins_ < spin_limit_) {
+            ++spins_;
+            cpu_relax();
+        } else {
+            signal_->wait(ready, timeout_);
+        }
+    }
+    void reset() { spins_ = 0; }
+
+private:
+    QueueSignal* signal_;
+    uint32_t spin_limit_;
+    std::chrono::nanoseconds timeout_;
+    uint32_t spins_ = 0;
+};
+
+// Original behaviour: fixed sleep whenever the queue is empty
+class SleepWait {
+public:
+    explicit SleepWait(std::chrono::microseconds interval = std::chrono::microseconds(100))
+        : interval_(interval) {}
+
+    template<typename Ready>
+    void idle(Ready&&) { std::this_thread::sleep_for(interval_); }
+    void reset() {}
+
+private:
+    std::chrono::microseconds interval_;
+};
+
+enum class WaitStrategyKind {
+    BusySpin,
+    SpinYield,
+    Blocking,
+    Sleep,
+};
+
+inline const char* to_string(WaitStrategyKind kind) {
+    switch (kind) {
+        case WaitStrategyKind::BusySpin:  return "busy-spin";
+        case WaitStrategyKind::SpinYield: return "spin-yield";
+        case WaitStrategyKind::Blocking:  return "blocking";
+        case WaitStrategyKind::Sleep:     return "sleep";
+    }
+    return "unknown";
+}
+
+/**
+ * Parse a strategy name as printed by to_string(). Returns false if unknown.
+ */
+inline bool parse_wait_strategy(const std::string& name, WaitStrategyKind& kind) {
+    for (auto candidate : {WaitStrategyKind::BusySpin, WaitStrategyKind::SpinYield,
+                           WaitStrategyKind::Blocking, WaitStrategyKind::Sleep}) {
+        if (name == to_string(candidate)) {
+            kind = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Construct the strategy selected at runtime and hand it to f, so consumer
+ * loops can be templated on the concrete strategy type. signal is only
+ * used by the blocking strategy.
+ */
+template<typename F>
+void with_wait_strategy(WaitStrategyKind kind, QueueSignal& signal, uint32_t spin_limit, F&& f) {
+    switch (kind) {
+        case WaitStrategyKind::BusySpin:  f(BusySpinWait{}); break;
+        case WaitStrategyKind::SpinYield: f(SpinYieldWait{spin_limit}); break;
+        case WaitStrategyKind::Blocking:  f(BlockingWait{signal, spin_limit}); break;
+        case WaitStrategyKind::Sleep:     f(SleepWait{}); break;
+    }
+}
+
+} // namespace market_data
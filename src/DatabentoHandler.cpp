@@ -1,15 +1,61 @@
 #include "../include/DatabentoHandler.hpp"
+#include <databento/constants.hpp>
+#include <databento/dbn_encoder.hpp>
+#include <databento/file_stream.hpp>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 
 namespace market_data {
 
+namespace {
+
+// Distinct instrument ids covered by the symbology, sorted
+std::vector<uint32_t> CollectInstrumentIds(const databento::TsSymbolMap& symbol_map) {
+    std::vector<uint32_t> ids;
+    ids.reserve(symbol_map.Size());
+    for (const auto& entry : symbol_map.Map()) {
+        ids.push_back(entry.first.second);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+// Raise target to at least value
+void store_max(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (current < value && !target.compare_exchange_weak(current, value)) {
+        // Retry if another thread raised it meanwhile
+    }
+}
+
+// Schema name as used in the cache layout
+const char* SchemaName(databento::Schema schema) {
+    switch (schema) {
+        case databento::Schema::Bbo1S: return "bbo-1s";
+        case databento::Schema::Bbo1M: return "bbo-1m";
+        case databento::Schema::Trades: return "trades";
+        case databento::Schema::Mbp1:  return "mbp-1";
+        case databento::Schema::Mbp10: return "mbp-10";
+        default:                       return "other";
+    }
+}
+
+} // namespace
+
 // Constructor
-DatabentoHandler::DatabentoHandler(const std::string& api_key, size_t queue_size)
-    : data_queue_(std::make_unique<LockFreeRingBuffer<MarketDataPoint, 1024 * 1024>>()) {
-    (void)queue_size; 
+template<typename QueueT>
+BasicDatabentoHandler<QueueT>::BasicDatabentoHandler(const std::string& api_key, size_t queue_size,
+                                             const MemoryOptions& queue_memory)
+    : api_key_(api_key),
+      data_queue_(std::make_unique<DataQueue>(queue_size, queue_memory)) {
+    
+    primary_.metrics = &metrics_.register_thread();
+    TscClock::instance();  // Calibrate now rather than on the first enqueue stamp
     
     try {
         client_ = std::make_unique<databento::Historical>(
@@ -24,12 +70,15 @@ DatabentoHandler::DatabentoHandler(const std::string& api_key, size_t queue_size
 }
 
 // Destructor
-DatabentoHandler::~DatabentoHandler() {
+template<typename QueueT>
+BasicDatabentoHandler<QueueT>::~BasicDatabentoHandler() {
     StopAsyncFetch();
 }
 
 // Create from environment
-std::unique_ptr<DatabentoHandler> DatabentoHandler::CreateFromEnv(size_t queue_size) {
+template<typename QueueT>
+std::unique_ptr<BasicDatabentoHandler<QueueT>> BasicDatabentoHandler<QueueT>::CreateFromEnv(
+    size_t queue_size, const MemoryOptions& queue_memory) {
     // Get API key from environment variable
     const char* api_key_env = std::getenv("DATABENTO_API_KEY");
     if (!api_key_env) {
@@ -41,11 +90,12 @@ std::unique_ptr<DatabentoHandler> DatabentoHandler::CreateFromEnv(size_t queue_s
         throw std::runtime_error("DATABENTO_API_KEY environment variable is empty");
     }
     
-    return std::make_unique<DatabentoHandler>(api_key, queue_size);
+    return std::make_unique<BasicDatabentoHandler>(api_key, queue_size, queue_memory);
 }
 
-// Fetch historical BBO data
-bool DatabentoHandler::FetchHistoricalBBO(
+// Fetch historical market data
+template<typename QueueT>
+bool BasicDatabentoHandler<QueueT>::FetchHistoricalBBO(
     const std::string& dataset,
     const std::vector<std::string>& symbols,
     const std::string& start_time,
@@ -65,47 +115,37 @@ bool DatabentoHandler::FetchHistoricalBBO(
     try {
         // Reset metrics for new fetch
         metrics_.Reset();  // Explicitly reset the metrics object
-        
-        databento::TsSymbolMap symbol_map;
-        auto decode_symbols = [&symbol_map](const databento::Metadata& metadata) {
-            symbol_map = metadata.CreateSymbolMap();
-        };
-        
-        // Process each record
-        auto process_record = [this, &symbol_map, &dataset](const databento::Record& record) {
-            ProcessBBORecord(record, symbol_map, dataset);
-            return databento::KeepGoing::Continue;
-        };
+        {
+            std::lock_guard<std::mutex> lock(instruments_mutex_);
+            known_instruments_.clear();
+        }
+        pacer_.reset();
         
         // Determine schema enum
         databento::Schema schema_enum;
-        if (schema == "bbo-1s") {
-            schema_enum = databento::Schema::Bbo1S;
-        } else if (schema == "bbo-1m") {
-            schema_enum = databento::Schema::Bbo1M;
-        } else {
+        if (!parse_schema(schema, schema_enum)) {
             std::ostringstream oss;
             oss << "Unsupported schema: " << schema;
             throw std::runtime_error(oss.str());
         }
         
+        if (fetch_plan_.time_slices * fetch_plan_.symbol_groups > 1) {
+            bool ok = RunChunkedFetch(dataset, symbols, start_time, end_time, schema_enum, stype_in);
+            is_fetching_ = false;
+            return ok;
+        }
+        
         // Fetch data
-            client_->TimeseriesGetRange(
-                dataset,
-                databento::DateTimeRange<std::string>{start_time, end_time},
-                symbols,
-                schema_enum,
-                stype_in,
-                databento::SType::InstrumentId,
-                0, // no limit
-                decode_symbols,
-                process_record
-            );
+        watermark_.clear();
+        primary_.staged_count = 0;
+        primary_.lane = -1;
+        RunFetch(*client_, dataset, symbols, start_time, end_time, schema_enum, stype_in, primary_);
         
         is_fetching_ = false;
         return true;
         
     } catch (const std::exception& e) {
+        FlushStaged(primary_);
         is_fetching_ = false;
         std::ostringstream oss;
         oss << "Failed to fetch historical data: " << e.what();
@@ -116,8 +156,276 @@ bool DatabentoHandler::FetchHistoricalBBO(
     }
 }
 
+// One range request through one producer
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::RunFetch(
+    databento::Historical& client,
+    const std::string& dataset,
+    const std::vector<std::string>& symbols,
+    const std::string& start_time,
+    const std::string& end_time,
+    databento::Schema schema,
+    databento::SType stype_in,
+    Producer& producer) {
+    
+    // Cache hits replay from disk. A miss streams from the API as usual and
+    // writes the records alongside as plain DBN, so the next fetch of the
+    // range replays them in place from an mmap
+    std::string cache_path;
+    std::string partial;
+    if (cache_) {
+        cache_path = cache_->PathFor(dataset, SchemaName(schema), static_cast<int>(stype_in),
+                                     symbols, start_time, end_time);
+        if (DbnCache::Contains(cache_path)) {
+            metrics_.cache_hits.fetch_add(1);
+            ReplayFile(cache_path, dataset, producer);
+            return;
+        }
+        metrics_.cache_misses.fetch_add(1);
+        partial = DbnCache::PreparePartial(cache_path);
+    }
+    std::unique_ptr<databento::OutFileStream> cache_file;
+    std::unique_ptr<databento::DbnEncoder> cache_encoder;
+    
+    databento::TsSymbolMap symbol_map;
+    auto decode_symbols = [this, &symbol_map, &partial, &cache_file, &cache_encoder](
+                              const databento::Metadata& metadata) {
+        symbol_map = metadata.CreateSymbolMap();
+        PublishInstruments(symbol_map);
+        if (!partial.empty()) {
+            cache_file = std::make_unique<databento::OutFileStream>(partial);
+            cache_encoder = std::make_unique<databento::DbnEncoder>(metadata, cache_file.get());
+        }
+    };
+    
+    // Process each record
+    auto process_record = [this, &symbol_map, &dataset, &producer, &cache_encoder](const databento::Record& record) {
+        if (cache_encoder) {
+            cache_encoder->EncodeRecord(record);
+        }
+        ProcessRecord(record, symbol_map, dataset, producer);
+        return stop_requested_.load(std::memory_order_relaxed) ? databento::KeepGoing::Stop
+                                                               : databento::KeepGoing::Continue;
+    };
+    
+    try {
+        client.TimeseriesGetRange(
+            dataset,
+            databento::DateTimeRange<std::string>{start_time, end_time},
+            symbols,
+            schema,
+            stype_in,
+            databento::SType::InstrumentId,
+            0, // no limit
+            decode_symbols,
+            process_record
+        );
+    } catch (...) {
+        if (!partial.empty()) {
+            cache_encoder.reset();
+            cache_file.reset();
+            DbnCache::Discard(partial);
+        }
+        throw;
+    }
+    
+    if (!partial.empty()) {
+        // Closing the stream flushes it; a stopped fetch is incomplete
+        bool complete = cache_file && !stop_requested_.load(std::memory_order_relaxed);
+        cache_encoder.reset();
+        cache_file.reset();
+        if (complete) {
+            DbnCache::Commit(partial, cache_path);
+        } else {
+            DbnCache::Discard(partial);
+        }
+    }
+    
+    // Publish the final partial batch, then whatever is still spilled
+    FlushStaged(producer);
+    if (producer.spill) {
+        DrainSpill(producer, true);
+    }
+}
+
+// Replay a cached range straight out of the page cache
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::ReplayFile(
+    const std::string& path,
+    const std::string& dataset,
+    Producer& producer) {
+    
+    // Symbology comes from the metadata, decoded once per file
+    databento::DbnFileStore store{std::filesystem::path{path}};
+    databento::TsSymbolMap symbol_map = store.GetMetadata().CreateSymbolMap();
+    PublishInstruments(symbol_map);
+    
+    MappedFile file(path);
+    DbnPrelude prelude;
+    if (DbnPrelude::parse(file.data(), file.size(), prelude) && prelude.version == databento::kDbnVersion) {
+        // Uncompressed, current-version DBN: records are used in place, no
+        // copy and no allocation per record
+        const uint8_t* cursor = file.data() + prelude.records_offset;
+        const uint8_t* end = file.data() + file.size();
+        while (static_cast<size_t>(end - cursor) >= sizeof(databento::RecordHeader)
+               && !stop_requested_.load(std::memory_order_relaxed)) {
+            auto* header = reinterpret_cast<databento::RecordHeader*>(const_cast<uint8_t*>(cursor));
+            size_t size = header->Size();
+            if (size < sizeof(databento::RecordHeader) || size > static_cast<size_t>(end - cursor)) {
+                std::ostringstream oss;
+                oss << "Truncated record at offset " << (cursor - file.data()) << " in " << path;
+                throw std::runtime_error(oss.str());
+            }
+            ProcessRecord(databento::Record{header}, symbol_map, dataset, producer);
+            cursor += size;
+        }
+    } else {
+        // Older-version or compressed file (caches written before entries
+        // were stored uncompressed): go through the DBN decoder
+        store.Replay([this, &symbol_map, &dataset, &producer](const databento::Record& record) {
+            ProcessRecord(record, symbol_map, dataset, producer);
+            return stop_requested_.load(std::memory_order_relaxed) ? databento::KeepGoing::Stop
+                                                                   : databento::KeepGoing::Continue;
+        });
+    }
+    
+    FlushStaged(producer);
+    if (producer.spill) {
+        DrainSpill(producer, true);
+    }
+}
+
+// Parallel fetch: workers take chunks in time order, one producer each
+template<typename QueueT>
+bool BasicDatabentoHandler<QueueT>::RunChunkedFetch(
+    const std::string& dataset,
+    const std::vector<std::string>& symbols,
+    const std::string& start_time,
+    const std::string& end_time,
+    databento::Schema schema,
+    databento::SType stype_in) {
+    
+    std::vector<FetchChunk> chunks = plan_fetch(symbols, start_time, end_time, fetch_plan_);
+    
+    std::vector<int64_t> starts;
+    starts.reserve(chunks.size());
+    for (const auto& chunk : chunks) {
+        starts.push_back(chunk.start_ns);
+    }
+    watermark_.begin(starts);
+    if (pacer_.active()) {
+        // Chunks start out of order, so pace against the window start
+        pacer_.anchor_at(chunks.front().start_ns);
+    }
+    
+    // A single-producer queue only gets one worker, which keeps chunks in order
+    size_t workers = DataQueue::MULTI_PRODUCER ? fetch_plan_.parallelism : 1;
+    workers = std::max<size_t>(1, std::min(workers, chunks.size()));
+    
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<size_t> next_worker{0};
+    std::atomic<bool> failed{false};
+    
+    // Worker slots keep their metrics blocks across fetches
+    while (worker_metrics_.size() < workers) {
+        worker_metrics_.push_back(&metrics_.register_thread());
+    }
+    while (logger_ && worker_logs_.size() < workers) {
+        worker_logs_.push_back(&logger_->register_thread("fetch worker " + std::to_string(worker_logs_.size())));
+    }
+    
+    auto report = [this, &failed](const std::string& message) {
+        failed = true;
+        if (error_callback_) {
+            error_callback_(message);
+        }
+    };
+    
+    auto worker = [&]() {
+        std::unique_ptr<databento::Historical> client;
+        Producer producer;
+        size_t slot = next_worker.fetch_add(1);
+        producer.metrics = worker_metrics_[slot];
+        producer.log = slot < worker_logs_.size() ? worker_logs_[slot] : nullptr;
+        placements_.record("fetch worker " + std::to_string(slot),
+                           apply_thread_placement(slot < worker_placements_.size()
+                                                      ? worker_placements_[slot] : ThreadPlacement{}));
+        try {
+            // Separate connection per worker, the client is not shared across threads
+            client = std::make_unique<databento::Historical>(
+                databento::Historical::Builder()
+                    .SetKey(api_key_)
+                    .Build());
+            if (overflow_policy_ == OverflowPolicy::SpillToDisk) {
+                producer.spill = std::make_unique<SpillFile<MarketDataPoint>>(spill_directory_);
+            }
+        } catch (const std::exception& e) {
+            std::ostringstream oss;
+            oss << "Failed to start fetch worker: " << e.what();
+            report(oss.str());
+            return;
+        }
+        
+        while (!failed.load() && !stop_requested_.load(std::memory_order_relaxed)) {
+            size_t index = next_chunk.fetch_add(1);
+            if (index >= chunks.size()) {
+                break;
+            }
+            const FetchChunk& chunk = chunks[index];
+            producer.lane = static_cast<int>(index);
+            producer.staged_count = 0;
+            try {
+                RunFetch(*client, dataset, chunk.symbols, chunk.start_time, chunk.end_time,
+                         schema, stype_in, producer);
+            } catch (const std::exception& e) {
+                FlushStaged(producer);
+                std::ostringstream oss;
+                oss << "Failed to fetch chunk " << index << " [" << chunk.start_time
+                    << ", " << chunk.end_time << "): " << e.what();
+                report(oss.str());
+            }
+            watermark_.finish(index);
+            if (consumer_signal_) {
+                consumer_signal_->notify();
+            }
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    // Chunks never started (stop or failure) must not hold the watermark back
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        watermark_.finish(i);
+    }
+    if (consumer_signal_) {
+        consumer_signal_->notify();
+    }
+    return !failed.load();
+}
+
+// Merge one chunk's symbology into the published universe
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::PublishInstruments(const databento::TsSymbolMap& symbol_map) {
+    std::vector<uint32_t> ids = CollectInstrumentIds(symbol_map);
+    std::lock_guard<std::mutex> lock(instruments_mutex_);
+    std::vector<uint32_t> merged;
+    merged.reserve(known_instruments_.size() + ids.size());
+    std::set_union(known_instruments_.begin(), known_instruments_.end(),
+                   ids.begin(), ids.end(), std::back_inserter(merged));
+    known_instruments_ = merged;
+    instruments_.Publish(std::move(merged));
+}
+
 // Start asynchronous fetch
-void DatabentoHandler::StartAsyncFetch(
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::StartAsyncFetch(
     const std::string& dataset,
     const std::vector<std::string>& symbols,
     const std::string& start_time,
@@ -134,10 +442,14 @@ void DatabentoHandler::StartAsyncFetch(
     
     // Stop any existing thread
     StopAsyncFetch();
+    stop_requested_ = false;
+    placements_.clear();
     
-    // Start new thread FIRST, then set the flag
+    // Set before the thread starts: a fetch that finishes first would
+    // otherwise be reported as still running
+    is_fetching_ = true;
     fetch_thread_ = std::make_unique<std::thread>(
-        &DatabentoHandler::AsyncFetchWorker,
+        &BasicDatabentoHandler::AsyncFetchWorker,
         this,
         dataset,
         symbols,
@@ -146,96 +458,383 @@ void DatabentoHandler::StartAsyncFetch(
         schema,
         stype_in
     );
-    
-    // Set flag after thread starts
-    is_fetching_ = true;
 }
 
 // Stop asynchronous fetch
-void DatabentoHandler::StopAsyncFetch() {
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::StopAsyncFetch() {
     is_fetching_ = false;
     
+    // Ends the fetch early and releases a producer blocked on a full queue
+    stop_requested_ = true;
     if (fetch_thread_ && fetch_thread_->joinable()) {
         fetch_thread_->join();
         fetch_thread_.reset();
     }
+    stop_requested_ = false;
+}
+
+// Configure what happens when the queue is full
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::SetOverflowPolicy(
+    OverflowPolicy policy,
+    const std::string& spill_directory,
+    std::chrono::milliseconds max_stall) {
+    
+    if (is_fetching_.load()) {
+        throw std::logic_error("Cannot change overflow policy while fetching");
+    }
+    if (policy == OverflowPolicy::DropOldest && !DataQueue::MULTI_CONSUMER) {
+        throw std::invalid_argument("drop-oldest overflow policy needs a multi-consumer queue");
+    }
+    
+    primary_.spill.reset();
+    if (policy == OverflowPolicy::SpillToDisk) {
+        primary_.spill = std::make_unique<SpillFile<MarketDataPoint>>(spill_directory);
+    }
+    overflow_policy_ = policy;
+    max_stall_ = max_stall;
+    spill_directory_ = spill_directory;
 }
 
-// Process BBO record
-void DatabentoHandler::ProcessBBORecord(
+// Configure the local DBN cache
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::SetCacheDirectory(const std::string& directory) {
+    if (is_fetching_.load()) {
+        throw std::logic_error("Cannot change the cache directory while fetching");
+    }
+    if (directory.empty()) {
+        cache_.reset();
+    } else {
+        cache_ = std::make_unique<DbnCache>(directory);
+    }
+}
+
+// Configure timestamp-paced replay
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::SetReplaySpeed(double speed) {
+    if (is_fetching_.load()) {
+        throw std::logic_error("Cannot change the replay speed while fetching");
+    }
+    pacer_.set_speed(speed);
+}
+
+// Configure how fetches are split across workers
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::SetFetchPlan(const FetchPlanOptions& plan) {
+    if (is_fetching_.load()) {
+        throw std::logic_error("Cannot change the fetch plan while fetching");
+    }
+    if (plan.time_slices * plan.symbol_groups > config::MAX_FETCH_CHUNKS) {
+        std::ostringstream oss;
+        oss << "Fetch plan has " << plan.time_slices * plan.symbol_groups
+            << " chunks, at most " << config::MAX_FETCH_CHUNKS << " are supported";
+        throw std::invalid_argument(oss.str());
+    }
+    fetch_plan_ = plan;
+}
+
+// Configure fetch thread / worker placement
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::SetThreadPlacement(const ThreadPlacement& fetch_thread,
+                                                       const std::vector<ThreadPlacement>& workers) {
+    if (is_fetching_.load()) {
+        throw std::logic_error("Cannot change thread placement while fetching");
+    }
+    fetch_placement_ = fetch_thread;
+    worker_placements_ = workers;
+}
+
+// Decode a record into events and publish them
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::ProcessRecord(
     const databento::Record& record,
     const databento::TsSymbolMap& symbol_map,
-    const std::string& dataset) {
+    const std::string& dataset,
+    Producer& producer) {
 
     (void)symbol_map;
     (void)dataset;
     
-    // Get BBO message
-    if (auto* bbo_msg = record.GetIf<databento::Bbo1MMsg>()) {
-        
-        // Create MarketDataPoint
-        MarketDataPoint data_point;
-        
-        // Convert timestamp (ts_event is in nanoseconds since UNIX epoch)
-        data_point.timestamp_delta = bbo_msg->ts_recv.time_since_epoch().count();
-        
-        // Set instrument ID
-        data_point.instrument_id = bbo_msg->hd.instrument_id;
-        
-        // Convert bid/ask prices from fixed-point to double
-        data_point.bid_px = ConvertPrice(bbo_msg->levels[0].bid_px);
-        data_point.ask_px = ConvertPrice(bbo_msg->levels[0].ask_px);
-        
-        // Set bid/ask sizes
-        data_point.bid_sz = bbo_msg->levels[0].bid_sz;
-        data_point.ask_sz = bbo_msg->levels[0].ask_sz;
-        
-        // Try to push to queue
+    visit_market_record(record, [&](const auto& msg) {
+        if (pacer_.active()) {
+            Pace(producer, record_ts_recv(msg));
+        }
+        decode_events(msg, [&](const auto& fill) { Emit(producer, fill); });
+    });
+}
+
+// Publish one decoded event
+template<typename QueueT>
+template<typename Fill>
+void BasicDatabentoHandler<QueueT>::Emit(Producer& producer, const Fill& fill) {
+    if constexpr (config::ZERO_COPY_PUBLISH) {
+        // Decode straight into the queue slot - no intermediate copy.
+        // Anything still spilled has to go out first to keep order.
         auto start_time = std::chrono::high_resolution_clock::now();
+        bool spill_pending = producer.spill && producer.spill->pending() > 0;
+        MarketDataPoint* slot = spill_pending ? nullptr : data_queue_->try_claim();
         
-        if (data_queue_->try_push(data_point)) {
-            // Success - update metrics
-            metrics_.messages_received.fetch_add(1);
+        if (slot) {
+            fill(*slot);
+            stamp_enqueue(slot, 1);
+            int64_t timestamp = slot->timestamp_delta;  // The slot is not ours after commit
+            data_queue_->commit(slot);
             
             auto end_time = std::chrono::high_resolution_clock::now();
-            auto latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
-            
-            metrics_.messages_processed.fetch_add(1);
-            metrics_.total_latency_ns.fetch_add(latency_ns);
-            
-            // Update max latency
-            uint64_t current_max = metrics_.max_latency_ns.load();
-            while (current_max < static_cast<uint64_t>(latency_ns) && 
-                   !metrics_.max_latency_ns.compare_exchange_weak(current_max, latency_ns)) {
-                // Retry if another thread updated max_latency_ns
-            }
-            
+            OnPublished(producer, 1, timestamp, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                end_time - start_time).count());
         } else {
-            // Queue full - increment overrun counter
-            metrics_.buffer_overruns.fetch_add(1);
-            
-            if (metrics_.buffer_overruns.load() % 1000 == 1) {
-                std::ostringstream oss;
-                oss << "Queue overrun detected. Queue utilization: " 
-                    << data_queue_->utilization() * 100.0 << "%";
-                if (error_callback_) {
-                    error_callback_(oss.str());
-                }
+            // Queue full (or spill pending) - let the overflow policy decide
+            MarketDataPoint data_point;
+            fill(data_point);
+            stamp_enqueue(&data_point, 1);
+            Publish(producer, &data_point, 1);
+        }
+    } else {
+        // Decode into the staging batch and publish once it is full
+        fill(producer.staging[producer.staged_count++]);
+        if (producer.staged_count == producer.staging.size()) {
+            FlushStaged(producer);
+        }
+    }
+}
+
+// Hold a record back until the replay schedule says it is due
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::Pace(Producer& producer, int64_t timestamp) {
+    int64_t due_in = pacer_.due_in_ns(timestamp);
+    if (due_in > 0) {
+        // Everything staged is already due, don't make it wait for this record
+        FlushStaged(producer);
+        pacer_.wait_until(timestamp, stop_requested_);
+    } else {
+        store_max(metrics_.replay_max_lag_ns, static_cast<uint64_t>(-due_in));
+    }
+}
+
+// Publish staged records
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::FlushStaged(Producer& producer) {
+    if (producer.staged_count == 0) {
+        return;
+    }
+    
+    // Queue latency starts here, so time blocked on a full queue counts
+    stamp_enqueue(producer.staging.data(), producer.staged_count);
+    Publish(producer, producer.staging.data(), producer.staged_count);
+    producer.staged_count = 0;
+}
+
+// Publish records, applying the overflow policy to whatever does not fit
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::Publish(Producer& producer, const MarketDataPoint* items, size_t count) {
+    // Spilled records go out first so consumers still see them in order
+    SpillFile<MarketDataPoint>* spill = producer.spill.get();
+    if (spill && spill->pending() > 0) {
+        DrainSpill(producer, false);
+        if (spill->pending() > 0) {
+            spill->append(items, count);
+            metrics_.records_spilled.fetch_add(count);
+            return;
+        }
+    }
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    size_t pushed = PushAvailable(items, count);
+    size_t spilled = 0;
+    
+    if (pushed < count) {
+        switch (overflow_policy_) {
+            case OverflowPolicy::Drop:
+                break;
+            case OverflowPolicy::Block:
+                pushed += PushBlocking(items + pushed, count - pushed);
+                break;
+            case OverflowPolicy::DropOldest:
+                pushed += PushEvicting(items + pushed, count - pushed);
+                break;
+            case OverflowPolicy::SpillToDisk:
+                spilled = count - pushed;
+                spill->append(items + pushed, spilled);
+                metrics_.records_spilled.fetch_add(spilled);
+                break;
+        }
+    }
+    
+    if (pushed > 0) {
+        // Latency of the publish (including any stall), amortised per record by avg_latency_us()
+        auto end_time = std::chrono::high_resolution_clock::now();
+        OnPublished(producer, pushed, items[pushed - 1].timestamp_delta,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+    }
+    
+    if (pushed + spilled < count) {
+        RecordOverruns(producer, count - pushed - spilled);
+    }
+}
+
+// Push as much as currently fits
+template<typename QueueT>
+size_t BasicDatabentoHandler<QueueT>::PushAvailable(const MarketDataPoint* items, size_t count) {
+    // A bulk push can come up short when the queue is nearly full, keep
+    // going until everything is in or the queue reports full
+    size_t pushed = 0;
+    while (pushed < count) {
+        size_t n = data_queue_->try_push_bulk(items + pushed, count - pushed);
+        if (n == 0) {
+            break;
+        }
+        pushed += n;
+    }
+    return pushed;
+}
+
+// Back off until the consumer makes room, a stop is requested or max_stall_ expires
+template<typename QueueT>
+size_t BasicDatabentoHandler<QueueT>::PushBlocking(const MarketDataPoint* items, size_t count) {
+    auto stall_start = std::chrono::steady_clock::now();
+    metrics_.backpressure_stalls.fetch_add(1);
+    
+    Backoff backoff;
+    size_t pushed = 0;
+    while (pushed < count && !stop_requested_.load(std::memory_order_relaxed)) {
+        size_t n = PushAvailable(items + pushed, count - pushed);
+        if (n > 0) {
+            pushed += n;
+            backoff.reset();
+            continue;
+        }
+        if (max_stall_.count() > 0 && std::chrono::steady_clock::now() - stall_start > max_stall_) {
+            break;
+        }
+        backoff.pause();
+    }
+    
+    auto stalled = std::chrono::steady_clock::now() - stall_start;
+    metrics_.backpressure_stall_ns.fetch_add(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stalled).count()));
+    return pushed;
+}
+
+// Evict the oldest queued records until the new ones fit
+template<typename QueueT>
+size_t BasicDatabentoHandler<QueueT>::PushEvicting(const MarketDataPoint* items, size_t count) {
+    if constexpr (DataQueue::MULTI_CONSUMER) {
+        std::array<MarketDataPoint, config::PUBLISH_BATCH_SIZE> evicted;
+        size_t pushed = 0;
+        while (true) {
+            pushed += PushAvailable(items + pushed, count - pushed);
+            if (pushed == count) {
+                break;
             }
+            size_t wanted = std::min(count - pushed, evicted.size());
+            // Zero means consumers drained it in the meantime, just retry
+            metrics_.records_evicted.fetch_add(data_queue_->try_pop_bulk(evicted.data(), wanted));
         }
+        return pushed;
+    } else {
+        // Rejected in SetOverflowPolicy, a single consumer queue cannot be popped here
+        (void)items;
+        (void)count;
+        return 0;
     }
 }
 
-// Convert fixed-point price to double
-double DatabentoHandler::ConvertPrice(int64_t fixed_price) const {
-    if (fixed_price == UNDEF_PRICE) {
-        return 0.0;  // Undefined price
+// Feed spilled records back into the queue, oldest first
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::DrainSpill(Producer& producer, bool block) {
+    std::array<MarketDataPoint, config::PUBLISH_BATCH_SIZE> chunk;
+    Backoff backoff;
+    SpillFile<MarketDataPoint>& spill = *producer.spill;
+    
+    while (spill.pending() > 0) {
+        size_t n = spill.peek(chunk.data(), chunk.size());
+        if (n == 0) {
+            break;  // Read error, leave it pending
+        }
+        
+        stamp_enqueue(chunk.data(), n);  // Time on disk is not queue time
+        auto start_time = std::chrono::high_resolution_clock::now();
+        size_t pushed = PushAvailable(chunk.data(), n);
+        spill.consume(pushed);
+        
+        if (pushed > 0) {
+            auto end_time = std::chrono::high_resolution_clock::now();
+            OnPublished(producer, pushed, chunk[pushed - 1].timestamp_delta,
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+            backoff.reset();
+        }
+        
+        if (pushed < n) {
+            if (!block || stop_requested_.load(std::memory_order_relaxed)) {
+                break;
+            }
+            backoff.pause();
+        }
+    }
+}
+
+// Records are in the queue: wake, advance the watermark, count
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::OnPublished(Producer& producer, size_t count,
+                                                int64_t last_timestamp, int64_t latency_ns) {
+    if (producer.lane >= 0) {
+        watermark_.advance(static_cast<size_t>(producer.lane), last_timestamp);
+    }
+    if (consumer_signal_) {
+        consumer_signal_->notify();
+    }
+    if (pacer_.active()) {
+        // Depth under a realistic arrival pattern is the interesting number
+        store_max(metrics_.max_queue_depth, data_queue_->size());
     }
-    return static_cast<double>(fixed_price) / PRICE_SCALE;
+    RecordPushLatency(producer, count, latency_ns);
+}
+
+// Account for successfully published records
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::RecordPushLatency(Producer& producer, size_t count, int64_t latency_ns) {
+    // Only this producer writes its block; messages_processed is the consumers' count
+    ThreadMetrics& metrics = *producer.metrics;
+    auto latency = static_cast<uint64_t>(latency_ns);
+    metrics.messages_received.add(count);
+    metrics.total_latency_ns.add(latency);
+    metrics.max_latency_ns.raise(latency);
+    metrics.push_latency.record(latency);
+}
+
+// Queue full - count every dropped record as an overrun
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::RecordOverruns(Producer& producer, size_t dropped) {
+    uint64_t before = producer.metrics->buffer_overruns.load();
+    producer.metrics->buffer_overruns.add(dropped);
+    
+    // Report on the 1st, 1001st, ... overrun
+    if ((before + 999) / 1000 != (before + dropped + 999) / 1000) {
+        if (producer.log) {
+            producer.log->log(QUEUE_OVERRUN_LOG, data_queue_->utilization() * 100.0);
+        } else if (error_callback_) {
+            std::ostringstream oss;
+            oss << "Queue overrun detected. Queue utilization: " 
+                << data_queue_->utilization() * 100.0 << "%";
+            error_callback_(oss.str());
+        }
+    }
+}
+
+// Producer log channels: the primary one now, worker slots as fetches need them
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::SetLogger(AsyncLogger* logger) {
+    logger_ = logger;
+    worker_logs_.clear();
+    primary_.log = logger ? &logger->register_thread("fetch") : nullptr;
 }
 
 // Async fetch worker
-void DatabentoHandler::AsyncFetchWorker(
+template<typename QueueT>
+void BasicDatabentoHandler<QueueT>::AsyncFetchWorker(
     const std::string& dataset,
     const std::vector<std::string>& symbols,
     const std::string& start_time,
@@ -243,6 +842,7 @@ void DatabentoHandler::AsyncFetchWorker(
     const std::string& schema,
     databento::SType stype_in) {
     
+    placements_.record("fetch", apply_thread_placement(fetch_placement_));
     try {
         // Set fetching flag at the beginning of actual work
         is_fetching_ = true;
@@ -259,4 +859,11 @@ void DatabentoHandler::AsyncFetchWorker(
     is_fetching_ = false;
 }
 
+// Queue policies the handler is built for
+template class BasicDatabentoHandler<LockFreeRingBuffer<MarketDataPoint, SlotLayout::Padded>>;
+template class BasicDatabentoHandler<LockFreeRingBuffer<MarketDataPoint, SlotLayout::Dense>>;
+template class BasicDatabentoHandler<SpscRingBuffer<MarketDataPoint>>;
+template class BasicDatabentoHandler<CompactRingBuffer>;
+template class BasicDatabentoHandler<SharedDataQueue>;
+
 } // namespace market_data
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "../include/LiveHandler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace market_data {
+
+// Constructor
+template<typename QueueT>
+BasicLiveHandler<QueueT>::BasicLiveHandler(const std::string& api_key, size_t queue_size,
+                                           const MemoryOptions& queue_memory)
+    : api_key_(api_key),
+      data_queue_(std::make_unique<DataQueue>(queue_size, queue_memory)),
+      receive_metrics_(metrics_.register_thread()) {
+    if (api_key_.empty()) {
+        throw std::invalid_argument("Databento API key is empty");
+    }
+    TscClock::instance();  // Calibrate now rather than on the first enqueue stamp
+}
+
+// Destructor
+template<typename QueueT>
+BasicLiveHandler<QueueT>::~BasicLiveHandler() {
+    Stop();
+}
+
+// Create from environment
+template<typename QueueT>
+std::unique_ptr<BasicLiveHandler<QueueT>> BasicLiveHandler<QueueT>::CreateFromEnv(
+    size_t queue_size, const MemoryOptions& queue_memory) {
+    const char* api_key_env = std::getenv("DATABENTO_API_KEY");
+    if (!api_key_env) {
+        throw std::runtime_error("DATABENTO_API_KEY environment variable not set");
+    }
+    return std::make_unique<BasicLiveHandler>(std::string(api_key_env), queue_size, queue_memory);
+}
+
+// Subscribe and start the session
+template<typename QueueT>
+void BasicLiveHandler<QueueT>::Start(const SourceRequest& request) {
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    if (is_running_.load()) {
+        ReportError("Live session already running");
+        return;
+    }
+
+    databento::Schema schema;
+    if (!parse_schema(request.schema, schema)) {
+        std::ostringstream oss;
+        oss << "Unsupported live schema: " << request.schema;
+        ReportError(oss.str());
+        return;
+    }
+
+    try {
+        metrics_.Reset();
+        stop_requested_ = false;
+        pin_pending_ = true;
+        receive_pinned_ = false;
+        placements_.clear();
+        mapped_ids_.clear();
+
+        client_ = std::make_unique<databento::LiveThreaded>(
+            databento::LiveThreaded::Builder()
+                .SetKey(api_key_)
+                .SetDataset(request.dataset)
+                .BuildThreaded());
+        client_->Subscribe(request.symbols, schema, request.stype_in);
+
+        is_running_ = true;
+        client_->Start(
+            [](databento::Metadata&&) {},
+            [this](const databento::Record& record) { return OnRecord(record); },
+            [this](const std::exception& e) { return OnException(e); });
+    } catch (const std::exception& e) {
+        is_running_ = false;
+        client_.reset();
+        std::ostringstream oss;
+        oss << "Failed to start live session: " << e.what();
+        ReportError(oss.str());
+    }
+}
+
+// End the session
+template<typename QueueT>
+void BasicLiveHandler<QueueT>::Stop() {
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    stop_requested_ = true;
+    // Destroying the client stops the session and joins its receive thread
+    client_.reset();
+    is_running_ = false;
+}
+
+// Receive thread: decode and enqueue
+template<typename QueueT>
+databento::KeepGoing BasicLiveHandler<QueueT>::OnRecord(const databento::Record& record) {
+    if (pin_pending_) {
+        pin_pending_ = false;
+        PlacementStatus status = apply_thread_placement(receive_placement_);
+        receive_pinned_ = status.pinned;
+        placements_.record("live receive", status);
+    }
+    if (stop_requested_.load(std::memory_order_relaxed)) {
+        return databento::KeepGoing::Stop;
+    }
+
+    bool decoded = visit_market_record(record, [this](const auto& msg) {
+        decode_events(msg, [this](const auto& fill) {
+            MarketDataPoint data_point;
+            fill(data_point);
+            stamp_enqueue(&data_point, 1);
+            Publish(data_point);
+        });
+    });
+    if (!decoded) {
+        if (auto* mapping = record.GetIf<databento::SymbolMappingMsg>()) {
+            AddInstrument(mapping->hd.instrument_id);
+        }
+        // System messages, ...
+    }
+    return databento::KeepGoing::Continue;
+}
+
+// Push one record, never blocking the receive thread
+template<typename QueueT>
+void BasicLiveHandler<QueueT>::Publish(const MarketDataPoint& data_point) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    ThreadMetrics& metrics = receive_metrics_;  // Receive thread is the only writer
+
+    if (!data_queue_->try_push(data_point)) {
+        uint64_t before = metrics.buffer_overruns.load();
+        metrics.buffer_overruns.add(1);
+        if (before % 1000 == 0) {
+            if (receive_log_) {
+                receive_log_->log(QUEUE_OVERRUN_LOG, data_queue_->utilization() * 100.0);
+            } else {
+                std::ostringstream oss;
+                oss << "Queue overrun detected. Queue utilization: "
+                    << data_queue_->utilization() * 100.0 << "%";
+                ReportError(oss.str());
+            }
+        }
+        return;
+    }
+    metrics.messages_received.add(1);  // Published records only, like the historical handler
+    if (consumer_signal_) {
+        consumer_signal_->notify();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto push_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+    metrics.total_latency_ns.add(push_ns);
+    metrics.max_latency_ns.raise(push_ns);
+    metrics.push_latency.record(push_ns);
+
+    // Gateway receive -> in our queue, both on the system clock
+    int64_t enqueued_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t feed_ns = enqueued_ns - data_point.timestamp_delta;
+    if (feed_ns > 0) {
+        metrics.feed_latency.record(static_cast<uint64_t>(feed_ns));
+    }
+}
+
+// Publish the ids the gateway has mapped so far (cold: once per symbol)
+template<typename QueueT>
+void BasicLiveHandler<QueueT>::AddInstrument(uint32_t instrument_id) {
+    auto it = std::lower_bound(mapped_ids_.begin(), mapped_ids_.end(), instrument_id);
+    if (it != mapped_ids_.end() && *it == instrument_id) {
+        return;
+    }
+    mapped_ids_.insert(it, instrument_id);
+    instruments_.Publish(mapped_ids_);
+}
+
+// Session errors (disconnects, auth, ...)
+template<typename QueueT>
+databento::ExceptionAction BasicLiveHandler<QueueT>::OnException(const std::exception& e) {
+    std::ostringstream oss;
+    oss << "Live session error: " << e.what();
+    ReportError(oss.str());
+    if (stop_requested_.load()) {
+        is_running_ = false;
+        return databento::ExceptionAction::Stop;
+    }
+    return databento::ExceptionAction::Restart;  // Reconnect and resubscribe
+}
+
+template<typename QueueT>
+void BasicLiveHandler<QueueT>::ReportError(const std::string& message) {
+    if (error_callback_) {
+        error_callback_(message);
+    }
+}
+
+// Queue policies the handler is built for
+template class BasicLiveHandler<LockFreeRingBuffer<MarketDataPoint, SlotLayout::Padded>>;
+template class BasicLiveHandler<LockFreeRingBuffer<MarketDataPoint, SlotLayout::Dense>>;
+template class BasicLiveHandler<SpscRingBuffer<MarketDataPoint>>;
+template class BasicLiveHandler<CompactRingBuffer>;
+template class BasicLiveHandler<SharedDataQueue>;
+
+} // namespace market_data
@@ -1,13 +1,30 @@
+#include "../include/AsyncLogger.hpp"
+#include "../include/BatchAnalytics.hpp"
 #include "../include/DatabentoHandler.hpp"
+#include "../include/LiveHandler.hpp"
 #include "../include/LockFreeRingBuffer.hpp"
+#include "../include/MetricsExporter.hpp"
+#include "../include/MulticastFeed.hpp"
 #include "../include/Types.hpp"
 #include "../include/Config.hpp"
+#include "../include/InstrumentTable.hpp"
+#include "../include/JobScheduler.hpp"
+#include "../include/ReorderBuffer.hpp"
+#include "../include/ReplayPacer.hpp"
+#include "../include/RuntimeConfig.hpp"
+#include "../include/ShardedPipeline.hpp"
+#include "../include/SharedQueueFeed.hpp"
+#include "../include/StreamTaps.hpp"
+#include <algorithm>
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <array>
 #include <signal.h>
-#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 using namespace market_data;
 
@@ -20,155 +37,939 @@ void signal_handler(int sig) {
     running = false;
 }
 
-// Consumer function that reads from the queue
-void consumer_thread(LockFreeRingBuffer<MarketDataPoint, 1024 * 1024>& queue,
-                     PerformanceMetrics& metrics) {
-    MarketDataPoint dp;
+// Consumers of several job workers print their final summaries one at a time
+std::mutex summary_mutex;
+
+// Top-of-book line for the final summaries
+void print_book(const OrderBook& book) {
+    if (!book.has_top()) {
+        return;
+    }
+    std::cout << "  Book: bid " << price_to_double(book.levels[0].bid_px) << " x " << book.levels[0].bid_sz
+              << " / ask " << price_to_double(book.levels[0].ask_px) << " x " << book.levels[0].ask_sz
+              << ", spread=" << book.spread()
+              << ", microprice=" << book.microprice()
+              << ", imbalance=" << book.imbalance()
+              << " (" << book.updates << " updates)\n";
+}
+
+// Trailing-window line per configured window, e.g. "1s", "1m", "5m"
+void print_rolling(const RollingStats& rolling) {
+    for (size_t i = 0; i < RollingStats::size(); ++i) {
+        const auto& window = rolling.windows[i];
+        int64_t seconds = window.window_ns() / 1000000000LL;
+        std::cout << "  Last ";
+        if (seconds >= 60 && seconds % 60 == 0) {
+            std::cout << seconds / 60 << "m";
+        } else if (seconds > 0) {
+            std::cout << seconds << "s";
+        } else {
+            std::cout << window.window_ns() / 1000000 << "ms";
+        }
+        std::cout << ": VWAP=" << window.vwap()
+                  << ", volatility=" << window.volatility()
+                  << ", avg spread=" << window.avg_spread()
+                  << " (" << window.trades() << " trades)\n";
+    }
+}
+
+// One line of latency percentiles from a merged histogram (ns)
+void print_latency(const char* name, const HistogramSnapshot& latency) {
+    std::cout << name << ": p50 " << latency.percentile(50.0)
+              << " ns, p99 " << latency.percentile(99.0)
+              << " ns, p99.9 " << latency.percentile(99.9)
+              << " ns, max " << latency.max << " ns (" << latency.count << " samples)\n";
+}
+
+void print_latency(const char* name, const LatencyHistogram& histogram) {
+    HistogramSnapshot latency;
+    latency.add(histogram);
+    print_latency(name, latency);
+}
+
+// Encoding stats; only the compact queue has any
+template<typename Queue>
+void print_queue_encoding(const Queue&) {}
+
+void print_queue_encoding(const CompactRingBuffer& queue) {
+    uint64_t encoded = queue.encoded_records();
+    std::cout << "Compact queue: " << encoded << " records, " << queue.escaped_records() << " escaped ("
+              << (encoded ? 100.0 * static_cast<double>(queue.escaped_records()) / static_cast<double>(encoded) : 0.0)
+              << "%)\n";
+}
+
+// Per-instrument queue / processing latency (TRACK_RECORD_LATENCY)
+void print_record_latency(const RecordLatency& latency) {
+    if (latency.samples == 0) {
+        return;
+    }
+    std::cout << "  Latency: queue avg " << latency.avg_queue_us() << " μs (max "
+              << static_cast<double>(latency.queue_ns_max) / 1000.0 << " μs), processing avg "
+              << latency.avg_process_us() << " μs (max "
+              << static_cast<double>(latency.process_ns_max) / 1000.0 << " μs)\n";
+}
+
+// Consumer output, formatted by the logger thread (see AsyncLogger.hpp)
+constexpr LogFormat SAMPLE_TRADE_LOG{LogLevel::Info,
+    "Sample data point {}:\n  Instrument ID: {}\n  Trade: {} x {} (aggressor {})\n"
+    "  Timestamp: {}\n  VWAP[{}]: {}\n"};
+constexpr LogFormat SAMPLE_QUOTE_LOG{LogLevel::Info,
+    "Sample data point {}:\n  Instrument ID: {}\n  Bid: {} @ {}\n  Ask: {} @ {}\n"
+    "  Timestamp: {}\n  VWAP[{}]: {}\n"};
+constexpr LogFormat SAMPLE_LEVEL_LOG{LogLevel::Info,
+    "Sample data point {}:\n  Instrument ID: {}\n  Level: {}\n  Bid: {} @ {}\n  Ask: {} @ {}\n"
+    "  Timestamp: {}\n  VWAP[{}]: {}\n"};
+constexpr LogFormat STATUS_REPORT_LOG{LogLevel::Info,
+    "=== Consumer Status Report ===\nProcessed: {}\nQueue size: {}\nQueue utilization: {}%\n"
+    "Messages received: {}\nBuffer overruns: {}\nProducer stalled: {} ms\nAvg latency: {} μs"};
+constexpr LogFormat LATENCY_LOG{LogLevel::Info,
+    "{}: p50 {} ns, p99 {} ns, p99.9 {} ns, max {} ns ({} samples)"};
+constexpr LogFormat PUSH_SUCCESS_LOG{LogLevel::Info, "Push success rate: {}%"};
+constexpr LogFormat CONSUMER_LAG_LOG{LogLevel::Info,
+    "Consumer lag vs schedule: avg {} μs, max {} μs\nMax queue depth: {}"};
+constexpr LogFormat INSTRUMENT_VWAP_LOG{LogLevel::Info,
+    "VWAP[{}]: {} (trades={}, quotes={}, levels={})"};
+constexpr LogFormat STATUS_END_LOG{LogLevel::Info, "===============================\n"};
+
+// print_latency through a log channel; name must be a literal
+void log_latency(LogChannel& log, const char* name, const HistogramSnapshot& latency) {
+    log.log(LATENCY_LOG, name, latency.percentile(50.0), latency.percentile(99.0),
+            latency.percentile(99.9), latency.max, latency.count);
+}
+
+// Consumer function that reads from the queue; Wait decides what to do
+// when the queue is empty (see WaitStrategy.hpp). Returns once the queue is
+// closed and drained, or on shutdown
+template<typename Wait>
+void consumer_thread(DatabentoHandler::DataQueue& queue,
+                     PerformanceMetrics& metrics,
+                     const InstrumentUniverse& instruments,
+                     const FetchWatermark& watermark,
+                     const ReplayPacer& pacer,
+                     ThreadPlacement placement,
+                     PlacementLog& placements,
+                     StreamTaps taps,
+                     InstrumentCounters& instrument_counts,
+                     AsyncLogger& logger,
+                     Wait wait) {
+    placements.record("consumer", apply_thread_placement(placement));
+    LogChannel& log = logger.register_thread("consumer");
+    std::array<MarketDataPoint, config::CONSUMER_BATCH_SIZE> batch;
     size_t processed = 0;
     auto last_report = std::chrono::steady_clock::now();
+    ThreadMetrics& thread_metrics = metrics.register_thread();  // This thread's counters
+
+    // Per-instrument stats (VWAP + counters), pre-sized from the fetch's symbology
+    InstrumentTable<InstrumentStats> instrument_stats(config::INSTRUMENT_TABLE_CAPACITY, &instruments);
+    instrument_stats.sync();
+
+    // Lag behind the replay schedule (paced replays only)
+    int64_t lag_sum_ns = 0;
+    int64_t lag_max_ns = 0;
+    size_t lag_samples = 0;
+
+    auto track_lag = [&](const MarketDataPoint& dp) {
+        int64_t lag = pacer.lag_ns(dp.timestamp_delta);
+        lag_sum_ns += lag;
+        lag_max_ns = std::max(lag_max_ns, lag);
+        lag_samples++;
+    };
 
-    // Per-instrument stats (VWAP + counters)
-    std::unordered_map<int, InstrumentStats> instrument_stats;
+    // Queued for the logger thread, so sampling never blocks on stdout
+    auto print_sample = [&](const MarketDataPoint& dp, const InstrumentStats& stats) {
+        if (dp.type == EventType::Trade) {
+            log.log(SAMPLE_TRADE_LOG, processed, dp.instrument_id, price_to_double(dp.trade_px()),
+                    dp.trade_sz(), dp.side, dp.timestamp_delta, dp.instrument_id, stats.vwap_tracker.vwap());
+        } else if (dp.type == EventType::BookLevel) {
+            log.log(SAMPLE_LEVEL_LOG, processed, dp.instrument_id, dp.level,
+                    price_to_double(dp.bid_px), dp.bid_sz, price_to_double(dp.ask_px), dp.ask_sz,
+                    dp.timestamp_delta, dp.instrument_id, stats.vwap_tracker.vwap());
+        } else {
+            log.log(SAMPLE_QUOTE_LOG, processed, dp.instrument_id,
+                    price_to_double(dp.bid_px), dp.bid_sz, price_to_double(dp.ask_px), dp.ask_sz,
+                    dp.timestamp_delta, dp.instrument_id, stats.vwap_tracker.vwap());
+        }
+    };
+
+    // Queue / processing latency per record (TRACK_RECORD_LATENCY)
+    const TscClock& clock = TscClock::instance();
+    uint64_t dequeued_tsc = 0;  // When the records being processed left the queue
+
+    auto process_point = [&](const MarketDataPoint& dp) {
+        processed++;
+        taps.append(dp);
+        if (pacer.active()) {
+            track_lag(dp);
+        }
+
+        // VWAP from trade prints; quotes and book levels are counted
+        InstrumentStats* stats = instrument_stats.find_or_add(dp.instrument_id);
+        if (!stats) {
+            return;  // Table full, counted in overflow_count()
+        }
+        stats->update(dp);
+        instrument_counts.add(instrument_stats.slot_of(stats), dp.instrument_id);
+        if constexpr (config::TRACK_RECORD_LATENCY) {
+            record_consumer_latency(dp, dequeued_tsc, clock.ticks(), thread_metrics, *stats);
+        }
+
+        // Sample records 1, SAMPLE_PRINT_EVERY + 1, ...
+        if (config::ENABLE_SAMPLE_OUTPUT && processed % config::SAMPLE_PRINT_EVERY == 1 % config::SAMPLE_PRINT_EVERY) {
+            print_sample(dp, *stats);
+        }
+    };
+
+    // Column kernels for whole batches (bulk pop path, double prices)
+    constexpr bool soa_batches = config::CONSUMER_SOA_BATCH && !config::FIXED_POINT_PRICES;
+    BatchAnalytics<config::CONSUMER_BATCH_SIZE> analytics;
+
+    // Restores timestamp order behind a chunked (multi-producer) fetch
+    ReorderBuffer reorder(config::CONSUMER_BATCH_SIZE);
 
     while (running.load()) {
-        if (queue.try_pop(dp)) {
-            processed++;
-            metrics.messages_processed.fetch_add(1, std::memory_order_relaxed);
-
-            // Midpoint + approximate size as "trade"
-            double qty = (dp.bid_sz + dp.ask_sz) / 2.0;
-            double mid = (dp.bid_px + dp.ask_px) / 2.0;
-            instrument_stats[dp.instrument_id].update(mid, qty);
-
-            // Print sample data every 1000 messages
-            if (processed % 1000 == 1) {
-                std::cout << "Sample data point " << processed << ":\n";
-                std::cout << "  Instrument ID: " << dp.instrument_id << "\n";
-                std::cout << "  Bid: " << dp.bid_px << " @ " << dp.bid_sz << "\n";
-                std::cout << "  Ask: " << dp.ask_px << " @ " << dp.ask_sz << "\n";
-                std::cout << "  Timestamp: " << dp.timestamp_delta << "\n";
-                std::cout << "  VWAP[" << dp.instrument_id << "]: "
-                          << instrument_stats[dp.instrument_id].vwap_tracker.vwap()
-                          << "\n\n";
+        // Read before popping: closed and then empty means every record was seen
+        bool closed = queue.closed();
+        size_t popped = 0;
+        size_t processed_before = processed;
+        if (watermark.active() || reorder.pending() > 0) {
+            // Time held for reordering counts as queue time
+            if constexpr (config::TRACK_RECORD_LATENCY) {
+                dequeued_tsc = clock.ticks();
+            }
+            popped = reorder.pump(queue, watermark, process_point);
+        } else if constexpr (config::ZERO_COPY_PUBLISH) {
+            // Read records in place and hand each slot straight back
+            while (popped < config::CONSUMER_BATCH_SIZE) {
+                const MarketDataPoint* dp = queue.try_peek();
+                if (!dp) {
+                    break;
+                }
+                if constexpr (config::TRACK_RECORD_LATENCY) {
+                    dequeued_tsc = clock.ticks();
+                }
+                process_point(*dp);
+                queue.release(dp);
+                popped++;
             }
         } else {
-            // No data available, small delay to prevent busy waiting
-            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            popped = queue.try_pop_bulk(batch.data(), batch.size());
+            if constexpr (config::TRACK_RECORD_LATENCY) {
+                dequeued_tsc = clock.ticks();
+            }
+            if constexpr (soa_batches) {
+                taps.append(batch.data(), popped);
+                analytics.process(batch.data(), popped, instrument_stats,
+                                  [&](const MarketDataPoint* run, size_t n, InstrumentStats& stats) {
+                    instrument_counts.add(instrument_stats.slot_of(&stats), run->instrument_id, n);
+                    if constexpr (config::TRACK_RECORD_LATENCY) {
+                        // The run is folded in at once
+                        uint64_t updated_tsc = clock.ticks();
+                        for (size_t i = 0; i < n; ++i) {
+                            record_consumer_latency(run[i], dequeued_tsc, updated_tsc, thread_metrics, stats);
+                        }
+                    }
+                });
+                if (pacer.active()) {
+                    for (size_t i = 0; i < popped; ++i) {
+                        track_lag(batch[i]);
+                    }
+                }
+                // Same sampling as the scalar path: records 1, SAMPLE_PRINT_EVERY + 1, ...
+                constexpr size_t every = config::SAMPLE_PRINT_EVERY;
+                size_t next_sample = (processed + every - 1) / every * every + 1;
+                processed += popped;
+                if (config::ENABLE_SAMPLE_OUTPUT && popped > 0 && next_sample <= processed) {
+                    const MarketDataPoint& dp = batch[next_sample - (processed - popped) - 1];
+                    if (const InstrumentStats* stats = instrument_stats.get(dp.instrument_id)) {
+                        print_sample(dp, *stats);
+                    }
+                }
+            } else {
+                for (size_t i = 0; i < popped; ++i) {
+                    process_point(batch[i]);
+                }
+            }
+        }
+
+        if (processed != processed_before) {
+            // Records held for reordering count once they are processed
+            thread_metrics.messages_processed.add(processed - processed_before);
+        }
+        if (popped > 0) {
+            taps.flush();
+            wait.reset();
+        } else if (closed && queue.empty()) {
+            break;  // End of stream; the reorder stage is flushed below
+        } else {
+            // No data available, back off according to the wait strategy
+            wait.idle([&queue] { return !queue.empty() || queue.closed() || !running.load(); });
         }
 
         // Report metrics every 5 seconds
         auto now = std::chrono::steady_clock::now();
         if (now - last_report > std::chrono::seconds(5)) {
-            std::cout << "=== Consumer Status Report ===\n";
-            std::cout << "Processed: " << processed << "\n";
-            std::cout << "Queue size: " << queue.size() << "\n";
-            std::cout << "Queue utilization: " << queue.utilization() * 100.0 << "%\n";
-            std::cout << "Messages received: " << metrics.messages_received.load() << "\n";
-            std::cout << "Buffer overruns: " << metrics.buffer_overruns.load() << "\n";
-            std::cout << "Avg latency: " << metrics.avg_latency_us() << " μs\n";
-            std::cout << "Push success rate: " << metrics.push_success_rate() * 100.0 << "%\n";
+            log.log(STATUS_REPORT_LOG, processed, queue.size(), queue.utilization() * 100.0,
+                    metrics.messages_received(), metrics.buffer_overruns(),
+                    metrics.backpressure_stall_ns.load() / 1000000, metrics.avg_latency_us());
+            log_latency(log, "Push latency", metrics.push_latency());
+            if (config::TRACK_RECORD_LATENCY) {
+                log_latency(log, "End-to-end latency", metrics.end_to_end_latency());
+            }
+            log.log(PUSH_SUCCESS_LOG, metrics.push_success_rate() * 100.0);
+            if (lag_samples > 0) {
+                log.log(CONSUMER_LAG_LOG, static_cast<double>(lag_sum_ns) / static_cast<double>(lag_samples) / 1000.0,
+                        static_cast<double>(lag_max_ns) / 1000.0, metrics.max_queue_depth.load());
+                lag_sum_ns = 0;
+                lag_max_ns = 0;
+                lag_samples = 0;
+            }
 
             // Per-instrument VWAP summary
-            for (auto& [id, stats] : instrument_stats) {
-                std::cout << "VWAP[" << id << "]: "
-                          << stats.vwap_tracker.vwap()
-                          << " (trades=" << stats.trades_processed << ")\n";
-            }
+            instrument_stats.for_each([&log](int id, const InstrumentStats& stats) {
+                log.log(INSTRUMENT_VWAP_LOG, id, stats.vwap_tracker.vwap(), stats.trades_processed,
+                        stats.quotes_processed, stats.book_updates);
+            });
 
-            std::cout << "===============================\n\n";
+            log.log(STATUS_END_LOG);
             last_report = now;
         }
     }
 
+    size_t processed_before = processed;
+    reorder.flush(process_point);
+    thread_metrics.messages_processed.add(processed - processed_before);
+    taps.flush();
+    log.sync();  // The summary below goes straight to stdout
+    std::lock_guard<std::mutex> summary_lock(summary_mutex);
+
     // Final VWAP summary before exit
     std::cout << "\n=== Final VWAP Summary ===\n";
-    for (auto& [id, stats] : instrument_stats) {
+    instrument_stats.for_each([](int id, const InstrumentStats& stats) {
         std::cout << "Instrument " << id
                   << " VWAP=" << stats.vwap_tracker.vwap()
-                  << " (trades=" << stats.trades_processed << ")\n";
+                  << " (trades=" << stats.trades_processed
+                  << ", quotes=" << stats.quotes_processed
+                  << ", levels=" << stats.book_updates << ")\n";
+        print_book(stats.book);
+        print_rolling(stats.rolling);
+        print_record_latency(stats.latency);
+    });
+    if (instrument_stats.overflow_count() > 0) {
+        std::cout << "Untracked (instrument table full): " << instrument_stats.overflow_count() << "\n";
     }
     std::cout << "===========================\n";
 
     std::cout << "Consumer thread exiting. Total processed: " << processed << std::endl;
 }
 
-int main() {
+// Startup verification: where each engine thread actually ended up
+void print_placements(const std::vector<PlacementLog::Entry>& entries) {
+    for (const auto& entry : entries) {
+        std::cout << "  " << entry.role << ": " << entry.status.describe()
+                  << (entry.status.ok() ? "" : "  <-- requested placement not applied") << "\n";
+    }
+}
+
+// Periodic report for the sharded pipeline, merged across shards
+// While the pipeline runs: only counters the shard workers publish, never
+// their stats tables (the final VWAP summary merges those after Drain())
+void print_sharded_report(const ShardedPipeline<EngineDataQueue>& pipeline,
+                          const PerformanceMetrics& metrics) {
+    std::cout << "=== Sharded Pipeline Report ===\n";
+    std::cout << "Messages received: " << metrics.messages_received() << "\n";
+    std::cout << "Buffer overruns: " << metrics.buffer_overruns() << "\n";
+    for (size_t i = 0; i < pipeline.num_shards(); ++i) {
+        std::cout << "Shard " << i << ": processed=" << pipeline.shard_processed(i)
+                  << " queued=" << pipeline.shard_queue_size(i)
+                  << (pipeline.shard_pinned(i) ? " (pinned)" : "") << "\n";
+        if (config::TRACK_RECORD_LATENCY) {
+            print_latency("  Queue latency (from enqueue)", pipeline.shard_metrics(i).queue_latency);
+        }
+        pipeline.shard_instruments(i).for_each([](int32_t id, uint64_t messages) {
+            std::cout << "  Instrument " << id << ": " << messages << " records\n";
+        });
+    }
+    std::cout << "===============================\n\n";
+}
+
+// Network settings shared by the multicast publisher and subscriber
+MulticastOptions multicast_options() {
+    MulticastOptions options;
+    options.group = config::MULTICAST_GROUP;
+    options.port = config::MULTICAST_PORT;
+    options.interface = config::MULTICAST_INTERFACE;
+    options.ttl = config::MULTICAST_TTL;
+    options.loopback = config::MULTICAST_LOOPBACK;
+    options.payload_bytes = config::MULTICAST_PAYLOAD_BYTES;
+    options.busy_poll_us = config::MULTICAST_BUSY_POLL_US;
+    return options;
+}
+
+int main(int argc, char** argv) {
+    // Compile-time defaults from Config.hpp, overridden by --config / --key value
+    EngineSettings settings;
+    try {
+        settings = load_settings(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid settings: " << e.what() << "\n\n" << settings_usage(argv[0]);
+        return 2;
+    }
+    if (settings.help) {
+        std::cout << settings_usage(argv[0]);
+        return 0;
+    }
+
     // Set up signal handler
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
     std::cout << "=== Databento MPMC Queue Demo ===\n";
-    std::cout << "This demo fetches historical BBO data and processes it using\n";
+    std::cout << "This demo fetches historical (or live) market data and processes it using\n";
     std::cout << "a multi-producer multi-consumer lock-free queue.\n\n";
 
+    if (config::LOCK_MEMORY) {
+        std::cout << "Memory lock (mlockall): "
+                  << (lock_process_memory() ? "ok" : "FAILED (needs CAP_IPC_LOCK or RLIMIT_MEMLOCK)") << "\n";
+    }
+
     try {
-        // Create Databento handler using environment variable for API key
-        std::cout << "Creating Databento handler...\n";
-        auto handler = DatabentoHandler::CreateFromEnv(config::QUEUE_SIZE);
+        // Hot-path output (samples, status reports, overruns) goes through the
+        // logger thread; created first so it outlives every thread that logs
+        AsyncLogger::Options log_options;
+        log_options.queue_size = config::LOG_QUEUE_SIZE;
+        log_options.flush_interval = std::chrono::microseconds(config::LOG_FLUSH_INTERVAL_US);
+        log_options.placement.core = config::LOG_CORE;
+        log_options.queue_memory.use_huge_pages = false;  // A few MiB per thread
+        AsyncLogger logger(log_options);
+        logger.Start();
+
+        // Create the data source using environment variable for API key.
+        // Unbound queues go on the NUMA node of the thread that drains them.
+        int draining_core = config::NUM_SHARDS > 0 ? config::ROUTER_CORE : config::CONSUMER_CORE;
+        MemoryOptions queue_memory;
+        queue_memory.use_huge_pages = config::QUEUE_USE_HUGE_PAGES;
+        queue_memory.numa_node = config::QUEUE_NUMA_NODE >= 0 ? config::QUEUE_NUMA_NODE
+                                                              : numa_node_of_core(draining_core);
+        // With QUEUE_SHARED_MEMORY the source's queue is a named segment that
+        // consumer processes attach to, and this process only produces
+        MemoryOptions source_memory = queue_memory;
+        if (config::QUEUE_SHARED_MEMORY) {
+            source_memory.shared_name = config::SHARED_QUEUE_NAME;
+        }
+        const bool shared_attach = config::SHARED_QUEUE_ATTACH;
+        const bool shared_producer = config::QUEUE_SHARED_MEMORY && !shared_attach;
+
+        std::unique_ptr<MarketDataSource<EngineDataQueue>> source;
+        DatabentoHandler* historical = nullptr;
+        MulticastSubscriber* subscriber = nullptr;
+        if (shared_attach) {
+            std::cout << "Attaching to shared queue " << config::SHARED_QUEUE_NAME << "...\n";
+            source = std::make_unique<SharedQueueFeed>(
+                config::SHARED_QUEUE_NAME, std::chrono::milliseconds(config::SHARED_QUEUE_ATTACH_TIMEOUT_MS));
+        } else if (config::USE_MULTICAST_FEED) {
+            if (config::MULTICAST_PUBLISH) {
+                throw std::invalid_argument("MULTICAST_PUBLISH with USE_MULTICAST_FEED would feed the group to itself");
+            }
+            std::cout << "Creating multicast subscriber...\n";
+            auto multicast = std::make_unique<MulticastSubscriber>(multicast_options(), settings.queue_size,
+                                                                   source_memory, config::INSTRUMENT_TABLE_CAPACITY);
+            multicast->SetReceivePlacement({config::MULTICAST_RECEIVE_CORE, config::REALTIME_PRIORITY});
+            subscriber = multicast.get();
+            source = std::move(multicast);
+        } else if (settings.live) {
+            std::cout << "Creating live handler...\n";
+            auto live = LiveHandler::CreateFromEnv(settings.queue_size, source_memory);
+            live->SetReceivePlacement({config::LIVE_RECEIVE_CORE, config::REALTIME_PRIORITY});
+            source = std::move(live);
+        } else {
+            std::cout << "Creating Databento handler...\n";
+            auto handler = DatabentoHandler::CreateFromEnv(settings.queue_size, source_memory);
+            historical = handler.get();
+            source = std::move(handler);
+        }
+        if (settings.job_workers > 1 && (!historical || config::QUEUE_SHARED_MEMORY)) {
+            throw std::invalid_argument("More than one job worker needs historical jobs and a private queue");
+        }
+        auto& queue = source->GetQueue();
+        std::cout << "Queue: capacity " << queue.capacity() << ", "
+                  << queue.memory_bytes() / (1024 * 1024) << " MiB ("
+                  << to_string(queue.page_backing()) << " pages, "
+                  << (config::QUEUE_SHARED_MEMORY ? "shared mpmc"
+                      : config::QUEUE_SPSC ? (config::QUEUE_COMPACT ? "spsc compact" : "spsc")
+                      : config::QUEUE_DENSE_LAYOUT ? "mpmc dense" : "mpmc padded")
+                  << ", numa node " << queue_memory.numa_node << ")\n";
+
+        // Live records arrive in order and in real time: never reordered or paced
+        FetchWatermark no_watermark;
+        ReplayPacer no_pacer;
+        const FetchWatermark& watermark = historical ? historical->GetWatermark() : no_watermark;
+        const ReplayPacer& pacer = historical ? historical->GetReplayPacer() : no_pacer;
+
+        // The same fetch settings on every job worker
+        auto configure_fetch = [&settings](DatabentoHandler& handler) {
+            handler.SetOverflowPolicy(config::OVERFLOW_POLICY, config::SPILL_DIRECTORY,
+                                      std::chrono::milliseconds(config::BACKPRESSURE_MAX_STALL_MS));
+            handler.SetCacheDirectory(settings.dbn_cache_directory);
+            handler.SetReplaySpeed(settings.replay_speed);
+            handler.SetFetchPlan(settings.fetch_plan);
+        };
+
+        if (historical) {
+            configure_fetch(*historical);
+            std::cout << "Overflow policy: " << to_string(historical->GetOverflowPolicy()) << "\n";
+            if (!settings.dbn_cache_directory.empty()) {
+                std::cout << "DBN cache: " << settings.dbn_cache_directory << "\n";
+            }
+            if (settings.replay_speed > 0.0) {
+                std::cout << "Replay speed: " << settings.replay_speed << "x ("
+                          << (TscClock::instance().uses_tsc() ? "TSC" : "steady_clock") << " pacing)\n";
+            }
+
+            const FetchPlanOptions& fetch_plan = settings.fetch_plan;
+            if (fetch_plan.time_slices * fetch_plan.symbol_groups > 1) {
+                std::cout << "Fetch plan: " << fetch_plan.time_slices << " time slices x "
+                          << fetch_plan.symbol_groups << " symbol groups, "
+                          << (DatabentoHandler::DataQueue::MULTI_PRODUCER ? fetch_plan.parallelism : 1)
+                          << " workers\n";
+            }
+
+            // Only job worker 0 is pinned
+            std::vector<ThreadPlacement> worker_placements;
+            for (int core : config::FETCH_WORKER_CORES) {
+                worker_placements.push_back({core, config::REALTIME_PRIORITY});
+            }
+            historical->SetThreadPlacement({config::FETCH_CORE, config::REALTIME_PRIORITY}, worker_placements);
+        }
 
         // Set error callback
-        handler->SetErrorCallback([](const std::string& error) {
+        source->SetErrorCallback([](const std::string& error) {
             std::cerr << "ERROR: " << error << std::endl;
         });
+        source->SetLogger(&logger);
+
+        // Start consumer thread. A producer in another process cannot wake it,
+        // so an attached consumer polls instead of blocking
+        WaitStrategyKind consumer_wait = config::CONSUMER_WAIT_STRATEGY;
+        if (shared_attach && consumer_wait == WaitStrategyKind::Blocking) {
+            consumer_wait = WaitStrategyKind::SpinYield;
+        }
+        if (!shared_producer) {
+            std::cout << "Starting consumer thread...\n";
+            std::cout << "Consumer wait strategy: " << to_string(consumer_wait) << "\n";
+        }
+        QueueSignal consumer_signal;
+        auto& consumer_metrics = const_cast<PerformanceMetrics&>(source->GetMetrics());
+        if (consumer_wait == WaitStrategyKind::Blocking) {
+            // Producer only pays for notify() when a signal is attached
+            source->SetConsumerSignal(&consumer_signal);
+        }
+
+        // Columnar capture of the processed stream, fed by whichever thread processes it
+        std::unique_ptr<ColumnarCapture> capture;
+        if (!settings.capture_path.empty()) {
+            ColumnarCapture::Options capture_options;
+            capture_options.path = settings.capture_path;
+            capture_options.queue_size = config::CAPTURE_QUEUE_SIZE;
+            capture_options.block_rows = config::CAPTURE_BLOCK_ROWS;
+            capture_options.compress = config::CAPTURE_COMPRESS;
+            capture_options.drop_on_full = config::CAPTURE_DROP_ON_FULL;
+            capture_options.instrument_capacity = config::INSTRUMENT_TABLE_CAPACITY;
+            capture_options.placement = {config::CAPTURE_CORE, config::REALTIME_PRIORITY};
+            capture_options.queue_memory = queue_memory;
+            capture = std::make_unique<ColumnarCapture>(capture_options);
+            capture->Start();
+            std::cout << "Capture: " << capture->path() << " (" << capture_options.block_rows << "-row blocks, "
+                      << (capture_options.compress ? "delta/varint" : "raw") << " columns)\n";
+        }
+
+        // Multicast fan-out of the processed stream to other processes
+        std::unique_ptr<MulticastPublisher> publisher;
+        if (config::MULTICAST_PUBLISH) {
+            MulticastPublisher::Options publish_options;
+            publish_options.network = multicast_options();
+            publish_options.queue_size = config::MULTICAST_QUEUE_SIZE;
+            publish_options.drop_on_full = config::MULTICAST_DROP_ON_FULL;
+            publish_options.placement = {config::MULTICAST_CORE, config::REALTIME_PRIORITY};
+            publish_options.queue_memory = queue_memory;
+            publisher = std::make_unique<MulticastPublisher>(publish_options);
+            publisher->Start();
+            std::cout << "Multicast: publishing to " << config::MULTICAST_GROUP << ":" << config::MULTICAST_PORT
+                      << " (" << publisher->records_per_datagram() << " records per datagram)\n";
+        }
+        StreamTaps taps{capture.get(), publisher.get()};
+
+        // Consumer threads (not shard workers) fold bulk pops with the column kernels
+        bool local_consumers = (!shared_producer && config::NUM_SHARDS == 0) || settings.job_workers > 1;
+        if (config::CONSUMER_SOA_BATCH && !config::FIXED_POINT_PRICES && local_consumers) {
+            std::cout << "Consumer batch kernels: " << to_string(detect_simd_level()) << "\n";
+        }
+
+        std::thread consumer;
+        PlacementLog consumer_placements;
+        InstrumentCounters consumer_instruments(config::INSTRUMENT_TABLE_CAPACITY);
+        std::unique_ptr<ShardedPipeline<EngineDataQueue>> pipeline;
+        if (shared_producer) {
+            std::cout << "Shared queue " << config::SHARED_QUEUE_NAME
+                      << ": consumers attach from other processes (SHARED_QUEUE_ATTACH)\n";
+        } else if (config::NUM_SHARDS > 0) {
+            ShardedPipeline<EngineDataQueue>::Options options;
+            options.num_shards = config::NUM_SHARDS;
+            options.shard_queue_size = config::SHARD_QUEUE_SIZE;
+            options.batch_size = config::CONSUMER_BATCH_SIZE;
+            options.shard_cores = config::SHARD_CORES;
+            options.router_core = config::ROUTER_CORE;
+            options.fifo_priority = config::REALTIME_PRIORITY;
+            options.wait_strategy = consumer_wait;
+            options.spin_limit = config::CONSUMER_SPIN_LIMIT;
+            options.queue_memory = queue_memory;
+            options.queue_memory.numa_node = config::QUEUE_NUMA_NODE;  // -1 = per shard worker core
+            options.instrument_capacity = config::INSTRUMENT_TABLE_CAPACITY;
+            options.instruments = &source->GetInstruments();
+            options.watermark = &watermark;
+            options.taps = taps;
+            pipeline = std::make_unique<ShardedPipeline<EngineDataQueue>>(
+                queue, consumer_metrics, consumer_signal, options);
+            pipeline->Start();
+            std::cout << "Sharded pipeline: " << pipeline->num_shards() << " shards\n";
+        } else {
+            with_wait_strategy(consumer_wait, consumer_signal, config::CONSUMER_SPIN_LIMIT,
+                               [&](auto wait) {
+                consumer = std::thread(consumer_thread<decltype(wait)>, std::ref(queue),
+                                       std::ref(consumer_metrics), std::cref(source->GetInstruments()),
+                                       std::cref(watermark), std::cref(pacer),
+                                       ThreadPlacement{config::CONSUMER_CORE, config::REALTIME_PRIORITY},
+                                       std::ref(consumer_placements), taps, std::ref(consumer_instruments),
+                                       std::ref(logger), wait);
+            });
+        }
+
+        // Further job workers: a handler each, with its own connection, queue
+        // and unpinned consumer. Taps and shards stay on worker 0
+        std::vector<std::unique_ptr<DatabentoHandler>> extra_workers;
+        std::vector<std::unique_ptr<QueueSignal>> extra_signals;
+        std::vector<std::unique_ptr<InstrumentCounters>> extra_instruments;
+        std::vector<std::thread> extra_consumers;
+        for (size_t w = 1; w < settings.job_workers; ++w) {
+            auto handler = DatabentoHandler::CreateFromEnv(settings.queue_size, queue_memory);
+            configure_fetch(*handler);
+            handler->SetLogger(&logger);
+            extra_signals.push_back(std::make_unique<QueueSignal>());
+            if (consumer_wait == WaitStrategyKind::Blocking) {
+                handler->SetConsumerSignal(extra_signals.back().get());
+            }
+            extra_instruments.push_back(std::make_unique<InstrumentCounters>(config::INSTRUMENT_TABLE_CAPACITY));
+            DatabentoHandler& worker = *handler;
+            with_wait_strategy(consumer_wait, *extra_signals.back(), config::CONSUMER_SPIN_LIMIT,
+                               [&](auto wait) {
+                extra_consumers.emplace_back(consumer_thread<decltype(wait)>, std::ref(worker.GetQueue()),
+                                             std::ref(const_cast<PerformanceMetrics&>(worker.GetMetrics())),
+                                             std::cref(worker.GetInstruments()), std::cref(worker.GetWatermark()),
+                                             std::cref(worker.GetReplayPacer()), ThreadPlacement{},
+                                             std::ref(consumer_placements), StreamTaps{},
+                                             std::ref(*extra_instruments.back()), std::ref(logger), wait);
+            });
+            extra_workers.push_back(std::move(handler));
+        }
+        if (historical) {
+            std::cout << "Job workers: " << settings.job_workers << ", jobs: " << settings.jobs.size() << "\n";
+        }
+
+        // Live metrics for scrapers and co-located tools; it only reads what
+        // the threads above already maintain
+        std::unique_ptr<MetricsExporter> exporter;
+        if (settings.metrics_http_port != 0 || !settings.metrics_shared_name.empty()) {
+            MetricsExporter::Options metrics_options;
+            metrics_options.interval = std::chrono::milliseconds(settings.metrics_interval_ms);
+            metrics_options.http_port = settings.metrics_http_port;
+            metrics_options.http_bind = config::METRICS_HTTP_BIND;
+            metrics_options.shared_name = settings.metrics_shared_name;
+            metrics_options.max_instruments = config::INSTRUMENT_TABLE_CAPACITY;
+            metrics_options.placement.core = config::METRICS_CORE;
+            exporter = std::make_unique<MetricsExporter>(metrics_options);
+            exporter->add_source("worker0", source->GetMetrics());
+            exporter->add_queue("worker0", queue);
+            if (pipeline) {
+                for (size_t i = 0; i < pipeline->num_shards(); ++i) {
+                    exporter->add_queue("shard" + std::to_string(i),
+                                        [&pipeline, i] { return pipeline->shard_queue_size(i); },
+                                        config::SHARD_QUEUE_SIZE);
+                    exporter->add_instruments(pipeline->shard_instruments(i));
+                }
+            } else if (consumer.joinable()) {
+                exporter->add_instruments(consumer_instruments);
+            }
+            for (size_t w = 0; w < extra_workers.size(); ++w) {
+                std::string label = "worker" + std::to_string(w + 1);
+                exporter->add_source(label, extra_workers[w]->GetMetrics());
+                exporter->add_queue(label, extra_workers[w]->GetQueue());
+                exporter->add_instruments(*extra_instruments[w]);
+            }
+            exporter->Start();
+            std::cout << "Metrics: every " << metrics_options.interval.count() << " ms";
+            if (exporter->http_port() != 0) {
+                std::cout << ", http://" << metrics_options.http_bind << ":" << exporter->http_port() << "/metrics";
+            }
+            if (!metrics_options.shared_name.empty()) {
+                std::cout << ", shared page " << metrics_options.shared_name;
+            }
+            std::cout << "\n";
+        }
+
+        // Live sources subscribe to the first job's dataset and symbols
+        SourceRequest request = settings.jobs.front().request;
+        if (!historical) {
+            request.schema = settings.live_schema;
+        }
+
+        if (shared_attach) {
+            std::cout << "Consuming shared queue " << config::SHARED_QUEUE_NAME << "...\n";
+        } else if (subscriber) {
+            std::cout << "Subscribing to multicast feed " << config::MULTICAST_GROUP << ":"
+                      << config::MULTICAST_PORT << "...\n";
+        } else {
+            std::cout << (historical ? "Fetching historical data...\n" : "Subscribing to live data...\n");
+        }
+        if (historical) {
+            for (const FetchJob& job : settings.jobs) {
+                std::cout << "Job " << job.name << ": " << job.request.dataset << " ";
+                for (const auto& sym : job.request.symbols) std::cout << sym << " ";
+                std::cout << job.request.start_time << " to " << job.request.end_time
+                          << " (" << job.request.schema << ")\n";
+            }
+            std::cout << "\n";
+        } else {
+            std::cout << "Dataset: " << request.dataset << "\n";
+            std::cout << "Symbols: ";
+            for (const auto& sym : request.symbols) std::cout << sym << " ";
+            std::cout << "\nSchema: " << request.schema << "\n\n";
+
+            // Start producing in the background
+            source->Start(request);
+        }
+
+        // Logged once every engine thread has had time to start
+        bool placement_reported = false;
+        auto report_placement = [&] {
+            if (placement_reported) {
+                return;
+            }
+            placement_reported = true;
+            std::cout << "=== Thread Placement ===\n";
+            print_placements(source->GetThreadPlacements());
+            print_placements(consumer_placements.entries());
+            if (pipeline) {
+                print_placements(pipeline->thread_placements());
+            }
+            if (capture) {
+                print_placements(capture->thread_placements());
+            }
+            if (publisher) {
+                print_placements(publisher->thread_placements());
+            }
+            if (exporter) {
+                print_placements(exporter->thread_placements());
+            }
+            print_placements(logger.thread_placements());
+            std::cout << "========================\n";
+        };
 
-        // Start consumer thread
-        std::cout << "Starting consumer thread...\n";
-        std::thread consumer(consumer_thread,
-                     std::ref(handler->GetQueue()),
-                     std::ref(const_cast<PerformanceMetrics&>(handler->GetMetrics())));
-
-        // Configuration for data fetch
-        std::string dataset     = config::DATASET;
-        auto symbols            = config::SYMBOLS;
-        std::string start_time  = config::START_TIME;
-        std::string end_time    = config::END_TIME;
-        std::string schema      = config::SCHEMA;
-
-        std::cout << "Fetching historical data...\n";
-        std::cout << "Dataset: " << dataset << "\n";
-        std::cout << "Symbols: ";
-        for (const auto& sym : symbols) std::cout << sym << " ";
-        std::cout << "\nTime range: " << start_time << " to " << end_time << "\n";
-        std::cout << "Schema: " << schema << "\n\n";
-
-        // Start async fetch
-        handler->StartAsyncFetch(dataset, symbols, start_time, end_time, schema);
-
-        // Wait for fetch to complete or user interrupt
         int wait_count = 0;
-        while (handler->IsFetching() && running.load()) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+        auto tick = [&] {
             wait_count++;
             std::cout << "Waiting... " << wait_count << " seconds" << std::endl;
+            report_placement();
+            if (pipeline && wait_count % 5 == 0) {
+                print_sharded_report(*pipeline, source->GetMetrics());
+            }
+        };
 
-            if (wait_count > config::FETCH_TIMEOUT_SECONDS) { // Default timeout after 30s
-                std::cout << "Timeout waiting for data fetch\n";
-                break;
+        std::vector<JobResult> job_results;
+        if (historical) {
+            // Run the jobs on the workers until done or interrupted
+            std::vector<MarketDataSource<EngineDataQueue>*> workers{historical};
+            for (auto& worker : extra_workers) {
+                workers.push_back(worker.get());
+            }
+            JobScheduler<EngineDataQueue>::Options job_options;
+            job_options.job_timeout = std::chrono::seconds(settings.fetch_timeout_seconds);
+            job_options.on_start = [](const FetchJob& job, size_t worker) {
+                std::cout << "Job " << job.name << " started on worker " << worker << std::endl;
+            };
+            job_options.on_finish = [](const JobResult& result) {
+                std::cout << "Job " << result.name << " " << to_string(result.status) << ": "
+                          << result.records << " records in " << result.seconds << " s" << std::endl;
+            };
+            job_options.on_error = [](const std::string& error) {
+                std::cerr << "ERROR: " << error << std::endl;
+            };
+            job_options.remote_consumers = {shared_producer};  // Worker 0's queue is drained elsewhere
+            JobScheduler<EngineDataQueue> scheduler(workers, job_options);
+            job_results = scheduler.Run(settings.jobs, [] { return running.load(); }, tick);
+        } else {
+            // Live runs until interrupted
+            while (source->IsRunning() && running.load()) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                tick();
             }
         }
 
-        // If fetch completed, wait a bit more for consumer to process remaining data
-        if (!handler->IsFetching()) {
-            std::cout << "Fetch completed. Waiting for consumer to process remaining data...\n";
-            std::this_thread::sleep_for(std::chrono::seconds(5));
-        }
+        report_placement();
 
-        // Stop consumer
-        running = false;
+        // End of stream. Every producer has returned, so closing the queues
+        // lets the consumers drain them to the last record and exit on their
+        // own; after an interrupt they exit right away
+        source->Stop();
+        for (auto& worker : extra_workers) {
+            worker->Stop();
+        }
+        if (shared_attach) {
+            // Only the producing engine closes a shared queue. The feed ended
+            // because it did (or exited) and the queue is empty
+            running = false;
+        } else {
+            queue.close();
+            for (auto& worker : extra_workers) {
+                worker->GetQueue().close();
+            }
+        }
+        consumer_signal.wake_all();
+        for (auto& signal : extra_signals) {
+            signal->wake_all();
+        }
+        if (running.load()) {
+            if (shared_producer) {
+                std::cout << "Stream closed. Waiting for attached consumers to drain the shared queue...\n";
+                while (!queue.empty() && running.load()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+            } else {
+                std::cout << "Stream closed. Draining consumers...\n";
+            }
+        }
         if (consumer.joinable()) {
             consumer.join();
         }
+        for (auto& thread : extra_consumers) {
+            thread.join();
+        }
+        if (pipeline && running.load()) {
+            pipeline->Drain();
+        }
+        running = false;
+        if (exporter) {
+            exporter->Stop();  // Last sample has the final counts
+        }
+        logger.Stop();  // Every thread that logs has stopped: write what is left
+        if (pipeline) {
+            pipeline->Stop();
+            std::cout << "\n=== Final VWAP Summary (" << pipeline->num_shards() << " shards) ===\n";
+            for (auto& [id, stats] : pipeline->MergedStats()) {
+                std::cout << "Instrument " << id
+                          << " VWAP=" << stats.vwap_tracker.vwap()
+                          << " (trades=" << stats.trades_processed
+                          << ", quotes=" << stats.quotes_processed
+                          << ", levels=" << stats.book_updates << ")\n";
+                print_book(stats.book);
+                print_rolling(stats.rolling);
+                print_record_latency(stats.latency);
+            }
+            for (size_t i = 0; i < pipeline->num_shards(); ++i) {
+                const ThreadMetrics& shard = pipeline->shard_metrics(i);
+                std::cout << "Shard " << i << " ";
+                print_latency("end-to-end latency", shard.end_to_end_latency);
+            }
+            std::cout << "===========================\n";
+        }
+
+        // The stream has stopped: write the last blocks and the footer index
+        if (capture) {
+            capture->Stop();
+            std::cout << "\n=== Capture ===\n";
+            std::cout << "File: " << capture->path() << "\n";
+            std::cout << "Records: " << capture->records_written() << " in " << capture->blocks_written()
+                      << " blocks, " << capture->bytes_written() / 1024 << " KiB\n";
+            std::cout << "Dropped: " << capture->records_dropped() << "\n";
+            if (!capture->error().empty()) {
+                std::cout << "Error: " << capture->error() << "\n";
+            }
+            std::cout << "===============\n";
+        }
+        if (publisher) {
+            publisher->Stop();
+            std::cout << "\n=== Multicast ===\n";
+            std::cout << "Records sent: " << publisher->records_sent() << " in "
+                      << publisher->datagrams_sent() << " datagrams\n";
+            std::cout << "Send errors: " << publisher->send_errors() << " datagrams\n";
+            std::cout << "Dropped: " << publisher->records_dropped() << "\n";
+            std::cout << "=================\n";
+        }
 
-        // Final metrics report
-        const auto& metrics = handler->GetMetrics();
+        if (historical) {
+            uint64_t job_records = 0;
+            std::cout << "\n=== Jobs ===\n";
+            for (const JobResult& result : job_results) {
+                std::cout << result.name << ": " << to_string(result.status) << " on worker " << result.worker
+                          << ", " << result.records << " records (" << result.overruns << " overruns) in "
+                          << result.seconds << " s\n";
+                job_records += result.records;
+            }
+            if (job_results.size() < settings.jobs.size()) {
+                std::cout << "Not started: " << settings.jobs.size() - job_results.size() << " jobs\n";
+            }
+            std::cout << "Total: " << job_records << " records in " << job_results.size() << " jobs\n";
+            std::cout << "============\n";
+        }
+
+        // Final metrics report (job worker 0, last job)
+        const auto& metrics = source->GetMetrics();
         std::cout << "\n=== Final Metrics Report ===\n";
-        std::cout << "Messages received: " << metrics.messages_received.load() << "\n";
-        std::cout << "Messages processed: " << metrics.messages_processed.load() << "\n";
-        std::cout << "Buffer overruns: " << metrics.buffer_overruns.load() << "\n";
+        std::cout << "Messages received: " << metrics.messages_received() << "\n";
+        std::cout << "Messages processed: " << metrics.messages_processed() << "\n";
+        std::cout << "Buffer overruns: " << metrics.buffer_overruns() << "\n";
         std::cout << "Buffer underruns: " << metrics.buffer_underruns.load() << "\n";
+        std::cout << "Backpressure stalls: " << metrics.backpressure_stalls.load()
+                  << " (" << metrics.backpressure_stall_ns.load() / 1000000 << " ms)\n";
+        std::cout << "Records evicted: " << metrics.records_evicted.load() << "\n";
+        std::cout << "Records spilled: " << metrics.records_spilled.load() << "\n";
+        if (settings.replay_speed > 0.0) {
+            std::cout << "Max queue depth: " << metrics.max_queue_depth.load() << "\n";
+            std::cout << "Producer max lag vs schedule: " << metrics.replay_max_lag_ns.load() / 1000 << " μs\n";
+        }
+        if (historical) {
+            std::cout << "DBN cache hits/misses: " << metrics.cache_hits.load() << "/"
+                      << metrics.cache_misses.load() << "\n";
+        } else if (!shared_attach) {
+            std::cout << (subscriber ? "Feed latency (sent -> enqueued): avg " : "Feed latency (ts_recv -> enqueued): avg ")
+                      << metrics.avg_feed_latency_us() << " μs\n";
+            print_latency("Feed latency", metrics.feed_latency());
+        }
+        if (subscriber) {
+            std::cout << "Multicast datagrams: " << subscriber->datagrams_received()
+                      << " (" << subscriber->malformed() << " malformed)\n";
+            std::cout << "Multicast gaps: " << subscriber->gaps() << " (" << subscriber->records_lost()
+                      << " records lost, " << subscriber->duplicates() << " duplicates skipped)\n";
+        }
         std::cout << "Average latency: " << metrics.avg_latency_us() << " μs\n";
-        std::cout << "Maximum latency: " << metrics.max_latency_ns.load() << " ns\n";
+        std::cout << "Maximum latency: " << metrics.max_latency_ns() << " ns\n";
+        print_latency("Push latency", metrics.push_latency());
+        if (config::TRACK_RECORD_LATENCY) {
+            print_latency("Queue latency", metrics.queue_latency());
+            if (pipeline) {
+                std::cout << "(upstream queue only; per-shard latency is in the summary above)\n";
+            } else {
+                print_latency("Processing latency", metrics.process_latency());
+                print_latency("End-to-end latency", metrics.end_to_end_latency());
+            }
+        }
+        print_queue_encoding(queue);
         std::cout << "Push success rate: " << metrics.push_success_rate() * 100.0 << "%\n";
+        if (logger.dropped() > 0) {
+            std::cout << "Log records dropped: " << logger.dropped() << "\n";
+        }
+        if (exporter) {
+            std::cout << "Metrics samples: " << exporter->samples() << " (" << exporter->http_requests()
+                      << " HTTP requests)\n";
+        }
         std::cout << "=============================\n";
 
     } catch (const std::exception& e) {